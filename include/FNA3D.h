@@ -1540,6 +1540,214 @@ FNA3DAPI void FNA3D_SetStringMarker(FNA3D_Device *device, const char *text);
  */
 FNA3DAPI void FNA3D_SetTextureName(FNA3D_Device *device, FNA3D_Texture *texture, const char *text);
 
+/* Pipeline Cache Statistics */
+
+#define FNA3D_PIPELINECACHESTATS_VERSION_EXT 0
+
+/* Creation time histogram buckets, in milliseconds:
+ * [0] < 0.1, [1] < 0.5, [2] < 1, [3] < 5, [4] < 10, [5] < 50, [6] < 100,
+ * [7] >= 100
+ */
+#define FNA3D_PIPELINECACHE_HISTOGRAM_BUCKETS_EXT 8
+
+typedef enum FNA3D_PipelineCacheTypeEXT
+{
+	FNA3D_PIPELINECACHE_GRAPHICSPIPELINE_EXT,
+	FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT,
+	FNA3D_PIPELINECACHE_BLENDSTATE_EXT,
+	FNA3D_PIPELINECACHE_DEPTHSTENCILSTATE_EXT,
+	FNA3D_PIPELINECACHE_RASTERIZERSTATE_EXT,
+	FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT,
+	FNA3D_PIPELINECACHE_TYPE_COUNT_EXT
+} FNA3D_PipelineCacheTypeEXT;
+
+typedef struct FNA3D_PipelineCacheCountersEXT
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint32_t liveObjects;
+	uint32_t capacity;	/* Hash buckets or array slots */
+	float loadFactor;	/* liveObjects / capacity */
+	uint32_t creationTimeHistogram[FNA3D_PIPELINECACHE_HISTOGRAM_BUCKETS_EXT];
+} FNA3D_PipelineCacheCountersEXT;
+
+typedef struct FNA3D_PipelineCacheStatsEXT
+{
+	uint32_t version;
+	FNA3D_PipelineCacheCountersEXT caches[FNA3D_PIPELINECACHE_TYPE_COUNT_EXT];
+} FNA3D_PipelineCacheStatsEXT;
+
+/* Reads the lifetime counters of the renderer's state object caches, useful
+ * for finding content that causes pipeline explosions and for verifying that
+ * cache prewarming works. Caches that the renderer does not use are zeroed.
+ *
+ * This should be called from the thread that owns the device.
+ *
+ * stats: Filled with the current counters. The caller must set the version
+ *	  field to FNA3D_PIPELINECACHESTATS_VERSION_EXT.
+ */
+FNA3DAPI void FNA3D_GetPipelineCacheStatsEXT(
+	FNA3D_Device *device,
+	FNA3D_PipelineCacheStatsEXT *stats
+);
+
+/* Asynchronous Readback */
+
+typedef struct FNA3D_ReadbackEXT FNA3D_ReadbackEXT;
+
+/* Queues a copy of a 2D texture region into CPU-visible memory. Unlike
+ * FNA3D_GetTextureData2D, this does not wait for the GPU to finish; the data
+ * is normally ready one or two frames later.
+ *
+ * texture:	The texture object being read.
+ * x:		The x offset of the subregion being read.
+ * y:		The y offset of the subregion being read.
+ * w:		The width of the subregion being read.
+ * h:		The height of the subregion being read.
+ * level:	The mipmap level being read.
+ * dataLength:	The size of the subregion, in bytes.
+ *
+ * Returns a readback handle, to be passed to FNA3D_WaitReadbackEXT exactly
+ * once, or NULL on failure.
+ */
+FNA3DAPI FNA3D_ReadbackEXT* FNA3D_GetTextureDataAsyncEXT(
+	FNA3D_Device *device,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+);
+
+/* Queues a copy of a vertex or index buffer region into CPU-visible memory.
+ *
+ * buffer:		The buffer object being read.
+ * offsetInBytes:	The offset of the region being read, in bytes.
+ * dataLength:		The size of the region being read, in bytes.
+ *
+ * Returns a readback handle, to be passed to FNA3D_WaitReadbackEXT exactly
+ * once, or NULL on failure.
+ */
+FNA3DAPI FNA3D_ReadbackEXT* FNA3D_GetBufferDataAsyncEXT(
+	FNA3D_Device *device,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
+);
+
+/* Checks whether a readback has finished without blocking.
+ *
+ * readback: The handle returned by FNA3D_Get*DataAsyncEXT.
+ *
+ * Returns 1 when FNA3D_WaitReadbackEXT will not block, otherwise 0.
+ */
+FNA3DAPI uint8_t FNA3D_PollReadbackEXT(
+	FNA3D_Device *device,
+	FNA3D_ReadbackEXT *readback
+);
+
+/* Waits for a readback to finish, copies out its data and frees the handle.
+ *
+ * readback:	The handle returned by FNA3D_Get*DataAsyncEXT.
+ * data:	The pointer being filled with the data, or NULL to discard it.
+ * dataLength:	The size of the data pointer, in bytes.
+ */
+FNA3DAPI void FNA3D_WaitReadbackEXT(
+	FNA3D_Device *device,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
+);
+
+/* Backbuffer Capture */
+
+#define FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT 4
+
+/* Receives one captured frame.
+ *
+ * data:	The backbuffer contents, in the same layout as
+ *		FNA3D_ReadBackbuffer. Only valid until the callback returns.
+ * width:	The width of the captured frame, in pixels.
+ * height:	The height of the captured frame, in pixels.
+ * dataLength:	The size of data, in bytes.
+ * userdata:	The pointer given to FNA3D_SetBackbufferCaptureEXT.
+ */
+typedef void (FNA3DCALL * FNA3D_BackbufferCaptureFuncEXT)(
+	void *data,
+	int32_t width,
+	int32_t height,
+	int32_t dataLength,
+	void *userdata
+);
+
+/* Starts or stops streaming the backbuffer to the CPU, for screenshots and
+ * video recording. Every SwapBuffers copies the backbuffer into a ring of
+ * download buffers. The copy made frameCount presents earlier is given to the
+ * callback, so capturing does not have to wait for the GPU.
+ *
+ * The callback runs on the thread calling FNA3D_SwapBuffers. Stopping the
+ * capture delivers any frames that are still in flight.
+ *
+ * This should be called from the thread that owns the device.
+ *
+ * frameCount:	The capture latency in frames, from 1 to
+ *		FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT. 0 stops capturing.
+ * callback:	The function that receives frames. NULL stops capturing.
+ * userdata:	Passed to the callback as-is.
+ */
+FNA3DAPI void FNA3D_SetBackbufferCaptureEXT(
+	FNA3D_Device *device,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+);
+
+/* Deferred Contexts */
+
+/* Creates a device that records commands into a list instead of rendering.
+ * Worker threads record with the regular FNA3D_* calls, and the thread that
+ * owns the parent device replays each list with
+ * FNA3D_ExecuteDeferredContextEXT. Free the context with FNA3D_DestroyDevice.
+ *
+ * Clears, draws, render states, samplers, vertex buffer bindings, render
+ * targets, effect application, query begin/end and Set*Data calls are recorded.
+ * Data and effect parameter values are copied when recorded. Disposal is
+ * recorded too, so earlier commands can still use the resource; destroying a
+ * context that was never executed passes its disposals on to the parent.
+ * Resource creation and capability queries go straight to the parent device.
+ * Readbacks, SwapBuffers and backbuffer changes cannot be recorded.
+ *
+ * A context has no state of its own when executed, so each list should set
+ * everything its draws depend on. The MOJOSHADER_effectStateChanges of a
+ * recorded ApplyEffect are filled in from the pass right away, so the states
+ * the caller applies are recorded after it. The sampler states of shaders that
+ * a preshader picks at apply time are not known yet and are left out. A
+ * context is used by one thread at a time, and effects should not be shared
+ * between contexts that record at the same time.
+ *
+ * device:	The device that the recorded commands will be executed on.
+ *
+ * Returns a device that records commands, or NULL on failure.
+ */
+FNA3DAPI FNA3D_Device* FNA3D_CreateDeferredContextEXT(FNA3D_Device *device);
+
+/* Executes everything recorded into a deferred context on its parent device,
+ * then empties the context so it can record again. Contexts run in the order
+ * they are executed.
+ *
+ * This should be called from the thread that owns the device, while nothing
+ * is recording into the context.
+ *
+ * device:	The device the context was created from.
+ * context:	The deferred context to execute.
+ */
+FNA3DAPI void FNA3D_ExecuteDeferredContextEXT(
+	FNA3D_Device *device,
+	FNA3D_Device *context
+);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
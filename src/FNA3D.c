@@ -1529,6 +1529,129 @@ void FNA3D_SetTextureName(FNA3D_Device* device, FNA3D_Texture* texture, const ch
 
 	device->SetTextureName(device->driverData, texture, text);
 }
+
+/* Pipeline Cache Statistics */
+
+void FNA3D_GetPipelineCacheStatsEXT(
+	FNA3D_Device *device,
+	FNA3D_PipelineCacheStatsEXT *stats
+) {
+	/* Not traced! */
+	if (	device == NULL ||
+		stats == NULL ||
+		stats->version != FNA3D_PIPELINECACHESTATS_VERSION_EXT	)
+	{
+		return;
+	}
+	SDL_memset(stats->caches, '\0', sizeof(stats->caches));
+	device->GetPipelineCacheStats(device->driverData, stats);
+}
+
+/* Asynchronous Readback */
+
+FNA3D_ReadbackEXT* FNA3D_GetTextureDataAsyncEXT(
+	FNA3D_Device *device,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+) {
+	/* Not traced! */
+	if (device == NULL || texture == NULL || dataLength <= 0)
+	{
+		return NULL;
+	}
+	return device->GetTextureDataAsync(
+		device->driverData,
+		texture,
+		x,
+		y,
+		w,
+		h,
+		level,
+		dataLength
+	);
+}
+
+FNA3D_ReadbackEXT* FNA3D_GetBufferDataAsyncEXT(
+	FNA3D_Device *device,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
+) {
+	/* Not traced! */
+	if (device == NULL || buffer == NULL || dataLength <= 0)
+	{
+		return NULL;
+	}
+	return device->GetBufferDataAsync(
+		device->driverData,
+		buffer,
+		offsetInBytes,
+		dataLength
+	);
+}
+
+uint8_t FNA3D_PollReadbackEXT(
+	FNA3D_Device *device,
+	FNA3D_ReadbackEXT *readback
+) {
+	/* Not traced! */
+	if (device == NULL || readback == NULL)
+	{
+		return 1;
+	}
+	return device->PollReadback(device->driverData, readback);
+}
+
+void FNA3D_WaitReadbackEXT(
+	FNA3D_Device *device,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
+) {
+	/* Not traced! */
+	if (device == NULL || readback == NULL)
+	{
+		return;
+	}
+	device->WaitReadback(device->driverData, readback, data, dataLength);
+}
+
+/* Backbuffer Capture */
+
+void FNA3D_SetBackbufferCaptureEXT(
+	FNA3D_Device *device,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+) {
+	/* Not traced! */
+	if (device == NULL)
+	{
+		return;
+	}
+	if (frameCount <= 0 || callback == NULL)
+	{
+		frameCount = 0;
+		callback = NULL;
+		userdata = NULL;
+	}
+	else if (frameCount > FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT)
+	{
+		frameCount = FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT;
+	}
+	device->SetBackbufferCapture(
+		device->driverData,
+		frameCount,
+		callback,
+		userdata
+	);
+}
+
 /* External Interop */
 
 void FNA3D_GetSysRendererEXT(
@@ -0,0 +1,3064 @@
+/* FNA3D - 3D Graphics Library for FNA
+ *
+ * Copyright (c) 2020-2024 Ethan Lee
+ *
+ * This software is provided 'as-is', without any express or implied warranty.
+ * In no event will the authors be held liable for any damages arising from
+ * the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ * claim that you wrote the original software. If you use this software in a
+ * product, an acknowledgment in the product documentation would be
+ * appreciated but is not required.
+ *
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ * misrepresented as being the original software.
+ *
+ * 3. This notice may not be removed or altered from any source distribution.
+ *
+ * Ethan "flibitijibibo" Lee <flibitijibibo@flibitijibibo.com>
+ *
+ */
+
+#include "FNA3D_Driver.h"
+
+#ifdef USE_SDL3
+#include <SDL3/SDL.h>
+#else
+#include <SDL.h>
+static inline SDL_threadID SDL_GetCurrentThreadID()
+{
+	return SDL_ThreadID();
+}
+#define SDL_ThreadID SDL_threadID
+#define SDL_Mutex SDL_mutex
+#define SDL_Semaphore SDL_sem
+#define SDL_SignalSemaphore SDL_SemPost
+#define SDL_WaitSemaphore SDL_SemWait
+#define SDL_AtomicInt SDL_atomic_t
+#define SDL_GetAtomicInt SDL_AtomicGet
+#define SDL_SetAtomicInt SDL_AtomicSet
+#define SDL_LockSpinlock SDL_AtomicLock
+#define SDL_UnlockSpinlock SDL_AtomicUnlock
+#endif
+
+/* Command List */
+
+typedef struct DeferredCommand
+{
+	#define DEFERRED_COMMAND_CLEAR 0
+	#define DEFERRED_COMMAND_DRAWINDEXEDPRIMITIVES 1
+	#define DEFERRED_COMMAND_DRAWINSTANCEDPRIMITIVES 2
+	#define DEFERRED_COMMAND_DRAWPRIMITIVES 3
+	#define DEFERRED_COMMAND_SETVIEWPORT 4
+	#define DEFERRED_COMMAND_SETSCISSORRECT 5
+	#define DEFERRED_COMMAND_SETBLENDFACTOR 6
+	#define DEFERRED_COMMAND_SETMULTISAMPLEMASK 7
+	#define DEFERRED_COMMAND_SETREFERENCESTENCIL 8
+	#define DEFERRED_COMMAND_SETBLENDSTATE 9
+	#define DEFERRED_COMMAND_SETDEPTHSTENCILSTATE 10
+	#define DEFERRED_COMMAND_APPLYRASTERIZERSTATE 11
+	#define DEFERRED_COMMAND_VERIFYSAMPLER 12
+	#define DEFERRED_COMMAND_VERIFYVERTEXSAMPLER 13
+	#define DEFERRED_COMMAND_APPLYVERTEXBUFFERBINDINGS 14
+	#define DEFERRED_COMMAND_SETRENDERTARGETS 15
+	#define DEFERRED_COMMAND_RESOLVETARGET 16
+	#define DEFERRED_COMMAND_SETTEXTUREDATA2D 17
+	#define DEFERRED_COMMAND_SETTEXTUREDATA3D 18
+	#define DEFERRED_COMMAND_SETTEXTUREDATACUBE 19
+	#define DEFERRED_COMMAND_SETTEXTUREDATAYUV 20
+	#define DEFERRED_COMMAND_SETVERTEXBUFFERDATA 21
+	#define DEFERRED_COMMAND_SETINDEXBUFFERDATA 22
+	#define DEFERRED_COMMAND_SETEFFECTTECHNIQUE 23
+	#define DEFERRED_COMMAND_APPLYEFFECT 24
+	#define DEFERRED_COMMAND_BEGINPASSRESTORE 25
+	#define DEFERRED_COMMAND_ENDPASSRESTORE 26
+	#define DEFERRED_COMMAND_QUERYBEGIN 27
+	#define DEFERRED_COMMAND_QUERYEND 28
+	#define DEFERRED_COMMAND_SETSTRINGMARKER 29
+	#define DEFERRED_COMMAND_ADDDISPOSETEXTURE 30
+	#define DEFERRED_COMMAND_ADDDISPOSERENDERBUFFER 31
+	#define DEFERRED_COMMAND_ADDDISPOSEVERTEXBUFFER 32
+	#define DEFERRED_COMMAND_ADDDISPOSEINDEXBUFFER 33
+	#define DEFERRED_COMMAND_ADDDISPOSEEFFECT 34
+	#define DEFERRED_COMMAND_ADDDISPOSEQUERY 35
+	/* Threaded contexts only */
+	#define DEFERRED_COMMAND_SWAPBUFFERS 36
+	#define DEFERRED_COMMAND_RESETBACKBUFFER 37
+	#define DEFERRED_COMMAND_READBACKBUFFER 38
+	#define DEFERRED_COMMAND_CREATEQUERY 39
+	#define DEFERRED_COMMAND_QUERYCOMPLETE 40
+	#define DEFERRED_COMMAND_QUERYPIXELCOUNT 41
+	#define DEFERRED_COMMAND_SETBACKBUFFERCAPTURE 42
+	uint8_t type;
+
+	/* Variable-length arguments are stored as offsets into the context's
+	 * memory block, which can move while recording.
+	 */
+	FNA3DNAMELESS union
+	{
+		struct
+		{
+			FNA3D_ClearOptions options;
+			FNA3D_Vec4 color;
+			float depth;
+			int32_t stencil;
+		} clear;
+
+		struct
+		{
+			FNA3D_PrimitiveType primitiveType;
+			int32_t baseVertex;
+			int32_t minVertexIndex;
+			int32_t numVertices;
+			int32_t startIndex;
+			int32_t primitiveCount;
+			int32_t instanceCount;
+			FNA3D_Buffer *indices;
+			FNA3D_IndexElementSize indexElementSize;
+		} drawIndexedPrimitives;
+
+		struct
+		{
+			FNA3D_PrimitiveType primitiveType;
+			int32_t vertexStart;
+			int32_t primitiveCount;
+		} drawPrimitives;
+
+		FNA3D_Viewport viewport;
+		FNA3D_Rect scissor;
+		FNA3D_Color blendFactor;
+		int32_t multiSampleMask;
+		int32_t referenceStencil;
+		FNA3D_BlendState blendState;
+		FNA3D_DepthStencilState depthStencilState;
+		FNA3D_RasterizerState rasterizerState;
+
+		struct
+		{
+			int32_t index;
+			FNA3D_Texture *texture;
+			FNA3D_SamplerState sampler;
+		} verifySampler;
+
+		struct
+		{
+			size_t bindings;
+			int32_t numBindings;
+			int32_t baseVertex;
+		} applyVertexBufferBindings;
+
+		struct
+		{
+			size_t renderTargets;
+			int32_t numRenderTargets;
+			FNA3D_Renderbuffer *depthStencilBuffer;
+			FNA3D_DepthFormat depthFormat;
+			uint8_t preserveTargetContents;
+		} setRenderTargets;
+
+		FNA3D_RenderTargetBinding resolveTarget;
+
+		struct
+		{
+			FNA3D_Texture *texture;
+			int32_t x;
+			int32_t y;
+			int32_t z;
+			int32_t w;
+			int32_t h;
+			int32_t d;
+			FNA3D_CubeMapFace cubeMapFace;
+			int32_t level;
+			size_t data;
+			int32_t dataLength;
+		} setTextureData;
+
+		struct
+		{
+			FNA3D_Texture *y;
+			FNA3D_Texture *u;
+			FNA3D_Texture *v;
+			int32_t yWidth;
+			int32_t yHeight;
+			int32_t uvWidth;
+			int32_t uvHeight;
+			size_t data;
+			int32_t dataLength;
+		} setTextureDataYUV;
+
+		struct
+		{
+			FNA3D_Buffer *buffer;
+			int32_t offsetInBytes;
+			size_t data;
+			int32_t elementCount;
+			int32_t elementSizeInBytes;
+			int32_t vertexStride;
+			FNA3D_SetDataOptions options;
+		} setVertexBufferData;
+
+		struct
+		{
+			FNA3D_Buffer *buffer;
+			int32_t offsetInBytes;
+			size_t data;
+			int32_t dataLength;
+			FNA3D_SetDataOptions options;
+		} setIndexBufferData;
+
+		struct
+		{
+			FNA3D_Effect *effect;
+			MOJOSHADER_effectTechnique *technique;
+		} setEffectTechnique;
+
+		struct
+		{
+			FNA3D_Effect *effect;
+			uint32_t pass;
+			MOJOSHADER_effectStateChanges *stateChanges;
+			size_t params;
+		} applyEffect;
+
+		struct
+		{
+			FNA3D_Effect *effect;
+			MOJOSHADER_effectStateChanges *stateChanges;
+		} passRestore;
+
+		FNA3D_Query *query;
+		size_t text;
+
+		struct
+		{
+			FNA3D_Rect sourceRectangle;
+			FNA3D_Rect destinationRectangle;
+			uint8_t hasSourceRectangle;
+			uint8_t hasDestinationRectangle;
+			void *overrideWindowHandle;
+		} swapBuffers;
+
+		FNA3D_PresentationParameters *presentationParameters;
+
+		struct
+		{
+			int32_t x;
+			int32_t y;
+			int32_t w;
+			int32_t h;
+			void *data;
+			int32_t dataLength;
+		} readBackbuffer;
+
+		FNA3D_Texture *texture;
+		FNA3D_Renderbuffer *renderbuffer;
+		FNA3D_Buffer *buffer;
+		FNA3D_Effect *effect;
+
+		/* Synchronous, so the results go straight to the caller */
+		FNA3D_Query **createQuery;
+
+		struct
+		{
+			FNA3D_Query *query;
+			uint8_t *complete;
+			int32_t *pixelCount;
+		} queryResult;
+
+		struct
+		{
+			int32_t frameCount;
+			FNA3D_BackbufferCaptureFuncEXT callback;
+			void *userdata;
+		} setBackbufferCapture;
+	};
+} DeferredCommand;
+
+/* Threaded contexts hand whole command lists to the render thread through a
+ * single-producer, single-consumer ring. The recording thread owns the head,
+ * the render thread owns the tail, and each slot keeps its allocations so
+ * they get recycled instead of freed every frame.
+ */
+
+#define DEFERRED_RING_SIZE 3
+
+typedef struct DeferredCommandList
+{
+	DeferredCommand *commands;
+	int32_t commandCount;
+	int32_t commandCapacity;
+
+	uint8_t *memory;
+	size_t memorySize;
+	size_t memoryCapacity;
+} DeferredCommandList;
+
+/* Execution points an effect's parameters at the recorded values while it
+ * is applied, so recording copies from the pointers captured here instead.
+ */
+
+typedef struct DeferredEffect
+{
+	FNA3D_Effect *effect;
+	void **values; /* The parameters' own storage, never the copies */
+
+	/* As recorded, execution may not have caught up yet */
+	MOJOSHADER_effectTechnique *technique;
+
+	/* One per pass of every technique, set if the caller gets states */
+	uint8_t *passStates;
+	uint32_t passStride;
+} DeferredEffect;
+
+typedef struct DeferredContext /* Cast FNA3D_Renderer* to this! */
+{
+	FNA3D_Device *parent;
+
+	DeferredCommand *commands;
+	int32_t commandCount;
+	int32_t commandCapacity;
+
+	uint8_t *memory;
+	size_t memorySize;
+	size_t memoryCapacity;
+
+	/* Shadowed so the Get* calls see what was recorded */
+	FNA3D_Color blendFactor;
+	int32_t multiSampleMask;
+	int32_t referenceStencil;
+
+	/* Loader threads create and dispose effects too, hence the lock */
+	DeferredEffect *effects;
+	int32_t effectCount;
+	int32_t effectCapacity;
+	SDL_Mutex *effectsLock;
+
+	/* Threaded contexts only, ring is NULL otherwise */
+	DeferredCommandList *ring;
+	SDL_AtomicInt ringHead;
+	SDL_AtomicInt ringTail;
+	SDL_Semaphore *ringConsumed;
+	SDL_ThreadID threadID;
+	void (*wake)(FNA3D_Renderer *driverData);
+
+	/* The driver keeps this pointer and writes it on later passes, so it
+	 * can't be the caller's. Copied out after a synchronous apply.
+	 */
+	MOJOSHADER_effectStateChanges stateChanges;
+} DeferredContext;
+
+/* Ordinary contexts never read their state changes back, and they're all
+ * executed by the thread that owns the device, so they can share this.
+ */
+static MOJOSHADER_effectStateChanges discardedStateChanges;
+
+/* Held while execution has swapped in recorded parameter values */
+static SDL_SpinLock paramSwapLock;
+
+static DeferredCommand* DEFERRED_INTERNAL_AddCommand(
+	DeferredContext *context,
+	uint8_t type
+) {
+	DeferredCommand *result;
+
+	if (context->commandCount == context->commandCapacity)
+	{
+		context->commandCapacity = SDL_max(
+			context->commandCapacity * 2,
+			64
+		);
+		context->commands = (DeferredCommand*) SDL_realloc(
+			context->commands,
+			sizeof(DeferredCommand) * context->commandCapacity
+		);
+	}
+
+	result = &context->commands[context->commandCount];
+	context->commandCount += 1;
+	result->type = type;
+	return result;
+}
+
+static size_t DEFERRED_INTERNAL_CopyMemory(
+	DeferredContext *context,
+	const void *data, /* NULL to only reserve */
+	size_t length
+) {
+	size_t offset;
+
+	/* Keep copied structs aligned */
+	offset = (context->memorySize + 7) & ~((size_t) 7);
+
+	if (offset + length > context->memoryCapacity)
+	{
+		context->memoryCapacity = SDL_max(
+			context->memoryCapacity * 2,
+			65536
+		);
+		while (context->memoryCapacity < offset + length)
+		{
+			context->memoryCapacity *= 2;
+		}
+		context->memory = (uint8_t*) SDL_realloc(
+			context->memory,
+			context->memoryCapacity
+		);
+	}
+
+	if (data != NULL)
+	{
+		SDL_memcpy(context->memory + offset, data, length);
+	}
+	context->memorySize = offset + length;
+	return offset;
+}
+
+static void DEFERRED_INTERNAL_Unsupported(const char *func)
+{
+	FNA3D_LogError("%s cannot be recorded by a deferred context!", func);
+}
+
+static inline uint8_t DEFERRED_INTERNAL_IsOffThread(DeferredContext *context)
+{
+	/* Only the thread that owns a threaded context records into it, loader
+	 * threads go straight to the driver like they would without one.
+	 */
+	return (	context->ring != NULL &&
+			context->threadID != SDL_GetCurrentThreadID()	);
+}
+
+static void DEFERRED_INTERNAL_Submit(DeferredContext *context, uint8_t wait)
+{
+	DeferredCommandList *list;
+	DeferredCommand *commands;
+	uint8_t *memory;
+	int32_t commandCapacity;
+	size_t memoryCapacity;
+	int32_t head = SDL_GetAtomicInt(&context->ringHead);
+
+	/* Don't get more than a ring's worth ahead of the render thread */
+	while (head - SDL_GetAtomicInt(&context->ringTail) >= DEFERRED_RING_SIZE)
+	{
+		SDL_WaitSemaphore(context->ringConsumed);
+	}
+
+	/* Trade the recorded list for the slot's old (already executed) one */
+	list = &context->ring[head % DEFERRED_RING_SIZE];
+	commands = list->commands;
+	commandCapacity = list->commandCapacity;
+	memory = list->memory;
+	memoryCapacity = list->memoryCapacity;
+	list->commands = context->commands;
+	list->commandCount = context->commandCount;
+	list->commandCapacity = context->commandCapacity;
+	list->memory = context->memory;
+	list->memorySize = context->memorySize;
+	list->memoryCapacity = context->memoryCapacity;
+	context->commands = commands;
+	context->commandCount = 0;
+	context->commandCapacity = commandCapacity;
+	context->memory = memory;
+	context->memorySize = 0;
+	context->memoryCapacity = memoryCapacity;
+
+	SDL_SetAtomicInt(&context->ringHead, head + 1);
+	context->wake(context->parent->driverData);
+
+	if (wait)
+	{
+		while (SDL_GetAtomicInt(&context->ringTail) != head + 1)
+		{
+			SDL_WaitSemaphore(context->ringConsumed);
+		}
+	}
+}
+
+static inline void DEFERRED_INTERNAL_Flush(DeferredContext *context)
+{
+	/* Anything that reads back has to see everything recorded so far */
+	if (context->ring != NULL && !DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		DEFERRED_INTERNAL_Submit(context, 1);
+	}
+}
+
+static uint8_t DEFERRED_INTERNAL_PassHasStateChanges(
+	MOJOSHADER_effect *effectData,
+	uint32_t technique,
+	uint32_t pass
+) {
+	MOJOSHADER_effectPass *effectPass = &effectData->techniques[technique].passes[pass];
+	MOJOSHADER_effectShader *shader;
+	uint8_t ownShaders = 0, selectsShader = 0;
+	uint8_t arrayStates = 0, otherStates = 0, samplerStates;
+	int32_t i;
+	uint32_t j;
+
+	/* Everything but the shaders ends up in the render state changes */
+	for (j = 0; j < effectPass->state_count; j += 1)
+	{
+		if (	effectPass->states[j].type != MOJOSHADER_RS_VERTEXSHADER &&
+			effectPass->states[j].type != MOJOSHADER_RS_PIXELSHADER	)
+		{
+			return 1;
+		}
+	}
+	if (effectPass->state_count == 0)
+	{
+		return 0;
+	}
+
+	/* The sampler state changes come from whichever shaders get bound */
+	for (i = 0; i < effectData->object_count; i += 1)
+	{
+		if (	effectData->objects[i].type != MOJOSHADER_SYMTYPE_VERTEXSHADER &&
+			effectData->objects[i].type != MOJOSHADER_SYMTYPE_PIXELSHADER	)
+		{
+			continue;
+		}
+		shader = &effectData->objects[i].shader;
+
+		samplerStates = 0;
+		if (!shader->is_preshader)
+		{
+			for (j = 0; j < shader->sampler_count; j += 1)
+			{
+				if (shader->samplers[j].sampler_state_count > 0)
+				{
+					samplerStates = 1;
+				}
+			}
+		}
+
+		if (shader->technique == technique && shader->pass == pass)
+		{
+			ownShaders = 1;
+			if (shader->is_preshader)
+			{
+				/* Picks one out of an array at apply time */
+				selectsShader = 1;
+			}
+			else if (samplerStates)
+			{
+				return 1;
+			}
+		}
+		else if (shader->technique == (unsigned int) -1)
+		{
+			/* Shader arrays belong to a parameter, not a pass */
+			arrayStates |= samplerStates;
+		}
+		else
+		{
+			otherStates |= samplerStates;
+		}
+	}
+
+	if (!ownShaders)
+	{
+		/* Can't tell which shaders are ours, assume the worst */
+		return arrayStates | otherStates;
+	}
+	return selectsShader & arrayStates;
+}
+
+static DeferredEffect* DEFERRED_INTERNAL_TrackEffect(
+	DeferredContext *context,
+	FNA3D_Effect *effect,
+	MOJOSHADER_effect *effectData
+) {
+	DeferredEffect *result;
+	int32_t i;
+	uint32_t j;
+
+	if (context->effectCount == context->effectCapacity)
+	{
+		context->effectCapacity = SDL_max(
+			context->effectCapacity * 2,
+			16
+		);
+		context->effects = (DeferredEffect*) SDL_realloc(
+			context->effects,
+			sizeof(DeferredEffect) * context->effectCapacity
+		);
+	}
+
+	result = &context->effects[context->effectCount];
+	context->effectCount += 1;
+	result->effect = effect;
+	result->values = (void**) SDL_malloc(
+		sizeof(void*) * SDL_max(effectData->param_count, 1)
+	);
+	result->technique = effectData->current_technique;
+
+	/* This never changes, so work it out once instead of every apply */
+	result->passStride = 0;
+	for (i = 0; i < effectData->technique_count; i += 1)
+	{
+		result->passStride = SDL_max(
+			result->passStride,
+			effectData->techniques[i].pass_count
+		);
+	}
+	result->passStates = (uint8_t*) SDL_calloc(
+		SDL_max(effectData->technique_count * result->passStride, 1),
+		sizeof(uint8_t)
+	);
+	for (i = 0; i < effectData->technique_count; i += 1)
+	{
+		for (j = 0; j < effectData->techniques[i].pass_count; j += 1)
+		{
+			result->passStates[(i * result->passStride) + j] =
+				DEFERRED_INTERNAL_PassHasStateChanges(
+					effectData,
+					i,
+					j
+				);
+		}
+	}
+
+	/* New effects can't be in the middle of an apply, but effects that
+	 * were never seen before might be.
+	 */
+	SDL_LockSpinlock(&paramSwapLock);
+	for (i = 0; i < effectData->param_count; i += 1)
+	{
+		result->values[i] = effectData->params[i].value.values;
+	}
+	SDL_UnlockSpinlock(&paramSwapLock);
+	return result;
+}
+
+static DeferredEffect* DEFERRED_INTERNAL_FetchEffect(
+	DeferredContext *context,
+	FNA3D_Effect *effect,
+	MOJOSHADER_effect *effectData
+) {
+	int32_t i;
+
+	for (i = 0; i < context->effectCount; i += 1)
+	{
+		if (context->effects[i].effect == effect)
+		{
+			return &context->effects[i];
+		}
+	}
+
+	/* Created by the parent, or forgotten since the last execute */
+	return DEFERRED_INTERNAL_TrackEffect(context, effect, effectData);
+}
+
+static void DEFERRED_INTERNAL_ForgetEffect(
+	DeferredContext *context,
+	FNA3D_Effect *effect
+) {
+	int32_t i;
+
+	for (i = 0; i < context->effectCount; i += 1)
+	{
+		if (context->effects[i].effect == effect)
+		{
+			SDL_free(context->effects[i].values);
+			SDL_free(context->effects[i].passStates);
+			context->effectCount -= 1;
+			context->effects[i] = context->effects[context->effectCount];
+			return;
+		}
+	}
+}
+
+static void DEFERRED_INTERNAL_ForgetEffects(DeferredContext *context)
+{
+	int32_t i;
+
+	for (i = 0; i < context->effectCount; i += 1)
+	{
+		SDL_free(context->effects[i].values);
+		SDL_free(context->effects[i].passStates);
+	}
+	context->effectCount = 0;
+}
+
+static uint8_t DEFERRED_INTERNAL_HasStateChanges(
+	DeferredEffect *deferredEffect,
+	MOJOSHADER_effect *effectData,
+	uint32_t pass
+) {
+	uint32_t technique = 0;
+
+	if (deferredEffect->technique != NULL)
+	{
+		technique = (uint32_t) (
+			deferredEffect->technique - effectData->techniques
+		);
+	}
+	if (pass >= deferredEffect->passStride)
+	{
+		return 0;
+	}
+	return deferredEffect->passStates[
+		(technique * deferredEffect->passStride) + pass
+	];
+}
+
+/* Ordinary contexts execute long after the caller applied the states, so
+ * hand out what MOJOSHADER_effectBeginPass would have. It all lives in the
+ * effect data, so the pointers stay good until the effect is disposed.
+ */
+static void DEFERRED_INTERNAL_FillStateChanges(
+	DeferredEffect *deferredEffect,
+	MOJOSHADER_effect *effectData,
+	uint32_t pass,
+	MOJOSHADER_effectStateChanges *stateChanges
+) {
+	MOJOSHADER_effectTechnique *technique = deferredEffect->technique;
+	MOJOSHADER_effectPass *effectPass;
+	MOJOSHADER_effectShader *shader;
+	int32_t object;
+	uint32_t i;
+
+	SDL_zerop(stateChanges);
+	if (technique == NULL)
+	{
+		technique = &effectData->techniques[0];
+	}
+	if (pass >= technique->pass_count)
+	{
+		return;
+	}
+	effectPass = &technique->passes[pass];
+
+	stateChanges->render_state_changes = effectPass->states;
+	stateChanges->render_state_change_count = effectPass->state_count;
+
+	for (i = 0; i < effectPass->state_count; i += 1)
+	{
+		if (	effectPass->states[i].type != MOJOSHADER_RS_VERTEXSHADER &&
+			effectPass->states[i].type != MOJOSHADER_RS_PIXELSHADER	)
+		{
+			continue;
+		}
+		object = *effectPass->states[i].value.valuesI;
+		if (object < 0 || object >= effectData->object_count)
+		{
+			continue;
+		}
+		shader = &effectData->objects[object].shader;
+		if (shader->is_preshader)
+		{
+			/* Which array element gets bound depends on the parameters
+			 * at execute time, so there's no telling its samplers yet.
+			 */
+			DEFERRED_INTERNAL_Unsupported("Sampler states of a preshader-selected shader");
+			continue;
+		}
+		if (effectPass->states[i].type == MOJOSHADER_RS_VERTEXSHADER)
+		{
+			stateChanges->vertex_sampler_state_changes = shader->samplers;
+			stateChanges->vertex_sampler_state_change_count = shader->sampler_count;
+		}
+		else
+		{
+			stateChanges->sampler_state_changes = shader->samplers;
+			stateChanges->sampler_state_change_count = shader->sampler_count;
+		}
+	}
+}
+
+/* Quit */
+
+static void DEFERRED_DestroyDevice(FNA3D_Device *device)
+{
+	DeferredContext *context = (DeferredContext*) device->driverData;
+	FNA3D_Device *parent = context->parent;
+	DeferredCommand *cmd;
+	int32_t i;
+
+	if (context->ring == NULL)
+	{
+		/* Never executed, but whatever was disposed still has to go */
+		for (i = 0; i < context->commandCount; i += 1)
+		{
+			cmd = &context->commands[i];
+			switch (cmd->type)
+			{
+			case DEFERRED_COMMAND_ADDDISPOSETEXTURE:
+				parent->AddDisposeTexture(parent->driverData, cmd->texture);
+				break;
+			case DEFERRED_COMMAND_ADDDISPOSERENDERBUFFER:
+				parent->AddDisposeRenderbuffer(
+					parent->driverData,
+					cmd->renderbuffer
+				);
+				break;
+			case DEFERRED_COMMAND_ADDDISPOSEVERTEXBUFFER:
+				parent->AddDisposeVertexBuffer(parent->driverData, cmd->buffer);
+				break;
+			case DEFERRED_COMMAND_ADDDISPOSEINDEXBUFFER:
+				parent->AddDisposeIndexBuffer(parent->driverData, cmd->buffer);
+				break;
+			case DEFERRED_COMMAND_ADDDISPOSEEFFECT:
+				parent->AddDisposeEffect(parent->driverData, cmd->effect);
+				break;
+			case DEFERRED_COMMAND_ADDDISPOSEQUERY:
+				parent->AddDisposeQuery(parent->driverData, cmd->query);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	else
+	{
+		/* Threaded contexts own their device, take it down with us */
+		DEFERRED_INTERNAL_Flush(context);
+		parent->DestroyDevice(parent);
+
+		for (i = 0; i < DEFERRED_RING_SIZE; i += 1)
+		{
+			SDL_free(context->ring[i].commands);
+			SDL_free(context->ring[i].memory);
+		}
+		SDL_free(context->ring);
+		SDL_DestroySemaphore(context->ringConsumed);
+	}
+
+	DEFERRED_INTERNAL_ForgetEffects(context);
+	SDL_free(context->effects);
+	SDL_DestroyMutex(context->effectsLock);
+
+	SDL_free(context->commands);
+	SDL_free(context->memory);
+	SDL_free(context);
+	SDL_free(device);
+}
+
+/* Presentation */
+
+static void DEFERRED_SwapBuffers(
+	FNA3D_Renderer *driverData,
+	FNA3D_Rect *sourceRectangle,
+	FNA3D_Rect *destinationRectangle,
+	void* overrideWindowHandle
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("SwapBuffers");
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SWAPBUFFERS
+	);
+	cmd->swapBuffers.hasSourceRectangle = (sourceRectangle != NULL);
+	if (sourceRectangle != NULL)
+	{
+		cmd->swapBuffers.sourceRectangle = *sourceRectangle;
+	}
+	cmd->swapBuffers.hasDestinationRectangle = (destinationRectangle != NULL);
+	if (destinationRectangle != NULL)
+	{
+		cmd->swapBuffers.destinationRectangle = *destinationRectangle;
+	}
+	cmd->swapBuffers.overrideWindowHandle = overrideWindowHandle;
+
+	/* The frame is done, let the render thread have it */
+	DEFERRED_INTERNAL_Submit(context, 0);
+}
+
+/* Drawing */
+
+static void DEFERRED_Clear(
+	FNA3D_Renderer *driverData,
+	FNA3D_ClearOptions options,
+	FNA3D_Vec4 *color,
+	float depth,
+	int32_t stencil
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_CLEAR
+	);
+
+	cmd->clear.options = options;
+	cmd->clear.color = *color;
+	cmd->clear.depth = depth;
+	cmd->clear.stencil = stencil;
+}
+
+static void DEFERRED_DrawIndexedPrimitives(
+	FNA3D_Renderer *driverData,
+	FNA3D_PrimitiveType primitiveType,
+	int32_t baseVertex,
+	int32_t minVertexIndex,
+	int32_t numVertices,
+	int32_t startIndex,
+	int32_t primitiveCount,
+	FNA3D_Buffer *indices,
+	FNA3D_IndexElementSize indexElementSize
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_DRAWINDEXEDPRIMITIVES
+	);
+
+	cmd->drawIndexedPrimitives.primitiveType = primitiveType;
+	cmd->drawIndexedPrimitives.baseVertex = baseVertex;
+	cmd->drawIndexedPrimitives.minVertexIndex = minVertexIndex;
+	cmd->drawIndexedPrimitives.numVertices = numVertices;
+	cmd->drawIndexedPrimitives.startIndex = startIndex;
+	cmd->drawIndexedPrimitives.primitiveCount = primitiveCount;
+	cmd->drawIndexedPrimitives.instanceCount = 1;
+	cmd->drawIndexedPrimitives.indices = indices;
+	cmd->drawIndexedPrimitives.indexElementSize = indexElementSize;
+}
+
+static void DEFERRED_DrawInstancedPrimitives(
+	FNA3D_Renderer *driverData,
+	FNA3D_PrimitiveType primitiveType,
+	int32_t baseVertex,
+	int32_t minVertexIndex,
+	int32_t numVertices,
+	int32_t startIndex,
+	int32_t primitiveCount,
+	int32_t instanceCount,
+	FNA3D_Buffer *indices,
+	FNA3D_IndexElementSize indexElementSize
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_DRAWINSTANCEDPRIMITIVES
+	);
+
+	cmd->drawIndexedPrimitives.primitiveType = primitiveType;
+	cmd->drawIndexedPrimitives.baseVertex = baseVertex;
+	cmd->drawIndexedPrimitives.minVertexIndex = minVertexIndex;
+	cmd->drawIndexedPrimitives.numVertices = numVertices;
+	cmd->drawIndexedPrimitives.startIndex = startIndex;
+	cmd->drawIndexedPrimitives.primitiveCount = primitiveCount;
+	cmd->drawIndexedPrimitives.instanceCount = instanceCount;
+	cmd->drawIndexedPrimitives.indices = indices;
+	cmd->drawIndexedPrimitives.indexElementSize = indexElementSize;
+}
+
+static void DEFERRED_DrawPrimitives(
+	FNA3D_Renderer *driverData,
+	FNA3D_PrimitiveType primitiveType,
+	int32_t vertexStart,
+	int32_t primitiveCount
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_DRAWPRIMITIVES
+	);
+
+	cmd->drawPrimitives.primitiveType = primitiveType;
+	cmd->drawPrimitives.vertexStart = vertexStart;
+	cmd->drawPrimitives.primitiveCount = primitiveCount;
+}
+
+/* Mutable Render States */
+
+static void DEFERRED_SetViewport(
+	FNA3D_Renderer *driverData,
+	FNA3D_Viewport *viewport
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETVIEWPORT
+	);
+
+	cmd->viewport = *viewport;
+}
+
+static void DEFERRED_SetScissorRect(
+	FNA3D_Renderer *driverData,
+	FNA3D_Rect *scissor
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETSCISSORRECT
+	);
+
+	cmd->scissor = *scissor;
+}
+
+static void DEFERRED_GetBlendFactor(
+	FNA3D_Renderer *driverData,
+	FNA3D_Color *blendFactor
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	*blendFactor = context->blendFactor;
+}
+
+static void DEFERRED_SetBlendFactor(
+	FNA3D_Renderer *driverData,
+	FNA3D_Color *blendFactor
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETBLENDFACTOR
+	);
+
+	cmd->blendFactor = *blendFactor;
+	context->blendFactor = *blendFactor;
+}
+
+static int32_t DEFERRED_GetMultiSampleMask(FNA3D_Renderer *driverData)
+{
+	DeferredContext *context = (DeferredContext*) driverData;
+	return context->multiSampleMask;
+}
+
+static void DEFERRED_SetMultiSampleMask(
+	FNA3D_Renderer *driverData,
+	int32_t mask
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETMULTISAMPLEMASK
+	);
+
+	cmd->multiSampleMask = mask;
+	context->multiSampleMask = mask;
+}
+
+static int32_t DEFERRED_GetReferenceStencil(FNA3D_Renderer *driverData)
+{
+	DeferredContext *context = (DeferredContext*) driverData;
+	return context->referenceStencil;
+}
+
+static void DEFERRED_SetReferenceStencil(
+	FNA3D_Renderer *driverData,
+	int32_t ref
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETREFERENCESTENCIL
+	);
+
+	cmd->referenceStencil = ref;
+	context->referenceStencil = ref;
+}
+
+/* Immutable Render States */
+
+static void DEFERRED_SetBlendState(
+	FNA3D_Renderer *driverData,
+	FNA3D_BlendState *blendState
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETBLENDSTATE
+	);
+
+	cmd->blendState = *blendState;
+}
+
+static void DEFERRED_SetDepthStencilState(
+	FNA3D_Renderer *driverData,
+	FNA3D_DepthStencilState *depthStencilState
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETDEPTHSTENCILSTATE
+	);
+
+	cmd->depthStencilState = *depthStencilState;
+}
+
+static void DEFERRED_ApplyRasterizerState(
+	FNA3D_Renderer *driverData,
+	FNA3D_RasterizerState *rasterizerState
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_APPLYRASTERIZERSTATE
+	);
+
+	cmd->rasterizerState = *rasterizerState;
+}
+
+static void DEFERRED_VerifySampler(
+	FNA3D_Renderer *driverData,
+	int32_t index,
+	FNA3D_Texture *texture,
+	FNA3D_SamplerState *sampler
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_VERIFYSAMPLER
+	);
+
+	cmd->verifySampler.index = index;
+	cmd->verifySampler.texture = texture;
+	cmd->verifySampler.sampler = *sampler;
+}
+
+static void DEFERRED_VerifyVertexSampler(
+	FNA3D_Renderer *driverData,
+	int32_t index,
+	FNA3D_Texture *texture,
+	FNA3D_SamplerState *sampler
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_VERIFYVERTEXSAMPLER
+	);
+
+	cmd->verifySampler.index = index;
+	cmd->verifySampler.texture = texture;
+	cmd->verifySampler.sampler = *sampler;
+}
+
+static void DEFERRED_ApplyVertexBufferBindings(
+	FNA3D_Renderer *driverData,
+	FNA3D_VertexBufferBinding *bindings,
+	int32_t numBindings,
+	uint8_t bindingsUpdated,
+	int32_t baseVertex
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_APPLYVERTEXBUFFERBINDINGS
+	);
+	size_t offset, length;
+	int32_t i;
+
+	/* The element arrays follow the bindings, in binding order */
+	length = sizeof(FNA3D_VertexBufferBinding) * numBindings;
+	for (i = 0; i < numBindings; i += 1)
+	{
+		length += sizeof(FNA3D_VertexElement) * bindings[i].vertexDeclaration.elementCount;
+	}
+	offset = DEFERRED_INTERNAL_CopyMemory(context, NULL, length);
+	cmd->applyVertexBufferBindings.bindings = offset;
+
+	SDL_memcpy(
+		context->memory + offset,
+		bindings,
+		sizeof(FNA3D_VertexBufferBinding) * numBindings
+	);
+	offset += sizeof(FNA3D_VertexBufferBinding) * numBindings;
+	for (i = 0; i < numBindings; i += 1)
+	{
+		length = sizeof(FNA3D_VertexElement) * bindings[i].vertexDeclaration.elementCount;
+		SDL_memcpy(
+			context->memory + offset,
+			bindings[i].vertexDeclaration.elements,
+			length
+		);
+		offset += length;
+	}
+	cmd->applyVertexBufferBindings.numBindings = numBindings;
+	cmd->applyVertexBufferBindings.baseVertex = baseVertex;
+}
+
+/* Render Targets */
+
+static void DEFERRED_SetRenderTargets(
+	FNA3D_Renderer *driverData,
+	FNA3D_RenderTargetBinding *renderTargets,
+	int32_t numRenderTargets,
+	FNA3D_Renderbuffer *depthStencilBuffer,
+	FNA3D_DepthFormat depthFormat,
+	uint8_t preserveTargetContents
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETRENDERTARGETS
+	);
+
+	if (renderTargets == NULL)
+	{
+		numRenderTargets = 0;
+	}
+	cmd->setRenderTargets.renderTargets = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		renderTargets,
+		sizeof(FNA3D_RenderTargetBinding) * numRenderTargets
+	);
+	cmd->setRenderTargets.numRenderTargets = numRenderTargets;
+	cmd->setRenderTargets.depthStencilBuffer = depthStencilBuffer;
+	cmd->setRenderTargets.depthFormat = depthFormat;
+	cmd->setRenderTargets.preserveTargetContents = preserveTargetContents;
+}
+
+static void DEFERRED_ResolveTarget(
+	FNA3D_Renderer *driverData,
+	FNA3D_RenderTargetBinding *target
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_RESOLVETARGET
+	);
+
+	cmd->resolveTarget = *target;
+}
+
+/* Backbuffer Functions */
+
+static void DEFERRED_ResetBackbuffer(
+	FNA3D_Renderer *driverData,
+	FNA3D_PresentationParameters *presentationParameters
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("ResetBackbuffer");
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_RESETBACKBUFFER
+	);
+	cmd->presentationParameters = presentationParameters;
+	DEFERRED_INTERNAL_Submit(context, 1);
+}
+
+static void DEFERRED_ReadBackbuffer(
+	FNA3D_Renderer *driverData,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("ReadBackbuffer");
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_READBACKBUFFER
+	);
+	cmd->readBackbuffer.x = x;
+	cmd->readBackbuffer.y = y;
+	cmd->readBackbuffer.w = w;
+	cmd->readBackbuffer.h = h;
+	cmd->readBackbuffer.data = data;
+	cmd->readBackbuffer.dataLength = dataLength;
+	DEFERRED_INTERNAL_Submit(context, 1);
+}
+
+static void DEFERRED_GetBackbufferSize(
+	FNA3D_Renderer *driverData,
+	int32_t *w,
+	int32_t *h
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->GetBackbufferSize(parent->driverData, w, h);
+}
+
+static FNA3D_SurfaceFormat DEFERRED_GetBackbufferSurfaceFormat(
+	FNA3D_Renderer *driverData
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GetBackbufferSurfaceFormat(parent->driverData);
+}
+
+static FNA3D_DepthFormat DEFERRED_GetBackbufferDepthFormat(
+	FNA3D_Renderer *driverData
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GetBackbufferDepthFormat(parent->driverData);
+}
+
+static int32_t DEFERRED_GetBackbufferMultiSampleCount(
+	FNA3D_Renderer *driverData
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GetBackbufferMultiSampleCount(parent->driverData);
+}
+
+/* Textures */
+
+static FNA3D_Texture* DEFERRED_CreateTexture2D(
+	FNA3D_Renderer *driverData,
+	FNA3D_SurfaceFormat format,
+	int32_t width,
+	int32_t height,
+	int32_t levelCount,
+	uint8_t isRenderTarget
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->CreateTexture2D(
+		parent->driverData,
+		format,
+		width,
+		height,
+		levelCount,
+		isRenderTarget
+	);
+}
+
+static FNA3D_Texture* DEFERRED_CreateTexture3D(
+	FNA3D_Renderer *driverData,
+	FNA3D_SurfaceFormat format,
+	int32_t width,
+	int32_t height,
+	int32_t depth,
+	int32_t levelCount
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->CreateTexture3D(
+		parent->driverData,
+		format,
+		width,
+		height,
+		depth,
+		levelCount
+	);
+}
+
+static FNA3D_Texture* DEFERRED_CreateTextureCube(
+	FNA3D_Renderer *driverData,
+	FNA3D_SurfaceFormat format,
+	int32_t size,
+	int32_t levelCount,
+	uint8_t isRenderTarget
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->CreateTextureCube(
+		parent->driverData,
+		format,
+		size,
+		levelCount,
+		isRenderTarget
+	);
+}
+
+static void DEFERRED_AddDisposeTexture(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	/* Recorded draws may still use it, so dispose in order */
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSETEXTURE
+		);
+		cmd->texture = texture;
+		return;
+	}
+	context->parent->AddDisposeTexture(
+		context->parent->driverData,
+		texture
+	);
+}
+
+static void DEFERRED_SetTextureData2D(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		context->parent->SetTextureData2D(
+			context->parent->driverData,
+			texture,
+			x,
+			y,
+			w,
+			h,
+			level,
+			data,
+			dataLength
+		);
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETTEXTUREDATA2D
+	);
+
+	cmd->setTextureData.texture = texture;
+	cmd->setTextureData.x = x;
+	cmd->setTextureData.y = y;
+	cmd->setTextureData.w = w;
+	cmd->setTextureData.h = h;
+	cmd->setTextureData.level = level;
+	cmd->setTextureData.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		dataLength
+	);
+	cmd->setTextureData.dataLength = dataLength;
+}
+
+static void DEFERRED_SetTextureData3D(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t z,
+	int32_t w,
+	int32_t h,
+	int32_t d,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		context->parent->SetTextureData3D(
+			context->parent->driverData,
+			texture,
+			x,
+			y,
+			z,
+			w,
+			h,
+			d,
+			level,
+			data,
+			dataLength
+		);
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETTEXTUREDATA3D
+	);
+
+	cmd->setTextureData.texture = texture;
+	cmd->setTextureData.x = x;
+	cmd->setTextureData.y = y;
+	cmd->setTextureData.z = z;
+	cmd->setTextureData.w = w;
+	cmd->setTextureData.h = h;
+	cmd->setTextureData.d = d;
+	cmd->setTextureData.level = level;
+	cmd->setTextureData.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		dataLength
+	);
+	cmd->setTextureData.dataLength = dataLength;
+}
+
+static void DEFERRED_SetTextureDataCube(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	FNA3D_CubeMapFace cubeMapFace,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		context->parent->SetTextureDataCube(
+			context->parent->driverData,
+			texture,
+			x,
+			y,
+			w,
+			h,
+			cubeMapFace,
+			level,
+			data,
+			dataLength
+		);
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETTEXTUREDATACUBE
+	);
+
+	cmd->setTextureData.texture = texture;
+	cmd->setTextureData.x = x;
+	cmd->setTextureData.y = y;
+	cmd->setTextureData.w = w;
+	cmd->setTextureData.h = h;
+	cmd->setTextureData.cubeMapFace = cubeMapFace;
+	cmd->setTextureData.level = level;
+	cmd->setTextureData.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		dataLength
+	);
+	cmd->setTextureData.dataLength = dataLength;
+}
+
+static void DEFERRED_SetTextureDataYUV(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *y,
+	FNA3D_Texture *u,
+	FNA3D_Texture *v,
+	int32_t yWidth,
+	int32_t yHeight,
+	int32_t uvWidth,
+	int32_t uvHeight,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETTEXTUREDATAYUV
+	);
+
+	cmd->setTextureDataYUV.y = y;
+	cmd->setTextureDataYUV.u = u;
+	cmd->setTextureDataYUV.v = v;
+	cmd->setTextureDataYUV.yWidth = yWidth;
+	cmd->setTextureDataYUV.yHeight = yHeight;
+	cmd->setTextureDataYUV.uvWidth = uvWidth;
+	cmd->setTextureDataYUV.uvHeight = uvHeight;
+	cmd->setTextureDataYUV.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		dataLength
+	);
+	cmd->setTextureDataYUV.dataLength = dataLength;
+}
+
+static void DEFERRED_GetTextureData2D(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetTextureData2D");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	context->parent->GetTextureData2D(
+		context->parent->driverData,
+		texture,
+		x,
+		y,
+		w,
+		h,
+		level,
+		data,
+		dataLength
+	);
+}
+
+static void DEFERRED_GetTextureData3D(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t z,
+	int32_t w,
+	int32_t h,
+	int32_t d,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetTextureData3D");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	context->parent->GetTextureData3D(
+		context->parent->driverData,
+		texture,
+		x,
+		y,
+		z,
+		w,
+		h,
+		d,
+		level,
+		data,
+		dataLength
+	);
+}
+
+static void DEFERRED_GetTextureDataCube(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	FNA3D_CubeMapFace cubeMapFace,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetTextureDataCube");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	context->parent->GetTextureDataCube(
+		context->parent->driverData,
+		texture,
+		x,
+		y,
+		w,
+		h,
+		cubeMapFace,
+		level,
+		data,
+		dataLength
+	);
+}
+
+/* Renderbuffers */
+
+static FNA3D_Renderbuffer* DEFERRED_GenColorRenderbuffer(
+	FNA3D_Renderer *driverData,
+	int32_t width,
+	int32_t height,
+	FNA3D_SurfaceFormat format,
+	int32_t multiSampleCount,
+	FNA3D_Texture *texture
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GenColorRenderbuffer(
+		parent->driverData,
+		width,
+		height,
+		format,
+		multiSampleCount,
+		texture
+	);
+}
+
+static FNA3D_Renderbuffer* DEFERRED_GenDepthStencilRenderbuffer(
+	FNA3D_Renderer *driverData,
+	int32_t width,
+	int32_t height,
+	FNA3D_DepthFormat format,
+	int32_t multiSampleCount
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GenDepthStencilRenderbuffer(
+		parent->driverData,
+		width,
+		height,
+		format,
+		multiSampleCount
+	);
+}
+
+static void DEFERRED_AddDisposeRenderbuffer(
+	FNA3D_Renderer *driverData,
+	FNA3D_Renderbuffer *renderbuffer
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSERENDERBUFFER
+		);
+		cmd->renderbuffer = renderbuffer;
+		return;
+	}
+	context->parent->AddDisposeRenderbuffer(
+		context->parent->driverData,
+		renderbuffer
+	);
+}
+
+/* Vertex Buffers */
+
+static FNA3D_Buffer* DEFERRED_GenVertexBuffer(
+	FNA3D_Renderer *driverData,
+	uint8_t dynamic,
+	FNA3D_BufferUsage usage,
+	int32_t sizeInBytes
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GenVertexBuffer(
+		parent->driverData,
+		dynamic,
+		usage,
+		sizeInBytes
+	);
+}
+
+static void DEFERRED_AddDisposeVertexBuffer(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSEVERTEXBUFFER
+		);
+		cmd->buffer = buffer;
+		return;
+	}
+	context->parent->AddDisposeVertexBuffer(
+		context->parent->driverData,
+		buffer
+	);
+}
+
+static void DEFERRED_SetVertexBufferData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	void* data,
+	int32_t elementCount,
+	int32_t elementSizeInBytes,
+	int32_t vertexStride,
+	FNA3D_SetDataOptions options
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		context->parent->SetVertexBufferData(
+			context->parent->driverData,
+			buffer,
+			offsetInBytes,
+			data,
+			elementCount,
+			elementSizeInBytes,
+			vertexStride,
+			options
+		);
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETVERTEXBUFFERDATA
+	);
+
+	cmd->setVertexBufferData.buffer = buffer;
+	cmd->setVertexBufferData.offsetInBytes = offsetInBytes;
+	cmd->setVertexBufferData.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		(size_t) elementCount * vertexStride
+	);
+	cmd->setVertexBufferData.elementCount = elementCount;
+	cmd->setVertexBufferData.elementSizeInBytes = elementSizeInBytes;
+	cmd->setVertexBufferData.vertexStride = vertexStride;
+	cmd->setVertexBufferData.options = options;
+}
+
+static void DEFERRED_GetVertexBufferData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	void* data,
+	int32_t elementCount,
+	int32_t elementSizeInBytes,
+	int32_t vertexStride
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetVertexBufferData");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	context->parent->GetVertexBufferData(
+		context->parent->driverData,
+		buffer,
+		offsetInBytes,
+		data,
+		elementCount,
+		elementSizeInBytes,
+		vertexStride
+	);
+}
+
+/* Index Buffers */
+
+static FNA3D_Buffer* DEFERRED_GenIndexBuffer(
+	FNA3D_Renderer *driverData,
+	uint8_t dynamic,
+	FNA3D_BufferUsage usage,
+	int32_t sizeInBytes
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GenIndexBuffer(
+		parent->driverData,
+		dynamic,
+		usage,
+		sizeInBytes
+	);
+}
+
+static void DEFERRED_AddDisposeIndexBuffer(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSEINDEXBUFFER
+		);
+		cmd->buffer = buffer;
+		return;
+	}
+	context->parent->AddDisposeIndexBuffer(
+		context->parent->driverData,
+		buffer
+	);
+}
+
+static void DEFERRED_SetIndexBufferData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	void* data,
+	int32_t dataLength,
+	FNA3D_SetDataOptions options
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		context->parent->SetIndexBufferData(
+			context->parent->driverData,
+			buffer,
+			offsetInBytes,
+			data,
+			dataLength,
+			options
+		);
+		return;
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETINDEXBUFFERDATA
+	);
+
+	cmd->setIndexBufferData.buffer = buffer;
+	cmd->setIndexBufferData.offsetInBytes = offsetInBytes;
+	cmd->setIndexBufferData.data = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		data,
+		dataLength
+	);
+	cmd->setIndexBufferData.dataLength = dataLength;
+	cmd->setIndexBufferData.options = options;
+}
+
+static void DEFERRED_GetIndexBufferData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	void* data,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetIndexBufferData");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	context->parent->GetIndexBufferData(
+		context->parent->driverData,
+		buffer,
+		offsetInBytes,
+		data,
+		dataLength
+	);
+}
+
+/* Effects */
+
+static void DEFERRED_CreateEffect(
+	FNA3D_Renderer *driverData,
+	uint8_t *effectCode,
+	uint32_t effectCodeLength,
+	FNA3D_Effect **effect,
+	MOJOSHADER_effect **effectData
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	context->parent->CreateEffect(
+		context->parent->driverData,
+		effectCode,
+		effectCodeLength,
+		effect,
+		effectData
+	);
+
+	/* Nothing has applied it yet, so these are the real parameters */
+	SDL_LockMutex(context->effectsLock);
+	DEFERRED_INTERNAL_TrackEffect(context, *effect, *effectData);
+	SDL_UnlockMutex(context->effectsLock);
+}
+
+static void DEFERRED_CloneEffect(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *cloneSource,
+	FNA3D_Effect **effect,
+	MOJOSHADER_effect **effectData
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	context->parent->CloneEffect(
+		context->parent->driverData,
+		cloneSource,
+		effect,
+		effectData
+	);
+
+	SDL_LockMutex(context->effectsLock);
+	DEFERRED_INTERNAL_TrackEffect(context, *effect, *effectData);
+	SDL_UnlockMutex(context->effectsLock);
+}
+
+static void DEFERRED_AddDisposeEffect(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	/* The pointer may be reused by the next effect */
+	SDL_LockMutex(context->effectsLock);
+	DEFERRED_INTERNAL_ForgetEffect(context, effect);
+	SDL_UnlockMutex(context->effectsLock);
+
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSEEFFECT
+		);
+		cmd->effect = effect;
+		return;
+	}
+	context->parent->AddDisposeEffect(
+		context->parent->driverData,
+		effect
+	);
+}
+
+static void DEFERRED_SetEffectTechnique(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect,
+	MOJOSHADER_effectTechnique *technique
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETEFFECTTECHNIQUE
+	);
+
+	cmd->setEffectTechnique.effect = effect;
+	cmd->setEffectTechnique.technique = technique;
+
+	/* The effect's own technique only changes once this is executed */
+	SDL_LockMutex(context->effectsLock);
+	DEFERRED_INTERNAL_FetchEffect(
+		context,
+		effect,
+		context->parent->GetEffectData(
+			context->parent->driverData,
+			effect
+		)
+	)->technique = technique;
+	SDL_UnlockMutex(context->effectsLock);
+}
+
+static void DEFERRED_ApplyEffect(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect,
+	uint32_t pass,
+	MOJOSHADER_effectStateChanges *stateChanges
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+	MOJOSHADER_effect *effectData = context->parent->GetEffectData(
+		context->parent->driverData,
+		effect
+	);
+	DeferredEffect *deferredEffect;
+	uint8_t hasStateChanges;
+	size_t offset, length;
+	int32_t i;
+
+	SDL_LockMutex(context->effectsLock);
+	deferredEffect = DEFERRED_INTERNAL_FetchEffect(context, effect, effectData);
+	hasStateChanges = DEFERRED_INTERNAL_HasStateChanges(
+		deferredEffect,
+		effectData,
+		pass
+	);
+
+	if (hasStateChanges && context->ring == NULL)
+	{
+		/* The caller applies these right after this, which records them
+		 * after the apply, same order as on the parent.
+		 */
+		DEFERRED_INTERNAL_FillStateChanges(
+			deferredEffect,
+			effectData,
+			pass,
+			stateChanges
+		);
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_APPLYEFFECT
+	);
+
+	/* The caller keeps writing parameters after this returns, so take a
+	 * copy of all of them, same as the trace does. Objects aren't plain
+	 * data, so those are left alone. Room for the live pointers is kept in
+	 * front, execution points the effect at the copy while it's applied.
+	 */
+	length = 0;
+	for (i = 0; i < effectData->param_count; i += 1)
+	{
+		if (effectData->params[i].value.type.parameter_class != MOJOSHADER_SYMCLASS_OBJECT)
+		{
+			length += effectData->params[i].value.value_count * 4;
+		}
+	}
+	length += sizeof(void*) * effectData->param_count;
+	offset = DEFERRED_INTERNAL_CopyMemory(context, NULL, length);
+	cmd->applyEffect.params = offset;
+	offset += sizeof(void*) * effectData->param_count;
+	for (i = 0; i < effectData->param_count; i += 1)
+	{
+		if (effectData->params[i].value.type.parameter_class == MOJOSHADER_SYMCLASS_OBJECT)
+		{
+			continue;
+		}
+		length = effectData->params[i].value.value_count * 4;
+		SDL_memcpy(
+			context->memory + offset,
+			deferredEffect->values[i],
+			length
+		);
+		offset += length;
+	}
+	SDL_UnlockMutex(context->effectsLock);
+
+	cmd->applyEffect.effect = effect;
+	cmd->applyEffect.pass = pass;
+	cmd->applyEffect.stateChanges = (context->ring != NULL) ?
+		&context->stateChanges :
+		&discardedStateChanges;
+
+	if (hasStateChanges && context->ring != NULL)
+	{
+		/* The caller applies these as soon as we return */
+		DEFERRED_INTERNAL_Submit(context, 1);
+		SDL_memcpy(
+			stateChanges,
+			&context->stateChanges,
+			sizeof(MOJOSHADER_effectStateChanges)
+		);
+	}
+	else if (!hasStateChanges)
+	{
+		/* Nothing has been applied yet */
+		SDL_zerop(stateChanges);
+	}
+}
+
+static void DEFERRED_BeginPassRestore(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect,
+	MOJOSHADER_effectStateChanges *stateChanges
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+	MOJOSHADER_effect *effectData = context->parent->GetEffectData(
+		context->parent->driverData,
+		effect
+	);
+	DeferredEffect *deferredEffect;
+	uint8_t hasStateChanges;
+
+	/* Restores always begin the first pass */
+	SDL_LockMutex(context->effectsLock);
+	deferredEffect = DEFERRED_INTERNAL_FetchEffect(context, effect, effectData);
+	hasStateChanges = DEFERRED_INTERNAL_HasStateChanges(
+		deferredEffect,
+		effectData,
+		0
+	);
+	if (hasStateChanges && context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_FillStateChanges(
+			deferredEffect,
+			effectData,
+			0,
+			stateChanges
+		);
+	}
+	SDL_UnlockMutex(context->effectsLock);
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_BEGINPASSRESTORE
+	);
+	cmd->passRestore.effect = effect;
+	cmd->passRestore.stateChanges = (context->ring != NULL) ?
+		&context->stateChanges :
+		&discardedStateChanges;
+
+	if (hasStateChanges && context->ring != NULL)
+	{
+		DEFERRED_INTERNAL_Submit(context, 1);
+		SDL_memcpy(
+			stateChanges,
+			&context->stateChanges,
+			sizeof(MOJOSHADER_effectStateChanges)
+		);
+	}
+	else if (!hasStateChanges)
+	{
+		SDL_zerop(stateChanges);
+	}
+}
+
+static void DEFERRED_EndPassRestore(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_ENDPASSRESTORE
+	);
+	cmd->passRestore.effect = effect;
+	cmd->passRestore.stateChanges = NULL;
+}
+
+static MOJOSHADER_effect* DEFERRED_GetEffectData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GetEffectData(parent->driverData, effect);
+}
+
+/* Queries */
+
+static FNA3D_Query* DEFERRED_CreateQuery(FNA3D_Renderer *driverData)
+{
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+	FNA3D_Query *result;
+
+	if (context->ring == NULL || DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		return context->parent->CreateQuery(context->parent->driverData);
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_CREATEQUERY
+	);
+	cmd->createQuery = &result;
+	DEFERRED_INTERNAL_Submit(context, 1);
+	return result;
+}
+
+static void DEFERRED_AddDisposeQuery(
+	FNA3D_Renderer *driverData,
+	FNA3D_Query *query
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (!DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		cmd = DEFERRED_INTERNAL_AddCommand(
+			context,
+			DEFERRED_COMMAND_ADDDISPOSEQUERY
+		);
+		cmd->query = query;
+		return;
+	}
+	context->parent->AddDisposeQuery(
+		context->parent->driverData,
+		query
+	);
+}
+
+static void DEFERRED_QueryBegin(FNA3D_Renderer *driverData, FNA3D_Query *query)
+{
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_QUERYBEGIN
+	);
+
+	cmd->query = query;
+}
+
+static void DEFERRED_QueryEnd(FNA3D_Renderer *driverData, FNA3D_Query *query)
+{
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_QUERYEND
+	);
+
+	cmd->query = query;
+}
+
+static uint8_t DEFERRED_QueryComplete(
+	FNA3D_Renderer *driverData,
+	FNA3D_Query *query
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+	uint8_t result;
+
+	if (context->ring == NULL || DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		return context->parent->QueryComplete(
+			context->parent->driverData,
+			query
+		);
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_QUERYCOMPLETE
+	);
+	cmd->queryResult.query = query;
+	cmd->queryResult.complete = &result;
+	DEFERRED_INTERNAL_Submit(context, 1);
+	return result;
+}
+
+static int32_t DEFERRED_QueryPixelCount(
+	FNA3D_Renderer *driverData,
+	FNA3D_Query *query
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+	int32_t result;
+
+	if (context->ring == NULL || DEFERRED_INTERNAL_IsOffThread(context))
+	{
+		return context->parent->QueryPixelCount(
+			context->parent->driverData,
+			query
+		);
+	}
+
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_QUERYPIXELCOUNT
+	);
+	cmd->queryResult.query = query;
+	cmd->queryResult.pixelCount = &result;
+	DEFERRED_INTERNAL_Submit(context, 1);
+	return result;
+}
+
+/* Feature Queries */
+
+static uint8_t DEFERRED_SupportsDXT1(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsDXT1(parent->driverData);
+}
+
+static uint8_t DEFERRED_SupportsS3TC(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsS3TC(parent->driverData);
+}
+
+static uint8_t DEFERRED_SupportsBC7(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsBC7(parent->driverData);
+}
+
+static uint8_t DEFERRED_SupportsHardwareInstancing(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsHardwareInstancing(parent->driverData);
+}
+
+static uint8_t DEFERRED_SupportsNoOverwrite(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsNoOverwrite(parent->driverData);
+}
+
+static uint8_t DEFERRED_SupportsSRGBRenderTargets(FNA3D_Renderer *driverData)
+{
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->SupportsSRGBRenderTargets(parent->driverData);
+}
+
+static void DEFERRED_GetMaxTextureSlots(
+	FNA3D_Renderer *driverData,
+	int32_t *textures,
+	int32_t *vertexTextures
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->GetMaxTextureSlots(parent->driverData, textures, vertexTextures);
+}
+
+static int32_t DEFERRED_GetMaxMultiSampleCount(
+	FNA3D_Renderer *driverData,
+	FNA3D_SurfaceFormat format,
+	int32_t multiSampleCount
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->GetMaxMultiSampleCount(
+		parent->driverData,
+		format,
+		multiSampleCount
+	);
+}
+
+/* Debugging */
+
+static void DEFERRED_SetStringMarker(
+	FNA3D_Renderer *driverData,
+	const char *text
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETSTRINGMARKER
+	);
+
+	cmd->text = DEFERRED_INTERNAL_CopyMemory(
+		context,
+		text,
+		SDL_strlen(text) + 1
+	);
+}
+
+static void DEFERRED_SetTextureName(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	const char *text
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->SetTextureName(parent->driverData, texture, text);
+}
+
+/* Pipeline Cache Statistics */
+
+static void DEFERRED_GetPipelineCacheStats(
+	FNA3D_Renderer *driverData,
+	FNA3D_PipelineCacheStatsEXT *stats
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->GetPipelineCacheStats(parent->driverData, stats);
+}
+
+/* Asynchronous Readback */
+
+static FNA3D_ReadbackEXT* DEFERRED_GetTextureDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetTextureDataAsync");
+		return NULL;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	return context->parent->GetTextureDataAsync(
+		context->parent->driverData,
+		texture,
+		x,
+		y,
+		w,
+		h,
+		level,
+		dataLength
+	);
+}
+
+static FNA3D_ReadbackEXT* DEFERRED_GetBufferDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("GetBufferDataAsync");
+		return NULL;
+	}
+
+	DEFERRED_INTERNAL_Flush(context);
+	return context->parent->GetBufferDataAsync(
+		context->parent->driverData,
+		buffer,
+		offsetInBytes,
+		dataLength
+	);
+}
+
+static uint8_t DEFERRED_PollReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->PollReadback(parent->driverData, readback);
+}
+
+static void DEFERRED_WaitReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->WaitReadback(parent->driverData, readback, data, dataLength);
+}
+
+/* Backbuffer Capture */
+
+static void DEFERRED_SetBackbufferCapture(
+	FNA3D_Renderer *driverData,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+) {
+	DeferredContext *context = (DeferredContext*) driverData;
+	DeferredCommand *cmd;
+
+	if (context->ring == NULL)
+	{
+		DEFERRED_INTERNAL_Unsupported("SetBackbufferCapture");
+		return;
+	}
+
+	/* The callback will run on the render thread! */
+	cmd = DEFERRED_INTERNAL_AddCommand(
+		context,
+		DEFERRED_COMMAND_SETBACKBUFFERCAPTURE
+	);
+	cmd->setBackbufferCapture.frameCount = frameCount;
+	cmd->setBackbufferCapture.callback = callback;
+	cmd->setBackbufferCapture.userdata = userdata;
+}
+
+/* External Interop */
+
+static void DEFERRED_GetSysRenderer(
+	FNA3D_Renderer *driverData,
+	FNA3D_SysRendererEXT *sysrenderer
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	parent->GetSysRenderer(parent->driverData, sysrenderer);
+}
+
+static FNA3D_Texture* DEFERRED_CreateSysTexture(
+	FNA3D_Renderer *driverData,
+	FNA3D_SysTextureEXT *externalTextureInfo
+) {
+	FNA3D_Device *parent = ((DeferredContext*) driverData)->parent;
+	return parent->CreateSysTexture(parent->driverData, externalTextureInfo);
+}
+
+/* Command Execution */
+
+static void DEFERRED_INTERNAL_Execute(
+	FNA3D_Device *device,
+	DeferredCommand *commands,
+	int32_t commandCount,
+	uint8_t *memory
+) {
+	DeferredCommand *cmd;
+	FNA3D_VertexBufferBinding *bindings;
+	FNA3D_VertexElement *elements;
+	MOJOSHADER_effect *effectData;
+	void **live;
+	uint8_t *params;
+	int32_t i, j;
+
+	/* The calls were traced as they were recorded, so go straight to the
+	 * driver instead of through the public API.
+	 */
+	for (i = 0; i < commandCount; i += 1)
+	{
+		cmd = &commands[i];
+		switch (cmd->type)
+		{
+		case DEFERRED_COMMAND_CLEAR:
+			device->Clear(
+				device->driverData,
+				cmd->clear.options,
+				&cmd->clear.color,
+				cmd->clear.depth,
+				cmd->clear.stencil
+			);
+			break;
+		case DEFERRED_COMMAND_DRAWINDEXEDPRIMITIVES:
+			device->DrawIndexedPrimitives(
+				device->driverData,
+				cmd->drawIndexedPrimitives.primitiveType,
+				cmd->drawIndexedPrimitives.baseVertex,
+				cmd->drawIndexedPrimitives.minVertexIndex,
+				cmd->drawIndexedPrimitives.numVertices,
+				cmd->drawIndexedPrimitives.startIndex,
+				cmd->drawIndexedPrimitives.primitiveCount,
+				cmd->drawIndexedPrimitives.indices,
+				cmd->drawIndexedPrimitives.indexElementSize
+			);
+			break;
+		case DEFERRED_COMMAND_DRAWINSTANCEDPRIMITIVES:
+			device->DrawInstancedPrimitives(
+				device->driverData,
+				cmd->drawIndexedPrimitives.primitiveType,
+				cmd->drawIndexedPrimitives.baseVertex,
+				cmd->drawIndexedPrimitives.minVertexIndex,
+				cmd->drawIndexedPrimitives.numVertices,
+				cmd->drawIndexedPrimitives.startIndex,
+				cmd->drawIndexedPrimitives.primitiveCount,
+				cmd->drawIndexedPrimitives.instanceCount,
+				cmd->drawIndexedPrimitives.indices,
+				cmd->drawIndexedPrimitives.indexElementSize
+			);
+			break;
+		case DEFERRED_COMMAND_DRAWPRIMITIVES:
+			device->DrawPrimitives(
+				device->driverData,
+				cmd->drawPrimitives.primitiveType,
+				cmd->drawPrimitives.vertexStart,
+				cmd->drawPrimitives.primitiveCount
+			);
+			break;
+		case DEFERRED_COMMAND_SETVIEWPORT:
+			device->SetViewport(device->driverData, &cmd->viewport);
+			break;
+		case DEFERRED_COMMAND_SETSCISSORRECT:
+			device->SetScissorRect(device->driverData, &cmd->scissor);
+			break;
+		case DEFERRED_COMMAND_SETBLENDFACTOR:
+			device->SetBlendFactor(device->driverData, &cmd->blendFactor);
+			break;
+		case DEFERRED_COMMAND_SETMULTISAMPLEMASK:
+			device->SetMultiSampleMask(
+				device->driverData,
+				cmd->multiSampleMask
+			);
+			break;
+		case DEFERRED_COMMAND_SETREFERENCESTENCIL:
+			device->SetReferenceStencil(
+				device->driverData,
+				cmd->referenceStencil
+			);
+			break;
+		case DEFERRED_COMMAND_SETBLENDSTATE:
+			device->SetBlendState(device->driverData, &cmd->blendState);
+			break;
+		case DEFERRED_COMMAND_SETDEPTHSTENCILSTATE:
+			device->SetDepthStencilState(
+				device->driverData,
+				&cmd->depthStencilState
+			);
+			break;
+		case DEFERRED_COMMAND_APPLYRASTERIZERSTATE:
+			device->ApplyRasterizerState(
+				device->driverData,
+				&cmd->rasterizerState
+			);
+			break;
+		case DEFERRED_COMMAND_VERIFYSAMPLER:
+			device->VerifySampler(
+				device->driverData,
+				cmd->verifySampler.index,
+				cmd->verifySampler.texture,
+				&cmd->verifySampler.sampler
+			);
+			break;
+		case DEFERRED_COMMAND_VERIFYVERTEXSAMPLER:
+			device->VerifyVertexSampler(
+				device->driverData,
+				cmd->verifySampler.index,
+				cmd->verifySampler.texture,
+				&cmd->verifySampler.sampler
+			);
+			break;
+		case DEFERRED_COMMAND_APPLYVERTEXBUFFERBINDINGS:
+			bindings = (FNA3D_VertexBufferBinding*) (
+				memory + cmd->applyVertexBufferBindings.bindings
+			);
+			elements = (FNA3D_VertexElement*) (
+				bindings + cmd->applyVertexBufferBindings.numBindings
+			);
+			for (j = 0; j < cmd->applyVertexBufferBindings.numBindings; j += 1)
+			{
+				bindings[j].vertexDeclaration.elements = elements;
+				elements += bindings[j].vertexDeclaration.elementCount;
+			}
+
+			/* The driver's binding cache may have moved on since this
+			 * was recorded, so always have it look again.
+			 */
+			device->ApplyVertexBufferBindings(
+				device->driverData,
+				bindings,
+				cmd->applyVertexBufferBindings.numBindings,
+				1,
+				cmd->applyVertexBufferBindings.baseVertex
+			);
+			break;
+		case DEFERRED_COMMAND_SETRENDERTARGETS:
+			device->SetRenderTargets(
+				device->driverData,
+				(cmd->setRenderTargets.numRenderTargets > 0) ?
+					(FNA3D_RenderTargetBinding*) (
+						memory +
+						cmd->setRenderTargets.renderTargets
+					) :
+					NULL,
+				cmd->setRenderTargets.numRenderTargets,
+				cmd->setRenderTargets.depthStencilBuffer,
+				cmd->setRenderTargets.depthFormat,
+				cmd->setRenderTargets.preserveTargetContents
+			);
+			break;
+		case DEFERRED_COMMAND_RESOLVETARGET:
+			device->ResolveTarget(device->driverData, &cmd->resolveTarget);
+			break;
+		case DEFERRED_COMMAND_SETTEXTUREDATA2D:
+			device->SetTextureData2D(
+				device->driverData,
+				cmd->setTextureData.texture,
+				cmd->setTextureData.x,
+				cmd->setTextureData.y,
+				cmd->setTextureData.w,
+				cmd->setTextureData.h,
+				cmd->setTextureData.level,
+				memory + cmd->setTextureData.data,
+				cmd->setTextureData.dataLength
+			);
+			break;
+		case DEFERRED_COMMAND_SETTEXTUREDATA3D:
+			device->SetTextureData3D(
+				device->driverData,
+				cmd->setTextureData.texture,
+				cmd->setTextureData.x,
+				cmd->setTextureData.y,
+				cmd->setTextureData.z,
+				cmd->setTextureData.w,
+				cmd->setTextureData.h,
+				cmd->setTextureData.d,
+				cmd->setTextureData.level,
+				memory + cmd->setTextureData.data,
+				cmd->setTextureData.dataLength
+			);
+			break;
+		case DEFERRED_COMMAND_SETTEXTUREDATACUBE:
+			device->SetTextureDataCube(
+				device->driverData,
+				cmd->setTextureData.texture,
+				cmd->setTextureData.x,
+				cmd->setTextureData.y,
+				cmd->setTextureData.w,
+				cmd->setTextureData.h,
+				cmd->setTextureData.cubeMapFace,
+				cmd->setTextureData.level,
+				memory + cmd->setTextureData.data,
+				cmd->setTextureData.dataLength
+			);
+			break;
+		case DEFERRED_COMMAND_SETTEXTUREDATAYUV:
+			device->SetTextureDataYUV(
+				device->driverData,
+				cmd->setTextureDataYUV.y,
+				cmd->setTextureDataYUV.u,
+				cmd->setTextureDataYUV.v,
+				cmd->setTextureDataYUV.yWidth,
+				cmd->setTextureDataYUV.yHeight,
+				cmd->setTextureDataYUV.uvWidth,
+				cmd->setTextureDataYUV.uvHeight,
+				memory + cmd->setTextureDataYUV.data,
+				cmd->setTextureDataYUV.dataLength
+			);
+			break;
+		case DEFERRED_COMMAND_SETVERTEXBUFFERDATA:
+			device->SetVertexBufferData(
+				device->driverData,
+				cmd->setVertexBufferData.buffer,
+				cmd->setVertexBufferData.offsetInBytes,
+				memory + cmd->setVertexBufferData.data,
+				cmd->setVertexBufferData.elementCount,
+				cmd->setVertexBufferData.elementSizeInBytes,
+				cmd->setVertexBufferData.vertexStride,
+				cmd->setVertexBufferData.options
+			);
+			break;
+		case DEFERRED_COMMAND_SETINDEXBUFFERDATA:
+			device->SetIndexBufferData(
+				device->driverData,
+				cmd->setIndexBufferData.buffer,
+				cmd->setIndexBufferData.offsetInBytes,
+				memory + cmd->setIndexBufferData.data,
+				cmd->setIndexBufferData.dataLength,
+				cmd->setIndexBufferData.options
+			);
+			break;
+		case DEFERRED_COMMAND_SETEFFECTTECHNIQUE:
+			device->SetEffectTechnique(
+				device->driverData,
+				cmd->setEffectTechnique.effect,
+				cmd->setEffectTechnique.technique
+			);
+			break;
+		case DEFERRED_COMMAND_APPLYEFFECT:
+			effectData = device->GetEffectData(
+				device->driverData,
+				cmd->applyEffect.effect
+			);
+			live = (void**) (memory + cmd->applyEffect.params);
+			params = (uint8_t*) (live + effectData->param_count);
+			SDL_LockSpinlock(&paramSwapLock);
+			for (j = 0; j < effectData->param_count; j += 1)
+			{
+				if (effectData->params[j].value.type.parameter_class == MOJOSHADER_SYMCLASS_OBJECT)
+				{
+					continue;
+				}
+				live[j] = effectData->params[j].value.values;
+				effectData->params[j].value.values = params;
+				params += effectData->params[j].value.value_count * 4;
+			}
+			device->ApplyEffect(
+				device->driverData,
+				cmd->applyEffect.effect,
+				cmd->applyEffect.pass,
+				cmd->applyEffect.stateChanges
+			);
+			for (j = 0; j < effectData->param_count; j += 1)
+			{
+				if (effectData->params[j].value.type.parameter_class != MOJOSHADER_SYMCLASS_OBJECT)
+				{
+					effectData->params[j].value.values = live[j];
+				}
+			}
+			SDL_UnlockSpinlock(&paramSwapLock);
+			break;
+		case DEFERRED_COMMAND_BEGINPASSRESTORE:
+			device->BeginPassRestore(
+				device->driverData,
+				cmd->passRestore.effect,
+				cmd->passRestore.stateChanges
+			);
+			break;
+		case DEFERRED_COMMAND_ENDPASSRESTORE:
+			device->EndPassRestore(
+				device->driverData,
+				cmd->passRestore.effect
+			);
+			break;
+		case DEFERRED_COMMAND_QUERYBEGIN:
+			device->QueryBegin(device->driverData, cmd->query);
+			break;
+		case DEFERRED_COMMAND_QUERYEND:
+			device->QueryEnd(device->driverData, cmd->query);
+			break;
+		case DEFERRED_COMMAND_SETSTRINGMARKER:
+			device->SetStringMarker(
+				device->driverData,
+				(const char*) (memory + cmd->text)
+			);
+			break;
+		case DEFERRED_COMMAND_SWAPBUFFERS:
+			device->SwapBuffers(
+				device->driverData,
+				cmd->swapBuffers.hasSourceRectangle ?
+					&cmd->swapBuffers.sourceRectangle :
+					NULL,
+				cmd->swapBuffers.hasDestinationRectangle ?
+					&cmd->swapBuffers.destinationRectangle :
+					NULL,
+				cmd->swapBuffers.overrideWindowHandle
+			);
+			break;
+		case DEFERRED_COMMAND_RESETBACKBUFFER:
+			device->ResetBackbuffer(
+				device->driverData,
+				cmd->presentationParameters
+			);
+			break;
+		case DEFERRED_COMMAND_READBACKBUFFER:
+			device->ReadBackbuffer(
+				device->driverData,
+				cmd->readBackbuffer.x,
+				cmd->readBackbuffer.y,
+				cmd->readBackbuffer.w,
+				cmd->readBackbuffer.h,
+				cmd->readBackbuffer.data,
+				cmd->readBackbuffer.dataLength
+			);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSETEXTURE:
+			device->AddDisposeTexture(device->driverData, cmd->texture);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSERENDERBUFFER:
+			device->AddDisposeRenderbuffer(
+				device->driverData,
+				cmd->renderbuffer
+			);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSEVERTEXBUFFER:
+			device->AddDisposeVertexBuffer(device->driverData, cmd->buffer);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSEINDEXBUFFER:
+			device->AddDisposeIndexBuffer(device->driverData, cmd->buffer);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSEEFFECT:
+			device->AddDisposeEffect(device->driverData, cmd->effect);
+			break;
+		case DEFERRED_COMMAND_ADDDISPOSEQUERY:
+			device->AddDisposeQuery(device->driverData, cmd->query);
+			break;
+		case DEFERRED_COMMAND_CREATEQUERY:
+			*cmd->createQuery = device->CreateQuery(device->driverData);
+			break;
+		case DEFERRED_COMMAND_QUERYCOMPLETE:
+			*cmd->queryResult.complete = device->QueryComplete(
+				device->driverData,
+				cmd->queryResult.query
+			);
+			break;
+		case DEFERRED_COMMAND_QUERYPIXELCOUNT:
+			*cmd->queryResult.pixelCount = device->QueryPixelCount(
+				device->driverData,
+				cmd->queryResult.query
+			);
+			break;
+		case DEFERRED_COMMAND_SETBACKBUFFERCAPTURE:
+			device->SetBackbufferCapture(
+				device->driverData,
+				cmd->setBackbufferCapture.frameCount,
+				cmd->setBackbufferCapture.callback,
+				cmd->setBackbufferCapture.userdata
+			);
+			break;
+		default:
+			FNA3D_LogError("Unrecognized deferred command!");
+			break;
+		}
+	}
+
+}
+
+/* Public API */
+
+FNA3D_Device* FNA3D_CreateDeferredContextEXT(FNA3D_Device *device)
+{
+	FNA3D_Device *result;
+	DeferredContext *context;
+
+	if (device == NULL)
+	{
+		return NULL;
+	}
+
+	context = (DeferredContext*) SDL_malloc(sizeof(DeferredContext));
+	SDL_zerop(context);
+	context->parent = device;
+	context->effectsLock = SDL_CreateMutex();
+	device->GetBlendFactor(device->driverData, &context->blendFactor);
+	context->multiSampleMask = device->GetMultiSampleMask(device->driverData);
+	context->referenceStencil = device->GetReferenceStencil(device->driverData);
+
+	result = (FNA3D_Device*) SDL_malloc(sizeof(FNA3D_Device));
+	ASSIGN_DRIVER(DEFERRED)
+	result->driverData = (FNA3D_Renderer*) context;
+	return result;
+}
+
+void FNA3D_ExecuteDeferredContextEXT(
+	FNA3D_Device *device,
+	FNA3D_Device *context
+) {
+	DeferredContext *ctx;
+
+	if (device == NULL || context == NULL)
+	{
+		return;
+	}
+	ctx = (DeferredContext*) context->driverData;
+	if (	context->DestroyDevice != DEFERRED_DestroyDevice ||
+		ctx->parent != device ||
+		ctx->ring != NULL	)
+	{
+		FNA3D_LogError("Context is not a deferred context of this device!");
+		return;
+	}
+
+	DEFERRED_INTERNAL_Execute(
+		device,
+		ctx->commands,
+		ctx->commandCount,
+		ctx->memory
+	);
+	ctx->commandCount = 0;
+	ctx->memorySize = 0;
+
+	/* Effects can be disposed through the parent from here on, and their
+	 * pointers reused, so start over with the next list.
+	 */
+	SDL_LockMutex(ctx->effectsLock);
+	DEFERRED_INTERNAL_ForgetEffects(ctx);
+	SDL_UnlockMutex(ctx->effectsLock);
+}
+
+/* Render Threads */
+
+FNA3D_Device* FNA3D_INTERNAL_CreateThreadedContext(
+	FNA3D_Device *device,
+	void (*wake)(FNA3D_Renderer *driverData)
+) {
+	FNA3D_Device *result = FNA3D_CreateDeferredContextEXT(device);
+	DeferredContext *context = (DeferredContext*) result->driverData;
+
+	context->ring = (DeferredCommandList*) SDL_calloc(
+		DEFERRED_RING_SIZE,
+		sizeof(DeferredCommandList)
+	);
+	SDL_SetAtomicInt(&context->ringHead, 0);
+	SDL_SetAtomicInt(&context->ringTail, 0);
+	context->ringConsumed = SDL_CreateSemaphore(0);
+	context->threadID = SDL_GetCurrentThreadID();
+	context->wake = wake;
+	return result;
+}
+
+void FNA3D_INTERNAL_ExecuteThreadedContext(FNA3D_Device *context)
+{
+	DeferredContext *ctx = (DeferredContext*) context->driverData;
+	DeferredCommandList *list;
+	int32_t tail = SDL_GetAtomicInt(&ctx->ringTail);
+
+	while (tail != SDL_GetAtomicInt(&ctx->ringHead))
+	{
+		list = &ctx->ring[tail % DEFERRED_RING_SIZE];
+		DEFERRED_INTERNAL_Execute(
+			ctx->parent,
+			list->commands,
+			list->commandCount,
+			list->memory
+		);
+		list->commandCount = 0;
+		list->memorySize = 0;
+
+		tail += 1;
+		SDL_SetAtomicInt(&ctx->ringTail, tail);
+		SDL_SignalSemaphore(ctx->ringConsumed);
+	}
+}
+
+/* vim: set noexpandtab shiftwidth=8 tabstop=8: */
@@ -686,6 +686,10 @@ struct FNA3D_Device
 		FNA3D_Renderer *driverData,
 		FNA3D_Effect *effect
 	);
+	MOJOSHADER_effect* (*GetEffectData)(
+		FNA3D_Renderer *driverData,
+		FNA3D_Effect *effect
+	);
 
 	/* Queries */
 
@@ -724,6 +728,51 @@ struct FNA3D_Device
 	void (*SetStringMarker)(FNA3D_Renderer *driverData, const char *text);
 	void (*SetTextureName)(FNA3D_Renderer *driverData, FNA3D_Texture *texture, const char *text);
 
+	/* Pipeline Cache Statistics */
+
+	void (*GetPipelineCacheStats)(
+		FNA3D_Renderer *driverData,
+		FNA3D_PipelineCacheStatsEXT *stats
+	);
+
+	/* Asynchronous Readback */
+
+	FNA3D_ReadbackEXT* (*GetTextureDataAsync)(
+		FNA3D_Renderer *driverData,
+		FNA3D_Texture *texture,
+		int32_t x,
+		int32_t y,
+		int32_t w,
+		int32_t h,
+		int32_t level,
+		int32_t dataLength
+	);
+	FNA3D_ReadbackEXT* (*GetBufferDataAsync)(
+		FNA3D_Renderer *driverData,
+		FNA3D_Buffer *buffer,
+		int32_t offsetInBytes,
+		int32_t dataLength
+	);
+	uint8_t (*PollReadback)(
+		FNA3D_Renderer *driverData,
+		FNA3D_ReadbackEXT *readback
+	);
+	void (*WaitReadback)(
+		FNA3D_Renderer *driverData,
+		FNA3D_ReadbackEXT *readback,
+		void *data,
+		int32_t dataLength
+	);
+
+	/* Backbuffer Capture */
+
+	void (*SetBackbufferCapture)(
+		FNA3D_Renderer *driverData,
+		int32_t frameCount,
+		FNA3D_BackbufferCaptureFuncEXT callback,
+		void *userdata
+	);
+
 	/* External Interop */
 
 	void (*GetSysRenderer)(
@@ -800,6 +849,7 @@ struct FNA3D_Device
 	ASSIGN_DRIVER_FUNC(ApplyEffect, name) \
 	ASSIGN_DRIVER_FUNC(BeginPassRestore, name) \
 	ASSIGN_DRIVER_FUNC(EndPassRestore, name) \
+	ASSIGN_DRIVER_FUNC(GetEffectData, name) \
 	ASSIGN_DRIVER_FUNC(CreateQuery, name) \
 	ASSIGN_DRIVER_FUNC(AddDisposeQuery, name) \
 	ASSIGN_DRIVER_FUNC(QueryBegin, name) \
@@ -816,6 +866,12 @@ struct FNA3D_Device
 	ASSIGN_DRIVER_FUNC(GetMaxMultiSampleCount, name) \
 	ASSIGN_DRIVER_FUNC(SetStringMarker, name) \
 	ASSIGN_DRIVER_FUNC(SetTextureName, name) \
+	ASSIGN_DRIVER_FUNC(GetPipelineCacheStats, name) \
+	ASSIGN_DRIVER_FUNC(GetTextureDataAsync, name) \
+	ASSIGN_DRIVER_FUNC(GetBufferDataAsync, name) \
+	ASSIGN_DRIVER_FUNC(PollReadback, name) \
+	ASSIGN_DRIVER_FUNC(WaitReadback, name) \
+	ASSIGN_DRIVER_FUNC(SetBackbufferCapture, name) \
 	ASSIGN_DRIVER_FUNC(GetSysRenderer, name) \
 	ASSIGN_DRIVER_FUNC(CreateSysTexture, name)
 
@@ -833,6 +889,23 @@ FNA3D_SHAREDINTERNAL FNA3D_Driver D3D11Driver;
 FNA3D_SHAREDINTERNAL FNA3D_Driver OpenGLDriver;
 FNA3D_SHAREDINTERNAL FNA3D_Driver SDLGPUDriver;
 
+/* Render Threads, see FNA3D_Deferred.c
+ *
+ * A threaded context records like a deferred context, but each SwapBuffers
+ * hands the frame to the driver's render thread instead of waiting for an
+ * explicit execute. wake is called whenever there is new work, and the render
+ * thread then runs everything submitted so far with ExecuteThreadedContext.
+ * Destroying the context destroys the device too.
+ */
+
+FNA3D_SHAREDINTERNAL FNA3D_Device* FNA3D_INTERNAL_CreateThreadedContext(
+	FNA3D_Device *device,
+	void (*wake)(FNA3D_Renderer *driverData)
+);
+FNA3D_SHAREDINTERNAL void FNA3D_INTERNAL_ExecuteThreadedContext(
+	FNA3D_Device *context
+);
+
 #endif /* FNA3D_DRIVER_H */
 
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
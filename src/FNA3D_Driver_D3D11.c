@@ -174,6 +174,15 @@ typedef struct D3D11Query /* Cast FNA3D_Query* to this! */
 	ID3D11Query *handle;
 } D3D11Query;
 
+typedef struct D3D11CaptureFrame
+{
+	ID3D11Texture2D *staging;
+	int32_t width;
+	int32_t height;
+	FNA3D_SurfaceFormat format;
+	uint8_t pending;
+} D3D11CaptureFrame;
+
 typedef struct D3D11Backbuffer
 {
 	#define BACKBUFFER_TYPE_NULL 0
@@ -287,6 +296,16 @@ typedef struct D3D11Renderer /* Cast FNA3D_Renderer* to this! */
 	PackedStateArray rasterizerStateCache;
 	PackedStateArray samplerStateCache;
 	PackedVertexBufferBindingsArray inputLayoutCache;
+	FNA3D_PipelineCacheCountersEXT cacheStats[FNA3D_PIPELINECACHE_TYPE_COUNT_EXT];
+
+	/* Backbuffer Capture */
+	FNA3D_BackbufferCaptureFuncEXT captureCallback;
+	void *captureUserdata;
+	int32_t captureFrameCount;
+	int32_t captureIndex;
+	D3D11CaptureFrame captureFrames[FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT];
+	uint8_t *captureData;
+	int32_t captureDataLength;
 
 	/* Render Targets */
 	int32_t numRenderTargets;
@@ -587,6 +606,10 @@ static ID3D11BlendState* D3D11_INTERNAL_FetchBlendState(
 	D3D11_BLEND_DESC desc = {0};
 	ID3D11BlendState *result;
 	HRESULT res;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_BLENDSTATE_EXT
+	];
+	uint64_t createStart;
 
 	/* Can we just reuse an existing state? */
 	packedState = GetPackedBlendState(*state);
@@ -597,9 +620,13 @@ static ID3D11BlendState* D3D11_INTERNAL_FetchBlendState(
 	if (result != NULL)
 	{
 		/* The state is already cached! */
+		stats->hits += 1;
 		return result;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	/* We need to make a new blend state... */
 	desc.AlphaToCoverageEnable = 0;
 	desc.IndependentBlendEnable = 0;
@@ -657,6 +684,7 @@ static ID3D11BlendState* D3D11_INTERNAL_FetchBlendState(
 		&result
 	);
 	ERROR_CHECK_RETURN("Blend state creation failed", NULL)
+	PipelineCacheStats_EndCreate(stats, createStart);
 	PackedStateArray_Insert(
 		&renderer->blendStateCache,
 		packedState,
@@ -676,6 +704,10 @@ static ID3D11DepthStencilState* D3D11_INTERNAL_FetchDepthStencilState(
 	D3D11_DEPTH_STENCILOP_DESC front, back;
 	ID3D11DepthStencilState *result;
 	HRESULT res;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_DEPTHSTENCILSTATE_EXT
+	];
+	uint64_t createStart;
 
 	/* Can we just reuse an existing state? */
 	packedState = GetPackedDepthStencilState(*state);
@@ -686,9 +718,13 @@ static ID3D11DepthStencilState* D3D11_INTERNAL_FetchDepthStencilState(
 	if (result != NULL)
 	{
 		/* The state is already cached! */
+		stats->hits += 1;
 		return result;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	/* We have to make a new depth stencil state... */
 	desc.DepthEnable = state->depthBufferEnable;
 	desc.DepthWriteMask = (
@@ -743,6 +779,7 @@ static ID3D11DepthStencilState* D3D11_INTERNAL_FetchDepthStencilState(
 		&result
 	);
 	ERROR_CHECK_RETURN("Depth-stencil state creation failed", NULL)
+	PipelineCacheStats_EndCreate(stats, createStart);
 	PackedStateArray_Insert(
 		&renderer->depthStencilStateCache,
 		packedState,
@@ -762,6 +799,10 @@ static ID3D11RasterizerState* D3D11_INTERNAL_FetchRasterizerState(
 	D3D11_RASTERIZER_DESC desc;
 	ID3D11RasterizerState *result;
 	HRESULT res;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_RASTERIZERSTATE_EXT
+	];
+	uint64_t createStart;
 
 	depthBias = state->depthBias * XNAToD3D_DepthBiasScale[
 		renderer->currentDepthFormat
@@ -776,9 +817,13 @@ static ID3D11RasterizerState* D3D11_INTERNAL_FetchRasterizerState(
 	if (result != NULL)
 	{
 		/* The state is already cached! */
+		stats->hits += 1;
 		return result;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	/* We have to make a new rasterizer state... */
 	desc.AntialiasedLineEnable = 0;
 	desc.CullMode = XNAToD3D_CullMode[state->cullMode];
@@ -798,6 +843,7 @@ static ID3D11RasterizerState* D3D11_INTERNAL_FetchRasterizerState(
 		&result
 	);
 	ERROR_CHECK_RETURN("Rasterizer state creation failed", NULL)
+	PipelineCacheStats_EndCreate(stats, createStart);
 	PackedStateArray_Insert(
 		&renderer->rasterizerStateCache,
 		packedState,
@@ -816,6 +862,10 @@ static ID3D11SamplerState* D3D11_INTERNAL_FetchSamplerState(
 	D3D11_SAMPLER_DESC desc;
 	ID3D11SamplerState *result;
 	HRESULT res;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT
+	];
+	uint64_t createStart;
 
 	/* Can we just reuse an existing state? */
 	packedState = GetPackedSamplerState(*state);
@@ -826,9 +876,13 @@ static ID3D11SamplerState* D3D11_INTERNAL_FetchSamplerState(
 	if (result != NULL)
 	{
 		/* The state is already cached! */
+		stats->hits += 1;
 		return result;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	/* We have to make a new sampler state... */
 	desc.AddressU = XNAToD3D_Wrap[state->addressU];
 	desc.AddressV = XNAToD3D_Wrap[state->addressV];
@@ -851,6 +905,7 @@ static ID3D11SamplerState* D3D11_INTERNAL_FetchSamplerState(
 		&result
 	);
 	ERROR_CHECK_RETURN("Sampler state creation failed", NULL)
+	PipelineCacheStats_EndCreate(stats, createStart);
 	PackedStateArray_Insert(
 		&renderer->samplerStateCache,
 		packedState,
@@ -876,6 +931,10 @@ static ID3D11InputLayout* D3D11_INTERNAL_FetchBindingsInputLayout(
 	void *bytecode;
 	int32_t bytecodeLength;
 	HRESULT res;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT
+	];
+	uint64_t createStart;
 	ID3D11InputLayout *result;
 
 	/* We need the vertex shader... */
@@ -893,9 +952,13 @@ static ID3D11InputLayout* D3D11_INTERNAL_FetchBindingsInputLayout(
 	if (result != NULL)
 	{
 		/* This input layout has already been cached! */
+		stats->hits += 1;
 		return result;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	/* We have to make a new input layout... */
 
 	/* There's this weird case where you can have overlapping
@@ -996,6 +1059,7 @@ static ID3D11InputLayout* D3D11_INTERNAL_FetchBindingsInputLayout(
 
 	/* Check for errors now that elements is freed */
 	ERROR_CHECK_RETURN("Could not compile input layout", NULL)
+	PipelineCacheStats_EndCreate(stats, createStart);
 
 	/* Return the new input layout! */
 	PackedVertexBufferBindingsArray_Insert(
@@ -1042,6 +1106,15 @@ static void D3D11_GetTextureData2D(
 	void* data,
 	int32_t dataLength
 );
+static void D3D11_ReadBackbuffer(
+	FNA3D_Renderer *driverData,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	void* data,
+	int32_t dataLength
+);
 
 /* Renderer Implementation */
 
@@ -1066,6 +1139,12 @@ static void D3D11_DestroyDevice(FNA3D_Device *device)
 	ID3D11VertexShader_Release(renderer->fauxBackbufferResources.vertexShader);
 	ID3D11Buffer_Release(renderer->fauxBackbufferResources.vertexBuffer);
 
+	/* Hand off whatever is still in flight */
+	if (renderer->captureCallback != NULL)
+	{
+		D3D11_INTERNAL_FlushCaptureFrames(renderer);
+	}
+
 	/* Release faux backbuffer */
 	D3D11_INTERNAL_DisposeBackbuffer(renderer);
 	SDL_free(renderer->backbuffer);
@@ -1475,6 +1554,215 @@ static void D3D11_INTERNAL_BlitFauxBackbuffer(
 	SDL_UnlockMutex(renderer->ctxLock);
 }
 
+/* Backbuffer Capture */
+
+static void D3D11_INTERNAL_DeliverCaptureFrame(
+	D3D11Renderer *renderer,
+	D3D11CaptureFrame *frame
+) {
+	D3D11_MAPPED_SUBRESOURCE subres;
+	int32_t pitch, row, dataLength;
+	HRESULT res;
+
+	if (!frame->pending)
+	{
+		return;
+	}
+	frame->pending = 0;
+
+	pitch = frame->width * Texture_GetFormatSize(frame->format);
+	dataLength = pitch * frame->height;
+
+	if (renderer->captureDataLength < dataLength)
+	{
+		SDL_free(renderer->captureData);
+		renderer->captureData = (uint8_t*) SDL_malloc(dataLength);
+		renderer->captureDataLength = dataLength;
+	}
+
+	/* The copy was queued frames ago, so this should not have to wait */
+	SDL_LockMutex(renderer->ctxLock);
+	res = ID3D11DeviceContext_Map(
+		renderer->context,
+		(ID3D11Resource*) frame->staging,
+		0,
+		D3D11_MAP_READ,
+		0,
+		&subres
+	);
+	if (FAILED(res))
+	{
+		SDL_UnlockMutex(renderer->ctxLock);
+		D3D11_INTERNAL_LogError(
+			renderer->device,
+			"Could not map capture frame for reading",
+			res
+		);
+		return;
+	}
+	for (row = 0; row < frame->height; row += 1)
+	{
+		SDL_memcpy(
+			renderer->captureData + (row * pitch),
+			(uint8_t*) subres.pData + (row * subres.RowPitch),
+			pitch
+		);
+	}
+	ID3D11DeviceContext_Unmap(
+		renderer->context,
+		(ID3D11Resource*) frame->staging,
+		0
+	);
+	SDL_UnlockMutex(renderer->ctxLock);
+
+	renderer->captureCallback(
+		renderer->captureData,
+		frame->width,
+		frame->height,
+		dataLength,
+		renderer->captureUserdata
+	);
+}
+
+static void D3D11_INTERNAL_FlushCaptureFrames(D3D11Renderer *renderer)
+{
+	D3D11CaptureFrame *frame;
+	int32_t i;
+
+	/* Oldest first, which is the next slot to be reused */
+	for (i = 0; i < renderer->captureFrameCount; i += 1)
+	{
+		frame = &renderer->captureFrames[
+			(renderer->captureIndex + i) % renderer->captureFrameCount
+		];
+		D3D11_INTERNAL_DeliverCaptureFrame(renderer, frame);
+		if (frame->staging != NULL)
+		{
+			ID3D11Texture2D_Release(frame->staging);
+			frame->staging = NULL;
+		}
+	}
+	renderer->captureIndex = 0;
+
+	SDL_free(renderer->captureData);
+	renderer->captureData = NULL;
+	renderer->captureDataLength = 0;
+}
+
+static void D3D11_INTERNAL_CaptureBackbuffer(D3D11Renderer *renderer)
+{
+	D3D11CaptureFrame *frame = &renderer->captureFrames[renderer->captureIndex];
+	D3D11_TEXTURE2D_DESC stagingDesc;
+	ID3D11Texture2D *swapchainBuffer = NULL;
+	ID3D11Resource *source;
+	FNA3D_SurfaceFormat format;
+	HRESULT res;
+
+	/* Make room by handing off the oldest frame */
+	D3D11_INTERNAL_DeliverCaptureFrame(renderer, frame);
+
+	format = (renderer->backbuffer->type == BACKBUFFER_TYPE_D3D11) ?
+		renderer->backbuffer->d3d11.surfaceFormat :
+		renderer->swapchainDatas[0]->format;
+
+	/* Backbuffer resets change the size, so reallocate to match */
+	if (	frame->staging != NULL &&
+		(	frame->width != renderer->backbuffer->width ||
+			frame->height != renderer->backbuffer->height ||
+			frame->format != format	)	)
+	{
+		ID3D11Texture2D_Release(frame->staging);
+		frame->staging = NULL;
+	}
+	frame->width = renderer->backbuffer->width;
+	frame->height = renderer->backbuffer->height;
+	frame->format = format;
+
+	if (frame->staging == NULL)
+	{
+		stagingDesc.Width = frame->width;
+		stagingDesc.Height = frame->height;
+		stagingDesc.MipLevels = 1;
+		stagingDesc.ArraySize = 1;
+		stagingDesc.Format = XNAToD3D_TextureFormat[format];
+		stagingDesc.SampleDesc.Count = 1;
+		stagingDesc.SampleDesc.Quality = 0;
+		stagingDesc.Usage = D3D11_USAGE_STAGING;
+		stagingDesc.BindFlags = 0;
+		stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		stagingDesc.MiscFlags = 0;
+		res = ID3D11Device_CreateTexture2D(
+			renderer->device,
+			&stagingDesc,
+			NULL,
+			&frame->staging
+		);
+		if (FAILED(res))
+		{
+			D3D11_INTERNAL_LogError(
+				renderer->device,
+				"Capture staging texture creation failed",
+				res
+			);
+			frame->staging = NULL;
+			return;
+		}
+	}
+
+	if (renderer->backbuffer->type == BACKBUFFER_TYPE_D3D11)
+	{
+		source = (
+			renderer->backbuffer->multiSampleCount > 1 ?
+				(ID3D11Resource*) renderer->backbuffer->d3d11.resolveBuffer :
+				(ID3D11Resource*) renderer->backbuffer->d3d11.colorBuffer
+		);
+	}
+	else
+	{
+		/* This is only possible with a single window/swapchain, 0 should be safe */
+		res = IDXGISwapChain_GetBuffer(
+			renderer->swapchainDatas[0]->swapchain,
+			0,
+			&D3D_IID_ID3D11Texture2D,
+			(void**) &swapchainBuffer
+		);
+		ERROR_CHECK_RETURN("Could not get buffer from swapchain", )
+		source = (ID3D11Resource*) swapchainBuffer;
+	}
+
+	/* Only the copy is queued here, the map happens frameCount presents later */
+	SDL_LockMutex(renderer->ctxLock);
+	if (	renderer->backbuffer->type == BACKBUFFER_TYPE_D3D11 &&
+		renderer->backbuffer->multiSampleCount > 1	)
+	{
+		ID3D11DeviceContext_ResolveSubresource(
+			renderer->context,
+			source,
+			0,
+			(ID3D11Resource*) renderer->backbuffer->d3d11.colorBuffer,
+			0,
+			XNAToD3D_TextureFormat[format]
+		);
+	}
+	ID3D11DeviceContext_CopyResource(
+		renderer->context,
+		(ID3D11Resource*) frame->staging,
+		source
+	);
+	SDL_UnlockMutex(renderer->ctxLock);
+
+	if (swapchainBuffer != NULL)
+	{
+		/* Cleanup is required for any GetBuffer call! */
+		ID3D11Texture2D_Release(swapchainBuffer);
+	}
+
+	frame->pending = 1;
+	renderer->captureIndex = (
+		(renderer->captureIndex + 1) % renderer->captureFrameCount
+	);
+}
+
 static void D3D11_SwapBuffers(
 	FNA3D_Renderer *driverData,
 	FNA3D_Rect *sourceRectangle,
@@ -1487,6 +1775,11 @@ static void D3D11_SwapBuffers(
 	D3D11SwapchainData *swapchainData;
 	uint32_t presentFlags;
 
+	if (renderer->captureCallback != NULL)
+	{
+		D3D11_INTERNAL_CaptureBackbuffer(renderer);
+	}
+
 	/* Only the faux-backbuffer supports presenting
 	 * specific regions given to Present().
 	 * -flibit
@@ -4882,6 +5175,13 @@ static void D3D11_EndPassRestore(
 	SDL_UnlockMutex(renderer->ctxLock);
 }
 
+static MOJOSHADER_effect* D3D11_GetEffectData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	return ((D3D11Effect*) effect)->effect;
+}
+
 /* Queries */
 
 static FNA3D_Query* D3D11_CreateQuery(FNA3D_Renderer *driverData)
@@ -5148,6 +5448,337 @@ static void D3D11_SetTextureName(FNA3D_Renderer* driverData, FNA3D_Texture* text
 	ID3D11DeviceChild_SetPrivateData(d3dTexture->handle, &GUID_D3DDebugObjectName, SDL_strlen(text), text);
 }
 
+/* Pipeline Cache Statistics */
+
+static void D3D11_GetPipelineCacheStats(
+	FNA3D_Renderer *driverData,
+	FNA3D_PipelineCacheStatsEXT *stats
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_BLENDSTATE_EXT],
+		renderer->blendStateCache.count,
+		renderer->blendStateCache.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_DEPTHSTENCILSTATE_EXT],
+		renderer->depthStencilStateCache.count,
+		renderer->depthStencilStateCache.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_RASTERIZERSTATE_EXT],
+		renderer->rasterizerStateCache.count,
+		renderer->rasterizerStateCache.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT],
+		renderer->samplerStateCache.count,
+		renderer->samplerStateCache.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT],
+		renderer->inputLayoutCache.count,
+		renderer->inputLayoutCache.capacity
+	);
+
+	/* D3D11 has no monolithic pipeline objects */
+	SDL_memcpy(
+		stats->caches,
+		renderer->cacheStats,
+		sizeof(renderer->cacheStats)
+	);
+}
+
+/* Backbuffer Capture */
+
+static void D3D11_SetBackbufferCapture(
+	FNA3D_Renderer *driverData,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+
+	/* The ring layout depends on the frame count, so start over */
+	if (renderer->captureCallback != NULL)
+	{
+		D3D11_INTERNAL_FlushCaptureFrames(renderer);
+	}
+
+	renderer->captureCallback = callback;
+	renderer->captureUserdata = userdata;
+	renderer->captureFrameCount = frameCount;
+}
+
+/* Asynchronous Readback */
+
+typedef struct D3D11Readback /* Cast from FNA3D_ReadbackEXT* */
+{
+	ID3D11Resource *staging; /* NULL once data holds the result */
+	uint8_t *data;
+	int32_t dataLength;
+	int32_t rowLength;
+	int32_t rowCount;
+	uint8_t flushed;
+} D3D11Readback;
+
+/* Copies the staging resource out once the GPU is done with it, without
+ * waiting unless mapFlags says to. Returns 1 once data holds the result.
+ * Assumes ctxLock is held.
+ */
+static uint8_t D3D11_INTERNAL_ResolveReadback(
+	D3D11Renderer *renderer,
+	D3D11Readback *readback,
+	UINT mapFlags
+) {
+	D3D11_MAPPED_SUBRESOURCE subres;
+	uint8_t *dataPtr;
+	int32_t row, length;
+	HRESULT res;
+
+	if (readback->staging == NULL)
+	{
+		return 1;
+	}
+
+	res = ID3D11DeviceContext_Map(
+		renderer->context,
+		readback->staging,
+		0,
+		D3D11_MAP_READ,
+		mapFlags,
+		&subres
+	);
+	if (res == DXGI_ERROR_WAS_STILL_DRAWING)
+	{
+		if (!readback->flushed)
+		{
+			/* Or a poll loop might wait on work that never starts */
+			ID3D11DeviceContext_Flush(renderer->context);
+			readback->flushed = 1;
+		}
+		return 0;
+	}
+
+	if (SUCCEEDED(res))
+	{
+		dataPtr = readback->data;
+		length = readback->dataLength;
+		for (row = 0; row < readback->rowCount && length > 0; row += 1)
+		{
+			SDL_memcpy(
+				dataPtr,
+				(uint8_t*) subres.pData + (row * subres.RowPitch),
+				SDL_min(readback->rowLength, length)
+			);
+			dataPtr += readback->rowLength;
+			length -= readback->rowLength;
+		}
+		ID3D11DeviceContext_Unmap(renderer->context, readback->staging, 0);
+	}
+	else
+	{
+		D3D11_INTERNAL_LogError(
+			renderer->device,
+			"Could not map readback for reading",
+			res
+		);
+	}
+
+	ID3D11Resource_Release(readback->staging);
+	readback->staging = NULL;
+	return 1;
+}
+
+static FNA3D_ReadbackEXT* D3D11_GetTextureDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+	D3D11Texture *tex = (D3D11Texture*) texture;
+	D3D11_TEXTURE2D_DESC stagingDesc;
+	D3D11_BOX srcBox = {x, y, 0, x + w, y + h, 1};
+	D3D11Readback *readback;
+	HRESULT res;
+
+	readback = (D3D11Readback*) SDL_malloc(sizeof(D3D11Readback));
+	readback->staging = NULL;
+	readback->data = (uint8_t*) SDL_malloc(dataLength);
+	readback->dataLength = dataLength;
+	readback->rowLength = w * Texture_GetFormatSize(tex->format);
+	readback->rowCount = h;
+	readback->flushed = 0;
+
+	if (Texture_GetBlockSize(tex->format) != 1)
+	{
+		/* This logs the error for us */
+		D3D11_GetTextureData2D(
+			driverData,
+			texture,
+			x,
+			y,
+			w,
+			h,
+			level,
+			readback->data,
+			dataLength
+		);
+		return (FNA3D_ReadbackEXT*) readback;
+	}
+
+	/* Only the region is copied, the map happens when it's asked for */
+	stagingDesc.Width = w;
+	stagingDesc.Height = h;
+	stagingDesc.MipLevels = 1;
+	stagingDesc.ArraySize = 1;
+	stagingDesc.Format = XNAToD3D_TextureFormat[tex->format];
+	stagingDesc.SampleDesc.Count = 1;
+	stagingDesc.SampleDesc.Quality = 0;
+	stagingDesc.Usage = D3D11_USAGE_STAGING;
+	stagingDesc.BindFlags = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.MiscFlags = 0;
+	res = ID3D11Device_CreateTexture2D(
+		renderer->device,
+		&stagingDesc,
+		NULL,
+		(ID3D11Texture2D**) &readback->staging
+	);
+	if (FAILED(res))
+	{
+		D3D11_INTERNAL_LogError(
+			renderer->device,
+			"Readback staging texture creation failed",
+			res
+		);
+		readback->staging = NULL;
+		return (FNA3D_ReadbackEXT*) readback;
+	}
+
+	SDL_LockMutex(renderer->ctxLock);
+	ID3D11DeviceContext_CopySubresourceRegion(
+		renderer->context,
+		readback->staging,
+		0,
+		0,
+		0,
+		0,
+		tex->handle,
+		D3D11_INTERNAL_CalcSubresource(level, 0, tex->levelCount),
+		&srcBox
+	);
+	SDL_UnlockMutex(renderer->ctxLock);
+
+	return (FNA3D_ReadbackEXT*) readback;
+}
+
+static FNA3D_ReadbackEXT* D3D11_GetBufferDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+	D3D11Buffer *d3dBuffer = (D3D11Buffer*) buffer;
+	D3D11_BUFFER_DESC desc;
+	D3D11_BOX srcBox = {offsetInBytes, 0, 0, offsetInBytes + dataLength, 1, 1};
+	D3D11Readback *readback;
+	HRESULT res;
+
+	readback = (D3D11Readback*) SDL_malloc(sizeof(D3D11Readback));
+	readback->staging = NULL;
+	readback->data = (uint8_t*) SDL_malloc(dataLength);
+	readback->dataLength = dataLength;
+	readback->rowLength = dataLength;
+	readback->rowCount = 1;
+	readback->flushed = 0;
+
+	desc.ByteWidth = dataLength;
+	desc.Usage = D3D11_USAGE_STAGING;
+	desc.BindFlags = 0;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	desc.MiscFlags = 0;
+	desc.StructureByteStride = 0;
+	res = ID3D11Device_CreateBuffer(
+		renderer->device,
+		&desc,
+		NULL,
+		(ID3D11Buffer**) &readback->staging
+	);
+	if (FAILED(res))
+	{
+		D3D11_INTERNAL_LogError(
+			renderer->device,
+			"Readback staging buffer creation failed",
+			res
+		);
+		readback->staging = NULL;
+		return (FNA3D_ReadbackEXT*) readback;
+	}
+
+	SDL_LockMutex(renderer->ctxLock);
+	ID3D11DeviceContext_CopySubresourceRegion(
+		renderer->context,
+		readback->staging,
+		0,
+		0,
+		0,
+		0,
+		(ID3D11Resource*) d3dBuffer->handle,
+		0,
+		&srcBox
+	);
+	SDL_UnlockMutex(renderer->ctxLock);
+
+	return (FNA3D_ReadbackEXT*) readback;
+}
+
+static uint8_t D3D11_PollReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+	uint8_t result;
+
+	SDL_LockMutex(renderer->ctxLock);
+	result = D3D11_INTERNAL_ResolveReadback(
+		renderer,
+		(D3D11Readback*) readback,
+		D3D11_MAP_FLAG_DO_NOT_WAIT
+	);
+	SDL_UnlockMutex(renderer->ctxLock);
+	return result;
+}
+
+static void D3D11_WaitReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
+) {
+	D3D11Renderer *renderer = (D3D11Renderer*) driverData;
+	D3D11Readback *r = (D3D11Readback*) readback;
+
+	/* If the copy isn't done yet, this is where we stall */
+	SDL_LockMutex(renderer->ctxLock);
+	D3D11_INTERNAL_ResolveReadback(renderer, r, 0);
+	SDL_UnlockMutex(renderer->ctxLock);
+
+	if (data != NULL)
+	{
+		SDL_memcpy(data, r->data, SDL_min(dataLength, r->dataLength));
+	}
+	SDL_free(r->data);
+	SDL_free(r);
+}
+
 /* External Interop */
 
 static void D3D11_GetSysRenderer(
@@ -27,12 +27,14 @@
 #if FNA3D_DRIVER_OPENGL
 
 #include "FNA3D_Driver.h"
+#include "FNA3D_PipelineCache.h"
 #include "FNA3D_Driver_OpenGL.h"
 
 #ifdef USE_SDL3
 #include <SDL3/SDL.h>
 #else
 #include <SDL.h>
+#include <stdio.h> /* rename, remove */
 static inline SDL_threadID SDL_GetCurrentThreadID()
 {
 	return SDL_ThreadID();
@@ -42,6 +44,21 @@ static inline SDL_threadID SDL_GetCurrentThreadID()
 #define SDL_Semaphore SDL_sem
 #define SDL_SignalSemaphore SDL_SemPost
 #define SDL_WaitSemaphore SDL_SemWait
+#define SDL_AtomicInt SDL_atomic_t
+#define SDL_GetAtomicInt SDL_AtomicGet
+#define SDL_SetAtomicInt SDL_AtomicSet
+#define SDL_AddAtomicInt SDL_AtomicAdd
+#define SDL_SetAtomicPointer SDL_AtomicSetPtr
+#define SDL_GetAtomicPointer SDL_AtomicGetPtr
+#define SDL_CompareAndSwapAtomicPointer SDL_AtomicCASPtr
+#define SDL_LockSpinlock SDL_AtomicLock
+#define SDL_UnlockSpinlock SDL_AtomicUnlock
+#define SDL_IOStream SDL_RWops
+#define SDL_IOFromFile SDL_RWFromFile
+#define SDL_WriteIO(a, b, c) SDL_RWwrite(a, b, c, 1)
+#define SDL_CloseIO SDL_RWclose
+#define SDL_RenamePath(a, b) (rename(a, b) == 0)
+#define SDL_RemovePath(a) (remove(a) == 0)
 #endif
 
 /* We only use this to detect UIKit, for backbuffer creation */
@@ -51,6 +68,12 @@ static inline SDL_threadID SDL_GetCurrentThreadID()
 
 /* Internal Structures */
 
+#define MAX_FRAMES_IN_FLIGHT 3
+#define UPLOAD_SEGMENTS 4
+#define BUFFER_REGIONS 3
+#define MAX_REGION_BUFFER_SIZE (4 * 1024 * 1024)
+#define MAX_POOLED_SEMAPHORES 16
+
 typedef struct FNA3D_Command FNA3D_Command; /* See Threading Support section */
 
 typedef struct OpenGLTexture OpenGLTexture;
@@ -64,6 +87,7 @@ struct OpenGLTexture /* Cast from FNA3D_Texture* */
 	uint32_t handle;
 	GLenum target;
 	uint8_t hasMipmaps;
+	/* Sampler objects override these, if available */
 	FNA3D_TextureAddressMode wrapS;
 	FNA3D_TextureAddressMode wrapT;
 	FNA3D_TextureAddressMode wrapR;
@@ -86,6 +110,8 @@ struct OpenGLTexture /* Cast from FNA3D_Texture* */
 	};
 	OpenGLTexture *next; /* linked list */
 	uint8_t external;
+	/* Bumped after a worker context changes the contents */
+	SDL_AtomicInt generation;
 };
 
 static OpenGLTexture NullTexture =
@@ -112,6 +138,10 @@ struct OpenGLBuffer /* Cast from FNA3D_Buffer* */
 	GLuint handle;
 	intptr_t size;
 	GLenum dynamic;
+	uint8_t *mapping; /* Persistent dynamic buffers only */
+	int32_t region;
+	GLsync regionFences[BUFFER_REGIONS];
+	uint8_t regionBusy; /* Entered before its fence signaled */
 	OpenGLBuffer *next; /* linked list */
 };
 
@@ -155,6 +185,23 @@ typedef struct OpenGLBackbuffer
 	} opengl;
 } OpenGLBackbuffer;
 
+typedef struct OpenGLCaptureFrame
+{
+	GLuint pbo;
+	int32_t bufferSize;
+	int32_t width;
+	int32_t height;
+	uint8_t pending;
+} OpenGLCaptureFrame;
+
+typedef struct OpenGLWorker
+{
+	/* A copy of the renderer with its own shared context and binding cache */
+	struct OpenGLRenderer *renderer;
+	uint8_t claimed;
+	uint8_t failed;
+} OpenGLWorker;
+
 typedef struct OpenGLVertexAttribute
 {
 	uint32_t currentBuffer;
@@ -164,6 +211,18 @@ typedef struct OpenGLVertexAttribute
 	uint32_t currentStride;
 } OpenGLVertexAttribute;
 
+typedef struct OpenGLVertexArray OpenGLVertexArray;
+
+struct OpenGLVertexArray
+{
+	GLuint handle;
+	MOJOSHADER_glShader *pixelShader;
+	GLuint buffers[MAX_BOUND_VERTEX_BUFFERS];
+	intptr_t offsets[MAX_BOUND_VERTEX_BUFFERS];
+	int32_t strides[MAX_BOUND_VERTEX_BUFFERS];
+	OpenGLVertexArray *next; /* Same layout and vertex shader */
+};
+
 typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 {
 	/* Associated FNA3D_Device */
@@ -188,6 +247,43 @@ typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 	/* VAO for Core Profile */
 	GLuint vao;
 
+	/* With ARB_vertex_attrib_binding, Core gets one VAO per vertex layout
+	 * and shader pair instead. The cache is keyed on the vertex shader,
+	 * each value is a list of VAOs for the pixel shaders it was linked to.
+	 */
+	uint8_t useVertexArrayCache;
+	PackedVertexBufferBindingsArray vertexArrayCache;
+	OpenGLVertexArray *currentVertexArray; /* NULL if vao is bound */
+
+	/* Pipeline Cache Statistics */
+	FNA3D_PipelineCacheCountersEXT cacheStats[FNA3D_PIPELINECACHE_TYPE_COUNT_EXT];
+
+	/* Backbuffer capture, frames are delivered captureFrameCount swaps late */
+	FNA3D_BackbufferCaptureFuncEXT captureCallback;
+	void *captureUserdata;
+	int32_t captureFrameCount;
+	int32_t captureIndex;
+	OpenGLCaptureFrame captureFrames[FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT];
+	uint8_t *captureData;
+	int32_t captureDataLength;
+
+	/* Frame pacing, 0 frames in flight means the swap is all we get */
+	int32_t framesInFlight;
+	int32_t frameFenceIndex;
+	GLsync frameFences[MAX_FRAMES_IN_FLIGHT];
+
+	/* Texture upload ring, persistently mapped and fenced per segment */
+	GLuint uploadBuffer;
+	uint8_t *uploadMapping;
+	int32_t uploadBufferSize;
+	int32_t uploadOffset;
+	int32_t uploadSegment;
+	GLsync uploadFences[UPLOAD_SEGMENTS];
+	uint8_t uploadBound;
+
+	/* Dynamic buffers get persistently mapped regions instead of orphaning */
+	uint8_t persistentBuffers;
+
 	/* Capabilities */
 	uint8_t supports_s3tc;
 	uint8_t supports_dxt1;
@@ -250,6 +346,11 @@ typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 	int32_t numVertexTextureSlots;
 	int32_t vertexSamplerStart;
 	OpenGLTexture *textures[MAX_TEXTURE_SAMPLERS + MAX_VERTEXTEXTURE_SAMPLERS];
+	int32_t textureGenerations[MAX_TEXTURE_SAMPLERS + MAX_VERTEXTEXTURE_SAMPLERS];
+
+	/* Sampler Objects, 0 if the texture parameters are used instead */
+	GLuint samplers[MAX_TEXTURE_SAMPLERS + MAX_VERTEXTEXTURE_SAMPLERS];
+	PackedStateArray samplerStateCache;
 
 	/* Buffer Binding Cache */
 	GLuint currentVertexBuffer;
@@ -265,6 +366,10 @@ typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 	GLuint targetFramebuffer;
 	GLuint resolveFramebufferRead;
 	GLuint resolveFramebufferDraw;
+	GLuint readbackFramebuffer;
+	GLuint readbackRenderbuffer;
+	int32_t readbackWidth;
+	int32_t readbackHeight;
 	GLuint currentAttachments[MAX_RENDERTARGET_BINDINGS];
 	GLenum currentAttachmentTypes[MAX_RENDERTARGET_BINDINGS];
 	int32_t currentDrawBuffers;
@@ -296,25 +401,50 @@ typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 	uint8_t renderTargetBound;
 	uint8_t effectApplied;
 
+	/* Program Binary Cache, NULL directory if disabled */
+	char *programCacheDir;
+	uint64_t programCacheSeed;
+	struct OpenGLRenderer *programCacheNext;
+
 	/* Point Sprite Toggle */
 	uint8_t togglePointSprite;
 
 	/* Threading */
 	SDL_ThreadID threadID;
 	FNA3D_Command *commands;
-	SDL_Mutex *commandsLock;
+	SDL_SpinLock semaphorePoolLock;
+	SDL_Semaphore *semaphorePool[MAX_POOLED_SEMAPHORES];
+	int32_t semaphorePoolCount;
 	OpenGLTexture *disposeTextures;
-	SDL_Mutex *disposeTexturesLock;
 	OpenGLRenderbuffer *disposeRenderbuffers;
-	SDL_Mutex *disposeRenderbuffersLock;
 	OpenGLBuffer *disposeVertexBuffers;
-	SDL_Mutex *disposeVertexBuffersLock;
 	OpenGLBuffer *disposeIndexBuffers;
-	SDL_Mutex *disposeIndexBuffersLock;
 	OpenGLEffect *disposeEffects;
-	SDL_Mutex *disposeEffectsLock;
 	OpenGLQuery *disposeQueries;
-	SDL_Mutex *disposeQueriesLock;
+
+	/* Shared-context workers, each claimed for the length of one call */
+	SDL_Window *workerWindow;
+	OpenGLWorker *workers;
+	int32_t workerCount;
+	SDL_Mutex *workersLock;
+
+	/* Worker uploads the main context waits on, also under workersLock */
+	GLsync *workerFences;
+	int32_t workerFenceCount;
+	int32_t workerFenceCapacity;
+	SDL_AtomicInt workerFencesPending;
+
+	/* Bumped after a worker context changes a buffer's contents */
+	SDL_AtomicInt bufferGeneration;
+	int32_t bufferGenerationSeen;
+
+	/* Render thread mode, the game thread only talks to renderThreadContext */
+	SDL_Thread *renderThread;
+	SDL_Semaphore *renderThreadWake;
+	SDL_Window *renderThreadWindow;
+	FNA3D_Device *renderThreadContext;
+	SDL_Semaphore *renderThreadStarted;
+	SDL_AtomicInt renderThreadQuit;
 
 	/* GL entry points */
 	glfntype_glGetString glGetString; /* Loaded early! */
@@ -327,6 +457,12 @@ typedef struct OpenGLRenderer /* Cast from FNA3D_Renderer* */
 	#include "FNA3D_Driver_OpenGL_glfuncs.h"
 } OpenGLRenderer;
 
+/* GL passes no userdata to our glLinkProgram, so it finds its renderer by
+ * the context that's current on the calling thread.
+ */
+static OpenGLRenderer *programCacheRenderers = NULL;
+static SDL_SpinLock programCacheLock;
+
 /* XNA->OpenGL Translation Arrays */
 
 static int32_t XNAToGL_TextureFormat[] =
@@ -635,6 +771,10 @@ struct FNA3D_Command
 	#define FNA3D_COMMAND_GETTEXTUREDATACUBE 16
 	#define FNA3D_COMMAND_GENCOLORRENDERBUFFER 17
 	#define FNA3D_COMMAND_GENDEPTHRENDERBUFFER 18
+	#define FNA3D_COMMAND_GETTEXTUREDATAASYNC 19
+	#define FNA3D_COMMAND_POLLREADBACK 20
+	#define FNA3D_COMMAND_WAITREADBACK 21
+	#define FNA3D_COMMAND_GETBUFFERDATAASYNC 22
 	uint8_t type;
 	FNA3DNAMELESS union
 	{
@@ -832,6 +972,39 @@ struct FNA3D_Command
 			int32_t multiSampleCount;
 			FNA3D_Renderbuffer *retval;
 		} genDepthStencilRenderbuffer;
+
+		struct
+		{
+			FNA3D_Texture *texture;
+			int32_t x;
+			int32_t y;
+			int32_t w;
+			int32_t h;
+			int32_t level;
+			int32_t dataLength;
+			FNA3D_ReadbackEXT *retval;
+		} getTextureDataAsync;
+
+		struct
+		{
+			FNA3D_Buffer *buffer;
+			int32_t offsetInBytes;
+			int32_t dataLength;
+			FNA3D_ReadbackEXT *retval;
+		} getBufferDataAsync;
+
+		struct
+		{
+			FNA3D_ReadbackEXT *readback;
+			uint8_t retval;
+		} pollReadback;
+
+		struct
+		{
+			FNA3D_ReadbackEXT *readback;
+			void *data;
+			int32_t dataLength;
+		} waitReadback;
 	};
 	SDL_Semaphore *semaphore;
 	FNA3D_Command *next;
@@ -1050,6 +1223,40 @@ static void FNA3D_ExecuteCommand(
 				cmd->genDepthStencilRenderbuffer.multiSampleCount
 			);
 			break;
+		case FNA3D_COMMAND_GETTEXTUREDATAASYNC:
+			cmd->getTextureDataAsync.retval = device->GetTextureDataAsync(
+				device->driverData,
+				cmd->getTextureDataAsync.texture,
+				cmd->getTextureDataAsync.x,
+				cmd->getTextureDataAsync.y,
+				cmd->getTextureDataAsync.w,
+				cmd->getTextureDataAsync.h,
+				cmd->getTextureDataAsync.level,
+				cmd->getTextureDataAsync.dataLength
+			);
+			break;
+		case FNA3D_COMMAND_GETBUFFERDATAASYNC:
+			cmd->getBufferDataAsync.retval = device->GetBufferDataAsync(
+				device->driverData,
+				cmd->getBufferDataAsync.buffer,
+				cmd->getBufferDataAsync.offsetInBytes,
+				cmd->getBufferDataAsync.dataLength
+			);
+			break;
+		case FNA3D_COMMAND_POLLREADBACK:
+			cmd->pollReadback.retval = device->PollReadback(
+				device->driverData,
+				cmd->pollReadback.readback
+			);
+			break;
+		case FNA3D_COMMAND_WAITREADBACK:
+			device->WaitReadback(
+				device->driverData,
+				cmd->waitReadback.readback,
+				cmd->waitReadback.data,
+				cmd->waitReadback.dataLength
+			);
+			break;
 		default:
 			FNA3D_LogError(
 				"Cannot execute unknown command (value = %d)",
@@ -1131,6 +1338,11 @@ static inline void BindIndexBuffer(OpenGLRenderer *renderer, GLuint handle)
 	}
 }
 
+static inline intptr_t BufferRegionOffset(OpenGLBuffer *buffer)
+{
+	return buffer->region * buffer->size;
+}
+
 static inline void ToggleGLState(
 	OpenGLRenderer *renderer,
 	GLenum feature,
@@ -1157,19 +1369,270 @@ static inline void ApplySRGBFlag(OpenGLRenderer *renderer, uint8_t state)
 	ToggleGLState(renderer, GL_FRAMEBUFFER_SRGB_EXT, state);
 }
 
+/* The command and dispose lists are pushed from any thread without locks,
+ * newest first. The GL thread swaps out the whole list at once, so a push
+ * never waits on the GL thread and vice versa.
+ */
+#define AtomicList_Push(start, toAdd) \
+	do \
+	{ \
+		toAdd->next = SDL_GetAtomicPointer((void**) &start); \
+	} while (!SDL_CompareAndSwapAtomicPointer( \
+		(void**) &start, \
+		toAdd->next, \
+		toAdd \
+	))
+
+#define AtomicList_Take(start) \
+	SDL_SetAtomicPointer((void**) &start, NULL)
+
+static inline SDL_Semaphore* AcquireCommandSemaphore(OpenGLRenderer *renderer)
+{
+	SDL_Semaphore *result = NULL;
+
+	SDL_LockSpinlock(&renderer->semaphorePoolLock);
+	if (renderer->semaphorePoolCount > 0)
+	{
+		renderer->semaphorePoolCount -= 1;
+		result = renderer->semaphorePool[renderer->semaphorePoolCount];
+	}
+	SDL_UnlockSpinlock(&renderer->semaphorePoolLock);
+
+	if (result == NULL)
+	{
+		result = SDL_CreateSemaphore(0);
+	}
+	return result;
+}
+
+static inline void ReleaseCommandSemaphore(
+	OpenGLRenderer *renderer,
+	SDL_Semaphore *semaphore
+) {
+	/* Waited as many times as it was signaled, so it's back to 0 */
+	SDL_LockSpinlock(&renderer->semaphorePoolLock);
+	if (renderer->semaphorePoolCount < MAX_POOLED_SEMAPHORES)
+	{
+		renderer->semaphorePool[renderer->semaphorePoolCount] = semaphore;
+		renderer->semaphorePoolCount += 1;
+		semaphore = NULL;
+	}
+	SDL_UnlockSpinlock(&renderer->semaphorePoolLock);
+
+	if (semaphore != NULL)
+	{
+		SDL_DestroySemaphore(semaphore);
+	}
+}
+
 static inline void ForceToMainThread(
 	OpenGLRenderer *renderer,
 	FNA3D_Command *command
 ) {
-	FNA3D_Command *curr;
-	command->semaphore = SDL_CreateSemaphore(0);
+	command->semaphore = AcquireCommandSemaphore(renderer);
+
+	AtomicList_Push(renderer->commands, command);
 
-	SDL_LockMutex(renderer->commandsLock);
-	LinkedList_Add(renderer->commands, command, curr);
-	SDL_UnlockMutex(renderer->commandsLock);
+	/* The render thread doesn't wait for SwapBuffers to check */
+	if (renderer->renderThreadWake != NULL)
+	{
+		SDL_SignalSemaphore(renderer->renderThreadWake);
+	}
 
 	SDL_WaitSemaphore(command->semaphore);
-	SDL_DestroySemaphore(command->semaphore);
+	ReleaseCommandSemaphore(renderer, command->semaphore);
+}
+
+/* Worker contexts let loader threads create and upload resources directly
+ * instead of waiting for the next SwapBuffers to run them. Each worker is
+ * a copy of the renderer with a context from the same share group, so the
+ * regular entry points can run on it unchanged. Only calls that don't
+ * touch FBOs, VAOs or MojoShader are routed here; everything else still
+ * goes through ForceToMainThread.
+ */
+
+static void OPENGL_INTERNAL_CreateWorkers(
+	OpenGLRenderer *renderer,
+	SDL_Window *window,
+	int32_t count
+) {
+	OpenGLRenderer *worker;
+	SDL_GLContext context;
+	int32_t i;
+
+	renderer->workerWindow = window;
+	renderer->workers = (OpenGLWorker*) SDL_calloc(count, sizeof(OpenGLWorker));
+	renderer->workersLock = SDL_CreateMutex();
+
+	SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+	for (i = 0; i < count; i += 1)
+	{
+		/* This makes the new context current, which we rely on below */
+		context = SDL_GL_CreateContext(window);
+		if (context == NULL)
+		{
+			FNA3D_LogWarn(
+				"Failed to create worker context: %s",
+				SDL_GetError()
+			);
+			break;
+		}
+
+		worker = (OpenGLRenderer*) SDL_malloc(sizeof(OpenGLRenderer));
+		SDL_memcpy(worker, renderer, sizeof(OpenGLRenderer));
+		worker->context = context;
+		worker->workers = NULL;
+		worker->workerCount = 0;
+		worker->uploadBuffer = 0; /* The ring isn't thread-safe */
+		worker->persistentBuffers = 0; /* Same for buffer regions */
+		worker->useVertexArrayCache = 0; /* Workers never draw */
+		SDL_zero(worker->vertexArrayCache);
+		SDL_zero(worker->samplerStateCache);
+		if (worker->useCoreProfile)
+		{
+			/* VAOs aren't shared, and Core wants one for index buffers */
+			worker->glGenVertexArrays(1, &worker->vao);
+			worker->glBindVertexArray(worker->vao);
+		}
+
+		renderer->workers[i].renderer = worker;
+		renderer->workerCount += 1;
+	}
+	SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+
+	SDL_GL_MakeCurrent(window, renderer->context);
+	FNA3D_LogInfo("OpenGL Worker Contexts: %d", renderer->workerCount);
+}
+
+static void OPENGL_INTERNAL_DestroyWorkers(OpenGLRenderer *renderer)
+{
+	int32_t i;
+
+	/* Worker threads are expected to be done with the device by now */
+	for (i = 0; i < renderer->workerCount; i += 1)
+	{
+#ifdef USE_SDL3
+		SDL_GL_DestroyContext(renderer->workers[i].renderer->context);
+#else
+		SDL_GL_DeleteContext(renderer->workers[i].renderer->context);
+#endif
+		SDL_free(renderer->workers[i].renderer);
+	}
+	SDL_free(renderer->workers);
+
+	for (i = 0; i < renderer->workerFenceCount; i += 1)
+	{
+		renderer->glDeleteSync(renderer->workerFences[i]);
+	}
+	SDL_free(renderer->workerFences);
+	SDL_DestroyMutex(renderer->workersLock);
+}
+
+static OpenGLRenderer* OPENGL_INTERNAL_GetWorker(OpenGLRenderer *renderer)
+{
+	OpenGLWorker *worker;
+	OpenGLRenderer *result = NULL;
+	int32_t i;
+
+	if (renderer->workerCount == 0)
+	{
+		return NULL;
+	}
+
+	/* Claims don't outlive the call. Thread IDs get reused and threads
+	 * don't tell us when they exit, so a per-thread claim could be held
+	 * forever by a thread that's long gone.
+	 */
+	SDL_LockMutex(renderer->workersLock);
+	for (i = 0; result == NULL && i < renderer->workerCount; i += 1)
+	{
+		worker = &renderer->workers[i];
+		if (worker->claimed || worker->failed)
+		{
+			continue;
+		}
+
+		/* EGL won't let a window surface be current on two threads */
+#ifdef USE_SDL3
+		if (!SDL_GL_MakeCurrent(
+#else
+		if (SDL_GL_MakeCurrent(
+#endif
+			renderer->isEGL ? NULL : renderer->workerWindow,
+			worker->renderer->context
+#ifdef USE_SDL3
+		)) {
+#else
+		) < 0) {
+#endif
+			FNA3D_LogWarn(
+				"Failed to make worker context current: %s",
+				SDL_GetError()
+			);
+			worker->failed = 1;
+			continue;
+		}
+
+		worker->claimed = 1;
+		worker->renderer->threadID = SDL_GetCurrentThreadID();
+		result = worker->renderer;
+	}
+	SDL_UnlockMutex(renderer->workersLock);
+
+	if (result != NULL)
+	{
+		/* Names are shared, so the main context may have deleted and
+		 * reissued anything we think is bound. Always rebind.
+		 */
+		result->textures[0] = &NullTexture;
+		result->currentVertexBuffer = 0;
+		result->currentIndexBuffer = 0;
+	}
+	return result;
+}
+
+static void OPENGL_INTERNAL_FinishWorker(
+	OpenGLRenderer *renderer,
+	OpenGLRenderer *worker
+) {
+	GLsync fence;
+	int32_t i;
+
+	/* The caller may hand the resource to the main thread as soon as we
+	 * return. Rather than waiting for the GPU here, the main context waits
+	 * on this fence before it next uses anything, see SyncWorkers. It has
+	 * to be flushed first or that wait may never end.
+	 */
+	fence = worker->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	worker->glFlush();
+
+	/* A context can only be current on one thread, let go of it */
+	SDL_GL_MakeCurrent(NULL, NULL);
+
+	SDL_LockMutex(renderer->workersLock);
+	if (renderer->workerFenceCount == renderer->workerFenceCapacity)
+	{
+		renderer->workerFenceCapacity = SDL_max(
+			renderer->workerFenceCapacity * 2,
+			4
+		);
+		renderer->workerFences = (GLsync*) SDL_realloc(
+			renderer->workerFences,
+			sizeof(GLsync) * renderer->workerFenceCapacity
+		);
+	}
+	renderer->workerFences[renderer->workerFenceCount] = fence;
+	renderer->workerFenceCount += 1;
+	SDL_SetAtomicInt(&renderer->workerFencesPending, 1);
+	for (i = 0; i < renderer->workerCount; i += 1)
+	{
+		if (renderer->workers[i].renderer == worker)
+		{
+			renderer->workers[i].claimed = 0;
+			break;
+		}
+	}
+	SDL_UnlockMutex(renderer->workersLock);
 }
 
 /* Forward Declarations for Internal Functions */
@@ -1179,6 +1642,7 @@ static void OPENGL_INTERNAL_CreateBackbuffer(
 	FNA3D_PresentationParameters *parameters
 );
 static void OPENGL_INTERNAL_DisposeBackbuffer(OpenGLRenderer *renderer);
+static void OPENGL_INTERNAL_DestroyUploadBuffer(OpenGLRenderer *renderer);
 static void OPENGL_INTERNAL_DestroyTexture(
 	OpenGLRenderer *renderer,
 	OpenGLTexture *texture
@@ -1203,6 +1667,11 @@ static void OPENGL_INTERNAL_DestroyQuery(
 	OpenGLRenderer *renderer,
 	OpenGLQuery *query
 );
+static void OPENGL_INTERNAL_UnregisterProgramCache(OpenGLRenderer *renderer);
+static void OPENGL_INTERNAL_DeleteVertexArrays(
+	OpenGLRenderer *renderer,
+	OpenGLVertexArray *vertexArray
+);
 static void OPENGL_GetBackbufferSize(
 	FNA3D_Renderer *driverData,
 	int32_t *w,
@@ -1216,19 +1685,77 @@ static void OPENGL_GetBackbufferSize(
 static void OPENGL_DestroyDevice(FNA3D_Device *device)
 {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) device->driverData;
+	int32_t i;
+
+	if (renderer->renderThread != NULL)
+	{
+		/* The threaded context already flushed, take the GL context back */
+		SDL_SetAtomicInt(&renderer->renderThreadQuit, 1);
+		SDL_SignalSemaphore(renderer->renderThreadWake);
+		SDL_WaitThread(renderer->renderThread, NULL);
+		SDL_DestroySemaphore(renderer->renderThreadWake);
+		renderer->renderThreadWake = NULL;
+		SDL_GL_MakeCurrent(renderer->renderThreadWindow, renderer->context);
+		renderer->threadID = SDL_GetCurrentThreadID();
+	}
 
 	if (renderer->useCoreProfile)
 	{
+		for (i = 0; i < renderer->vertexArrayCache.count; i += 1)
+		{
+			OPENGL_INTERNAL_DeleteVertexArrays(
+				renderer,
+				(OpenGLVertexArray*) renderer->vertexArrayCache.elements[i].value
+			);
+		}
+		SDL_free(renderer->vertexArrayCache.elements);
 		renderer->glBindVertexArray(0);
 		renderer->glDeleteVertexArrays(1, &renderer->vao);
 	}
 
+	for (i = 0; i < renderer->samplerStateCache.count; i += 1)
+	{
+		GLuint sampler = (GLuint) (size_t) renderer->samplerStateCache.elements[i].value;
+		renderer->glDeleteSamplers(1, &sampler);
+	}
+	SDL_free(renderer->samplerStateCache.elements);
+
+	/* Pending frames are dropped, the device is going away */
+	for (i = 0; i < FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT; i += 1)
+	{
+		if (renderer->captureFrames[i].pbo != 0)
+		{
+			renderer->glDeleteBuffers(1, &renderer->captureFrames[i].pbo);
+		}
+	}
+	SDL_free(renderer->captureData);
+
+	for (i = 0; i < MAX_FRAMES_IN_FLIGHT; i += 1)
+	{
+		if (renderer->frameFences[i] != NULL)
+		{
+			renderer->glDeleteSync(renderer->frameFences[i]);
+		}
+	}
+
+	if (renderer->uploadBuffer != 0)
+	{
+		OPENGL_INTERNAL_DestroyUploadBuffer(renderer);
+	}
+
 	renderer->glDeleteFramebuffers(1, &renderer->resolveFramebufferRead);
 	renderer->resolveFramebufferRead = 0;
 	renderer->glDeleteFramebuffers(1, &renderer->resolveFramebufferDraw);
 	renderer->resolveFramebufferDraw = 0;
 	renderer->glDeleteFramebuffers(1, &renderer->targetFramebuffer);
 	renderer->targetFramebuffer = 0;
+	if (renderer->readbackFramebuffer != 0)
+	{
+		renderer->glDeleteFramebuffers(1, &renderer->readbackFramebuffer);
+		renderer->readbackFramebuffer = 0;
+		renderer->glDeleteRenderbuffers(1, &renderer->readbackRenderbuffer);
+		renderer->readbackRenderbuffer = 0;
+	}
 
 	if (renderer->backbuffer->type == BACKBUFFER_TYPE_OPENGL)
 	{
@@ -1239,14 +1766,21 @@ static void OPENGL_DestroyDevice(FNA3D_Device *device)
 
 	MOJOSHADER_glMakeContextCurrent(NULL);
 	MOJOSHADER_glDestroyContext(renderer->shaderContext);
+	if (renderer->programCacheDir != NULL)
+	{
+		OPENGL_INTERNAL_UnregisterProgramCache(renderer);
+	}
+	SDL_free(renderer->programCacheDir);
+
+	for (i = 0; i < renderer->semaphorePoolCount; i += 1)
+	{
+		SDL_DestroySemaphore(renderer->semaphorePool[i]);
+	}
 
-	SDL_DestroyMutex(renderer->commandsLock);
-	SDL_DestroyMutex(renderer->disposeTexturesLock);
-	SDL_DestroyMutex(renderer->disposeRenderbuffersLock);
-	SDL_DestroyMutex(renderer->disposeVertexBuffersLock);
-	SDL_DestroyMutex(renderer->disposeIndexBuffersLock);
-	SDL_DestroyMutex(renderer->disposeEffectsLock);
-	SDL_DestroyMutex(renderer->disposeQueriesLock);
+	if (renderer->workers != NULL)
+	{
+		OPENGL_INTERNAL_DestroyWorkers(renderer);
+	}
 
 #ifdef USE_SDL3
 	SDL_GL_DestroyContext(renderer->context);
@@ -1262,10 +1796,19 @@ static void OPENGL_DestroyDevice(FNA3D_Device *device)
 
 static inline void ExecuteCommands(OpenGLRenderer *renderer)
 {
-	FNA3D_Command *cmd, *next;
+	FNA3D_Command *cmd, *next, *ordered = NULL;
+
+	/* The list is newest first, run them in submission order */
+	cmd = (FNA3D_Command*) AtomicList_Take(renderer->commands);
+	while (cmd != NULL)
+	{
+		next = cmd->next;
+		cmd->next = ordered;
+		ordered = cmd;
+		cmd = next;
+	}
 
-	SDL_LockMutex(renderer->commandsLock);
-	cmd = renderer->commands;
+	cmd = ordered;
 	while (cmd != NULL)
 	{
 		FNA3D_ExecuteCommand(
@@ -1276,8 +1819,7 @@ static inline void ExecuteCommands(OpenGLRenderer *renderer)
 		SDL_SignalSemaphore(cmd->semaphore);
 		cmd = next;
 	}
-	renderer->commands = NULL; /* No heap memory to free! -caleb */
-	SDL_UnlockMutex(renderer->commandsLock);
+	/* No heap memory to free! -caleb */
 }
 
 static inline void DisposeResources(OpenGLRenderer *renderer)
@@ -1290,16 +1832,13 @@ static inline void DisposeResources(OpenGLRenderer *renderer)
 
 	/* All heap allocations are freed by func! -caleb */
 	#define DISPOSE(prefix, list, func) \
-		SDL_LockMutex(list##Lock); \
-		prefix = list; \
+		prefix = AtomicList_Take(list); \
 		while (prefix != NULL) \
 		{ \
 			prefix##Next = prefix->next; \
 			OPENGL_INTERNAL_##func(renderer, prefix); \
 			prefix = prefix##Next; \
-		} \
-		list = NULL; \
-		SDL_UnlockMutex(list##Lock);
+		}
 
 	DISPOSE(tex, renderer->disposeTextures, DestroyTexture)
 	DISPOSE(ren, renderer->disposeRenderbuffers, DestroyRenderbuffer)
@@ -1311,58 +1850,451 @@ static inline void DisposeResources(OpenGLRenderer *renderer)
 	#undef DISPOSE
 }
 
-static void OPENGL_SwapBuffers(
-	FNA3D_Renderer *driverData,
-	FNA3D_Rect *sourceRectangle,
-	FNA3D_Rect *destinationRectangle,
-	void* overrideWindowHandle
+static void OPENGL_INTERNAL_BindBackbufferForReading(
+	OpenGLRenderer *renderer
 ) {
-	int32_t srcX, srcY, srcW, srcH;
-	int32_t dstX, dstY, dstW, dstH;
-	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	GLuint prevDrawBuffer;
 
-	/* Only the faux-backbuffer supports presenting
-	 * specific regions given to Present().
-	 * -flibit
-	 */
-	if (renderer->backbuffer->type == BACKBUFFER_TYPE_OPENGL)
+	if (renderer->backbuffer->multiSampleCount > 0)
 	{
-		if (sourceRectangle != NULL)
-		{
-			srcX = sourceRectangle->x;
-			srcY = sourceRectangle->y;
-			srcW = sourceRectangle->w;
-			srcH = sourceRectangle->h;
-		}
-		else
-		{
-			srcX = 0;
-			srcY = 0;
-			srcW = renderer->backbuffer->width;
-			srcH = renderer->backbuffer->height;
-		}
-		if (destinationRectangle != NULL)
-		{
-			dstX = destinationRectangle->x;
-			dstY = destinationRectangle->y;
-			dstW = destinationRectangle->w;
-			dstH = destinationRectangle->h;
-		}
-		else
-		{
-			dstX = 0;
-			dstY = 0;
-			SDL_GetWindowSizeInPixels(
-				(SDL_Window*) overrideWindowHandle,
-				&dstW,
-				&dstH
-			);
-		}
+		/* We have to resolve the renderbuffer to a texture first. */
+		prevDrawBuffer = renderer->currentDrawFramebuffer;
 
-		if (renderer->scissorTestEnable)
+		if (renderer->backbuffer->opengl.texture == 0)
 		{
-			renderer->glDisable(GL_SCISSOR_TEST);
-		}
+			renderer->glGenTextures(
+				1,
+				&renderer->backbuffer->opengl.texture
+			);
+			renderer->glBindTexture(
+				GL_TEXTURE_2D,
+				renderer->backbuffer->opengl.texture
+			);
+			renderer->glTexImage2D(
+				GL_TEXTURE_2D,
+				0,
+				GL_RGBA,
+				renderer->backbuffer->width,
+				renderer->backbuffer->height,
+				0,
+				GL_RGBA,
+				GL_UNSIGNED_BYTE,
+				NULL
+			);
+			renderer->glBindTexture(
+				renderer->textures[0]->target,
+				renderer->textures[0]->handle
+			);
+		}
+		BindFramebuffer(renderer, renderer->resolveFramebufferDraw);
+		renderer->glFramebufferTexture2D(
+			GL_FRAMEBUFFER,
+			GL_COLOR_ATTACHMENT0,
+			GL_TEXTURE_2D,
+			renderer->backbuffer->opengl.texture,
+			0
+		);
+		BindReadFramebuffer(renderer, renderer->backbuffer->opengl.handle);
+		renderer->glBlitFramebuffer(
+			0, 0, renderer->backbuffer->width, renderer->backbuffer->height,
+			0, 0, renderer->backbuffer->width, renderer->backbuffer->height,
+			GL_COLOR_BUFFER_BIT,
+			GL_LINEAR
+		);
+		/* Don't invalidate the backbuffer here! */
+		BindDrawFramebuffer(renderer, prevDrawBuffer);
+		BindReadFramebuffer(renderer, renderer->resolveFramebufferDraw);
+	}
+	else
+	{
+		BindReadFramebuffer(
+			renderer,
+			(renderer->backbuffer->type == BACKBUFFER_TYPE_OPENGL) ?
+				renderer->backbuffer->opengl.handle :
+				0
+		);
+	}
+}
+
+/* Blits the bound read framebuffer's region upside-down into a scratch
+ * renderbuffer and binds that for reading instead, so glReadPixels hands
+ * back top-down rows. Returns 0 if we can't blit, so flip on the CPU.
+ */
+static uint8_t OPENGL_INTERNAL_FlipForReading(
+	OpenGLRenderer *renderer,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h
+) {
+	GLuint prevDrawBuffer;
+
+	if (!renderer->supports_EXT_framebuffer_blit)
+	{
+		return 0;
+	}
+
+	prevDrawBuffer = renderer->currentDrawFramebuffer;
+
+	if (renderer->readbackFramebuffer == 0)
+	{
+		renderer->glGenFramebuffers(1, &renderer->readbackFramebuffer);
+		renderer->glGenRenderbuffers(1, &renderer->readbackRenderbuffer);
+	}
+	BindDrawFramebuffer(renderer, renderer->readbackFramebuffer);
+
+	/* Only ever grows, these are usually the same size every time */
+	if (w > renderer->readbackWidth || h > renderer->readbackHeight)
+	{
+		renderer->readbackWidth = SDL_max(w, renderer->readbackWidth);
+		renderer->readbackHeight = SDL_max(h, renderer->readbackHeight);
+		renderer->glBindRenderbuffer(
+			GL_RENDERBUFFER,
+			renderer->readbackRenderbuffer
+		);
+		renderer->glRenderbufferStorage(
+			GL_RENDERBUFFER,
+			GL_RGBA8,
+			renderer->readbackWidth,
+			renderer->readbackHeight
+		);
+		renderer->glBindRenderbuffer(
+			GL_RENDERBUFFER,
+			renderer->realBackbufferRBO
+		);
+		renderer->glFramebufferRenderbuffer(
+			GL_DRAW_FRAMEBUFFER,
+			GL_COLOR_ATTACHMENT0,
+			GL_RENDERBUFFER,
+			renderer->readbackRenderbuffer
+		);
+	}
+
+	if (renderer->scissorTestEnable)
+	{
+		renderer->glDisable(GL_SCISSOR_TEST);
+	}
+	renderer->glBlitFramebuffer(
+		x, y, x + w, y + h,
+		0, h, w, 0,
+		GL_COLOR_BUFFER_BIT,
+		GL_NEAREST
+	);
+	if (renderer->scissorTestEnable)
+	{
+		renderer->glEnable(GL_SCISSOR_TEST);
+	}
+
+	BindDrawFramebuffer(renderer, prevDrawBuffer);
+	BindReadFramebuffer(renderer, renderer->readbackFramebuffer);
+	return 1;
+}
+
+/* Backbuffer Capture */
+
+static void OPENGL_INTERNAL_DeliverCaptureFrame(
+	OpenGLRenderer *renderer,
+	OpenGLCaptureFrame *frame
+) {
+	int32_t pitch, row, dataLength;
+	uint8_t *flipped, *src;
+
+	if (!frame->pending)
+	{
+		return;
+	}
+	frame->pending = 0;
+
+	pitch = frame->width * 4;
+	dataLength = pitch * frame->height;
+
+	/* First half is handed to the callback, second half is the PBO copy */
+	if (renderer->captureDataLength < dataLength)
+	{
+		SDL_free(renderer->captureData);
+		renderer->captureData = (uint8_t*) SDL_malloc(dataLength * 2);
+		renderer->captureDataLength = dataLength;
+	}
+	flipped = renderer->captureData;
+	src = renderer->captureData + renderer->captureDataLength;
+
+	/* The copy was queued frames ago, so this should not have to wait */
+	renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, frame->pbo);
+	renderer->glGetBufferSubData(
+		GL_PIXEL_PACK_BUFFER,
+		0,
+		(GLsizeiptr) dataLength,
+		src
+	);
+	renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	/* GL rows are bottom-up, flip them while copying out */
+	for (row = 0; row < frame->height; row += 1)
+	{
+		SDL_memcpy(
+			flipped + (row * pitch),
+			src + ((frame->height - row - 1) * pitch),
+			pitch
+		);
+	}
+
+	renderer->captureCallback(
+		flipped,
+		frame->width,
+		frame->height,
+		dataLength,
+		renderer->captureUserdata
+	);
+}
+
+static void OPENGL_INTERNAL_FlushCaptureFrames(OpenGLRenderer *renderer)
+{
+	OpenGLCaptureFrame *frame;
+	int32_t i;
+
+	/* Oldest first, which is the next slot to be reused */
+	for (i = 0; i < renderer->captureFrameCount; i += 1)
+	{
+		frame = &renderer->captureFrames[
+			(renderer->captureIndex + i) % renderer->captureFrameCount
+		];
+		OPENGL_INTERNAL_DeliverCaptureFrame(renderer, frame);
+		if (frame->pbo != 0)
+		{
+			renderer->glDeleteBuffers(1, &frame->pbo);
+			frame->pbo = 0;
+			frame->bufferSize = 0;
+		}
+	}
+	renderer->captureIndex = 0;
+
+	SDL_free(renderer->captureData);
+	renderer->captureData = NULL;
+	renderer->captureDataLength = 0;
+}
+
+static void OPENGL_INTERNAL_CaptureBackbuffer(OpenGLRenderer *renderer)
+{
+	OpenGLCaptureFrame *frame = &renderer->captureFrames[renderer->captureIndex];
+	GLuint prevReadBuffer = renderer->currentReadFramebuffer;
+	int32_t dataLength;
+
+	/* Make room by handing off the oldest frame */
+	OPENGL_INTERNAL_DeliverCaptureFrame(renderer, frame);
+
+	frame->width = renderer->backbuffer->width;
+	frame->height = renderer->backbuffer->height;
+	dataLength = frame->width * frame->height * 4;
+
+	if (frame->pbo == 0)
+	{
+		renderer->glGenBuffers(1, &frame->pbo);
+	}
+	renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, frame->pbo);
+	if (frame->bufferSize < dataLength)
+	{
+		renderer->glBufferData(
+			GL_PIXEL_PACK_BUFFER,
+			(GLsizeiptr) dataLength,
+			NULL,
+			GL_STREAM_READ
+		);
+		frame->bufferSize = dataLength;
+	}
+
+	/* With a pack buffer bound this queues the copy and returns */
+	OPENGL_INTERNAL_BindBackbufferForReading(renderer);
+	renderer->glReadPixels(
+		0,
+		0,
+		frame->width,
+		frame->height,
+		GL_RGBA,
+		GL_UNSIGNED_BYTE,
+		NULL
+	);
+	renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	BindReadFramebuffer(renderer, prevReadBuffer);
+
+	frame->pending = 1;
+	renderer->captureIndex = (
+		(renderer->captureIndex + 1) % renderer->captureFrameCount
+	);
+}
+
+static void OPENGL_INTERNAL_PaceFrame(OpenGLRenderer *renderer)
+{
+	GLsync fence;
+	GLenum waitResult;
+
+	/* Fence the frame we just swapped... */
+	renderer->frameFences[renderer->frameFenceIndex] = renderer->glFenceSync(
+		GL_SYNC_GPU_COMMANDS_COMPLETE,
+		0
+	);
+	renderer->frameFenceIndex = (
+		(renderer->frameFenceIndex + 1) % renderer->framesInFlight
+	);
+
+	/* ... then block until the oldest frame is done, so that at most
+	 * framesInFlight frames are queued when we start the next one.
+	 */
+	fence = renderer->frameFences[renderer->frameFenceIndex];
+	if (fence == NULL)
+	{
+		return;
+	}
+	do
+	{
+		waitResult = renderer->glClientWaitSync(
+			fence,
+			GL_SYNC_FLUSH_COMMANDS_BIT,
+			1000000000 /* 1 second */
+		);
+	} while (waitResult == GL_TIMEOUT_EXPIRED);
+	if (waitResult == GL_WAIT_FAILED)
+	{
+		FNA3D_LogWarn("Frame fence wait failed, disabling frame pacing");
+		renderer->framesInFlight = 0;
+	}
+	renderer->glDeleteSync(fence);
+	renderer->frameFences[renderer->frameFenceIndex] = NULL;
+}
+
+/* Render Thread */
+
+static void OPENGL_INTERNAL_WakeRenderThread(FNA3D_Renderer *driverData)
+{
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	SDL_SignalSemaphore(renderer->renderThreadWake);
+}
+
+static int SDLCALL OPENGL_INTERNAL_RenderThread(void *data)
+{
+	OpenGLRenderer *renderer = (OpenGLRenderer*) data;
+
+	/* Everything checks this to see if it needs to forward to GL's thread,
+	 * so it has to be right before StartRenderThread returns.
+	 */
+	renderer->threadID = SDL_GetCurrentThreadID();
+	SDL_GL_MakeCurrent(renderer->renderThreadWindow, renderer->context);
+	SDL_SignalSemaphore(renderer->renderThreadStarted);
+	do
+	{
+		SDL_WaitSemaphore(renderer->renderThreadWake);
+
+		/* Frames (which end in SwapBuffers) first, then any calls that
+		 * other threads are blocked on.
+		 */
+		FNA3D_INTERNAL_ExecuteThreadedContext(renderer->renderThreadContext);
+		ExecuteCommands(renderer);
+	} while (!SDL_GetAtomicInt(&renderer->renderThreadQuit));
+	SDL_GL_MakeCurrent(renderer->renderThreadWindow, NULL);
+	return 0;
+}
+
+static FNA3D_Device* OPENGL_INTERNAL_StartRenderThread(
+	OpenGLRenderer *renderer,
+	SDL_Window *window
+) {
+	renderer->renderThreadWindow = window;
+	renderer->renderThreadWake = SDL_CreateSemaphore(0);
+	renderer->renderThreadStarted = SDL_CreateSemaphore(0);
+	SDL_SetAtomicInt(&renderer->renderThreadQuit, 0);
+
+	/* A context can only be current on one thread at a time */
+	SDL_GL_MakeCurrent(window, NULL);
+	renderer->renderThread = SDL_CreateThread(
+		OPENGL_INTERNAL_RenderThread,
+		"FNA3D_OpenGL",
+		renderer
+	);
+	if (renderer->renderThread == NULL)
+	{
+		FNA3D_LogWarn(
+			"Failed to create render thread: %s",
+			SDL_GetError()
+		);
+		SDL_GL_MakeCurrent(window, renderer->context);
+		SDL_DestroySemaphore(renderer->renderThreadWake);
+		SDL_DestroySemaphore(renderer->renderThreadStarted);
+		renderer->renderThreadWake = NULL;
+		renderer->renderThreadStarted = NULL;
+		return renderer->parentDevice;
+	}
+
+	/* Wait for the thread to take the context and publish its ID */
+	SDL_WaitSemaphore(renderer->renderThreadStarted);
+	SDL_DestroySemaphore(renderer->renderThreadStarted);
+	renderer->renderThreadStarted = NULL;
+
+	/* Nothing wakes the thread up until we've returned this */
+	renderer->renderThreadContext = FNA3D_INTERNAL_CreateThreadedContext(
+		renderer->parentDevice,
+		OPENGL_INTERNAL_WakeRenderThread
+	);
+
+	return renderer->renderThreadContext;
+}
+
+static void OPENGL_SwapBuffers(
+	FNA3D_Renderer *driverData,
+	FNA3D_Rect *sourceRectangle,
+	FNA3D_Rect *destinationRectangle,
+	void* overrideWindowHandle
+) {
+	int32_t srcX, srcY, srcW, srcH;
+	int32_t dstX, dstY, dstW, dstH;
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+
+	/* Capture before the faux-backbuffer gets invalidated */
+	if (renderer->captureCallback != NULL)
+	{
+		OPENGL_INTERNAL_CaptureBackbuffer(renderer);
+	}
+
+	/* Only the faux-backbuffer supports presenting
+	 * specific regions given to Present().
+	 * -flibit
+	 */
+	if (renderer->backbuffer->type == BACKBUFFER_TYPE_OPENGL)
+	{
+		if (sourceRectangle != NULL)
+		{
+			srcX = sourceRectangle->x;
+			srcY = sourceRectangle->y;
+			srcW = sourceRectangle->w;
+			srcH = sourceRectangle->h;
+		}
+		else
+		{
+			srcX = 0;
+			srcY = 0;
+			srcW = renderer->backbuffer->width;
+			srcH = renderer->backbuffer->height;
+		}
+		if (destinationRectangle != NULL)
+		{
+			dstX = destinationRectangle->x;
+			dstY = destinationRectangle->y;
+			dstW = destinationRectangle->w;
+			dstH = destinationRectangle->h;
+		}
+		else
+		{
+			dstX = 0;
+			dstY = 0;
+			SDL_GetWindowSizeInPixels(
+				(SDL_Window*) overrideWindowHandle,
+				&dstW,
+				&dstH
+			);
+		}
+
+		if (renderer->scissorTestEnable)
+		{
+			renderer->glDisable(GL_SCISSOR_TEST);
+		}
 
 		if (	renderer->backbuffer->multiSampleCount > 0 &&
 			(srcX != dstX || srcY != dstY || srcW != dstW || srcH != dstH)	)
@@ -1457,6 +2389,11 @@ static void OPENGL_SwapBuffers(
 		SDL_GL_SwapWindow((SDL_Window*) overrideWindowHandle);
 	}
 
+	if (renderer->framesInFlight > 0)
+	{
+		OPENGL_INTERNAL_PaceFrame(renderer);
+	}
+
 	/* Run any threaded commands */
 	ExecuteCommands(renderer);
 
@@ -1611,7 +2548,10 @@ static void OPENGL_DrawIndexedPrimitives(
 			minVertexIndex + numVertices - 1,
 			PrimitiveVerts(primitiveType, primitiveCount),
 			XNAToGL_IndexType[indexElementSize],
-			(void*) (size_t) (startIndex * IndexSize(indexElementSize)),
+			(void*) (size_t) (
+				BufferRegionOffset(buffer) +
+				(startIndex * IndexSize(indexElementSize))
+			),
 			baseVertex
 		);
 	}
@@ -1623,7 +2563,10 @@ static void OPENGL_DrawIndexedPrimitives(
 			minVertexIndex + numVertices - 1,
 			PrimitiveVerts(primitiveType, primitiveCount),
 			XNAToGL_IndexType[indexElementSize],
-			(void*) (size_t) (startIndex * IndexSize(indexElementSize))
+			(void*) (size_t) (
+				BufferRegionOffset(buffer) +
+				(startIndex * IndexSize(indexElementSize))
+			)
 		);
 	}
 
@@ -1671,7 +2614,10 @@ static void OPENGL_DrawInstancedPrimitives(
 			XNAToGL_Primitive[primitiveType],
 			PrimitiveVerts(primitiveType, primitiveCount),
 			XNAToGL_IndexType[indexElementSize],
-			(void*) (size_t) (startIndex * IndexSize(indexElementSize)),
+			(void*) (size_t) (
+				BufferRegionOffset(buffer) +
+				(startIndex * IndexSize(indexElementSize))
+			),
 			instanceCount,
 			baseVertex
 		);
@@ -1682,7 +2628,10 @@ static void OPENGL_DrawInstancedPrimitives(
 			XNAToGL_Primitive[primitiveType],
 			PrimitiveVerts(primitiveType, primitiveCount),
 			XNAToGL_IndexType[indexElementSize],
-			(void*) (size_t) (startIndex * IndexSize(indexElementSize)),
+			(void*) (size_t) (
+				BufferRegionOffset(buffer) +
+				(startIndex * IndexSize(indexElementSize))
+			),
 			instanceCount
 		);
 	}
@@ -2263,14 +3212,115 @@ static void OPENGL_ApplyRasterizerState(
 	}
 }
 
-static void OPENGL_VerifySampler(
-	FNA3D_Renderer *driverData,
-	int32_t index,
-	FNA3D_Texture *texture,
+static GLuint OPENGL_INTERNAL_FetchSamplerState(
+	OpenGLRenderer *renderer,
+	FNA3D_SamplerState *state,
+	uint8_t hasMipmaps
+) {
+	PackedState packedState;
+	GLuint result;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT
+	];
+	uint64_t createStart;
+
+	/* Can we just reuse an existing sampler? */
+	packedState = GetPackedSamplerState(*state);
+	if (hasMipmaps)
+	{
+		/* The min filter depends on the texture too. The packed
+		 * filter and address modes stop well short of bit 16.
+		 */
+		packedState.a |= (uint64_t) 1 << 16;
+	}
+	result = (GLuint) (size_t) PackedStateArray_Fetch(
+		renderer->samplerStateCache,
+		packedState
+	);
+	if (result != 0)
+	{
+		/* The sampler is already cached! */
+		stats->hits += 1;
+		return result;
+	}
+
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
+	/* We have to make a new sampler object... */
+	renderer->glGenSamplers(1, &result);
+	renderer->glSamplerParameteri(
+		result,
+		GL_TEXTURE_WRAP_S,
+		XNAToGL_Wrap[state->addressU]
+	);
+	renderer->glSamplerParameteri(
+		result,
+		GL_TEXTURE_WRAP_T,
+		XNAToGL_Wrap[state->addressV]
+	);
+	renderer->glSamplerParameteri(
+		result,
+		GL_TEXTURE_WRAP_R,
+		XNAToGL_Wrap[state->addressW]
+	);
+	renderer->glSamplerParameteri(
+		result,
+		GL_TEXTURE_MAG_FILTER,
+		XNAToGL_MagFilter[state->filter]
+	);
+	renderer->glSamplerParameteri(
+		result,
+		GL_TEXTURE_MIN_FILTER,
+		hasMipmaps ?
+			XNAToGL_MinMipFilter[state->filter] :
+			XNAToGL_MinFilter[state->filter]
+	);
+	if (renderer->supports_anisotropic_filtering)
+	{
+		renderer->glSamplerParameterf(
+			result,
+			GL_TEXTURE_MAX_ANISOTROPY_EXT,
+			(state->filter == FNA3D_TEXTUREFILTER_ANISOTROPIC) ?
+				SDL_max((float) state->maxAnisotropy, 1.0f) :
+				1.0f
+		);
+	}
+
+	/* BASE_LEVEL is texture state, so clamp the LOD instead like D3D does */
+	renderer->glSamplerParameterf(
+		result,
+		GL_TEXTURE_MIN_LOD,
+		(float) state->maxMipLevel
+	);
+	if (!renderer->useES3)
+	{
+		renderer->glSamplerParameterf(
+			result,
+			GL_TEXTURE_LOD_BIAS,
+			state->mipMapLevelOfDetailBias
+		);
+	}
+
+	PipelineCacheStats_EndCreate(stats, createStart);
+	PackedStateArray_Insert(
+		&renderer->samplerStateCache,
+		packedState,
+		(void*) (size_t) result
+	);
+	return result;
+}
+
+static void OPENGL_VerifySampler(
+	FNA3D_Renderer *driverData,
+	int32_t index,
+	FNA3D_Texture *texture,
 	FNA3D_SamplerState *sampler
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLTexture *tex = (OpenGLTexture*) texture;
+	GLuint samplerHandle;
+	int32_t generation;
 
 	if (texture == NULL)
 	{
@@ -2291,7 +3341,51 @@ static void OPENGL_VerifySampler(
 		return;
 	}
 
+	/* Changes made by another context only show up once the texture is
+	 * bound again, even if it never left this unit.
+	 */
+	generation = SDL_GetAtomicInt(&tex->generation);
+
+	if (renderer->supports_ARB_sampler_objects)
+	{
+		if (	tex != renderer->textures[index] ||
+			generation != renderer->textureGenerations[index]	)
+		{
+			if (index != 0)
+			{
+				renderer->glActiveTexture(GL_TEXTURE0 + index);
+			}
+			if (tex->target != renderer->textures[index]->target)
+			{
+				/* If we're changing targets, unbind the old texture first! */
+				renderer->glBindTexture(renderer->textures[index]->target, 0);
+			}
+			renderer->glBindTexture(tex->target, tex->handle);
+			renderer->textures[index] = tex;
+			renderer->textureGenerations[index] = generation;
+			if (index != 0)
+			{
+				/* Keep this state sane. -flibit */
+				renderer->glActiveTexture(GL_TEXTURE0);
+			}
+		}
+
+		/* Samplers are bound to the unit, not the texture */
+		samplerHandle = OPENGL_INTERNAL_FetchSamplerState(
+			renderer,
+			sampler,
+			tex->hasMipmaps
+		);
+		if (samplerHandle != renderer->samplers[index])
+		{
+			renderer->glBindSampler(index, samplerHandle);
+			renderer->samplers[index] = samplerHandle;
+		}
+		return;
+	}
+
 	if (	tex == renderer->textures[index] &&
+		generation == renderer->textureGenerations[index] &&
 		sampler->addressU == tex->wrapS &&
 		sampler->addressV == tex->wrapT &&
 		sampler->addressW == tex->wrapR &&
@@ -2311,7 +3405,8 @@ static void OPENGL_VerifySampler(
 	}
 
 	/* Bind the correct texture */
-	if (tex != renderer->textures[index])
+	if (	tex != renderer->textures[index] ||
+		generation != renderer->textureGenerations[index]	)
 	{
 		if (tex->target != renderer->textures[index]->target)
 		{
@@ -2320,6 +3415,7 @@ static void OPENGL_VerifySampler(
 		}
 		renderer->glBindTexture(tex->target, tex->handle);
 		renderer->textures[index] = tex;
+		renderer->textureGenerations[index] = generation;
 	}
 
 	/* Apply the sampler states to the GL texture */
@@ -2448,6 +3544,329 @@ static inline void OPENGL_INTERNAL_FlushGLVertexAttributes(OpenGLRenderer *rende
 	}
 }
 
+/* Picks the attribute location for an element, given the usage indices that
+ * earlier elements already took.
+ *
+ * There's this weird case where you can have overlapping vertex usage/index
+ * combinations. It seems like the first attrib gets priority, so whenever a
+ * duplicate attribute exists, give it the next available index. If that
+ * fails, we have to crash :/
+ * -flibit
+ */
+static int32_t OPENGL_INTERNAL_GetAttribLocation(
+	uint8_t attrUse[MOJOSHADER_USAGE_TOTAL][16],
+	FNA3D_VertexElement *element
+) {
+	int32_t usage = element->vertexElementUsage;
+	int32_t index = element->usageIndex;
+	int32_t k;
+
+	if (attrUse[usage][index])
+	{
+		index = -1;
+		for (k = 0; k < 16; k += 1)
+		{
+			if (!attrUse[usage][k])
+			{
+				index = k;
+				break;
+			}
+		}
+		if (index < 0)
+		{
+			FNA3D_LogError(
+				"Vertex usage collision!"
+			);
+			return -1;
+		}
+	}
+	attrUse[usage][index] = 1;
+	return MOJOSHADER_glGetVertexAttribLocation(
+		VertexAttribUsage(usage),
+		index
+	);
+}
+
+/* Vertex Array Cache */
+
+static inline void BindVertexArray(
+	OpenGLRenderer *renderer,
+	OpenGLVertexArray *vertexArray
+) {
+	if (vertexArray != renderer->currentVertexArray)
+	{
+		renderer->glBindVertexArray(
+			(vertexArray != NULL) ? vertexArray->handle : renderer->vao
+		);
+		renderer->currentVertexArray = vertexArray;
+
+		/* The element buffer binding is VAO state */
+		renderer->currentIndexBuffer = UINT32_MAX;
+	}
+}
+
+static OpenGLVertexArray* OPENGL_INTERNAL_FetchVertexArray(
+	OpenGLRenderer *renderer,
+	FNA3D_VertexBufferBinding *bindings,
+	int32_t numBindings
+) {
+	MOJOSHADER_glShader *vertexShader, *pixelShader;
+	OpenGLVertexArray *head, *vertexArray;
+	int32_t bindingsIndex;
+	uint32_t hash;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT
+	];
+	uint64_t createStart;
+	int32_t i, j, attribLoc;
+	uint8_t attrUse[MOJOSHADER_USAGE_TOTAL][16];
+	FNA3D_VertexDeclaration *vertexDeclaration;
+	FNA3D_VertexElement *element;
+
+	MOJOSHADER_glGetBoundShaders(&vertexShader, &pixelShader);
+
+	head = (OpenGLVertexArray*) PackedVertexBufferBindingsArray_Fetch(
+		renderer->vertexArrayCache,
+		bindings,
+		numBindings,
+		vertexShader,
+		&bindingsIndex,
+		&hash
+	);
+	for (vertexArray = head; vertexArray != NULL; vertexArray = vertexArray->next)
+	{
+		if (vertexArray->pixelShader == pixelShader)
+		{
+			stats->hits += 1;
+			return vertexArray;
+		}
+	}
+
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
+	/* First time we've seen this combination, record the layout */
+	vertexArray = (OpenGLVertexArray*) SDL_malloc(sizeof(OpenGLVertexArray));
+	SDL_memset(vertexArray, '\0', sizeof(OpenGLVertexArray));
+	vertexArray->pixelShader = pixelShader;
+	renderer->glGenVertexArrays(1, &vertexArray->handle);
+	BindVertexArray(renderer, vertexArray);
+
+	SDL_memset(attrUse, '\0', sizeof(attrUse));
+	for (i = 0; i < numBindings; i += 1)
+	{
+		vertexDeclaration = &bindings[i].vertexDeclaration;
+		for (j = 0; j < vertexDeclaration->elementCount; j += 1)
+		{
+			element = &vertexDeclaration->elements[j];
+			attribLoc = OPENGL_INTERNAL_GetAttribLocation(attrUse, element);
+			if (attribLoc == -1)
+			{
+				/* Stream not in use! */
+				continue;
+			}
+			renderer->glEnableVertexAttribArray(attribLoc);
+			renderer->glVertexAttribFormat(
+				attribLoc,
+				XNAToGL_VertexAttribSize[element->vertexElementFormat],
+				XNAToGL_VertexAttribType[element->vertexElementFormat],
+				XNAToGL_VertexAttribNormalized(element),
+				element->offset
+			);
+			renderer->glVertexAttribBinding(attribLoc, i);
+		}
+		renderer->glVertexBindingDivisor(i, bindings[i].instanceFrequency);
+	}
+	PipelineCacheStats_EndCreate(stats, createStart);
+
+	if (head == NULL)
+	{
+		PackedVertexBufferBindingsArray_Insert(
+			&renderer->vertexArrayCache,
+			bindings,
+			numBindings,
+			vertexShader,
+			vertexArray
+		);
+	}
+	else
+	{
+		/* Keep the head where it is, the cache entry points at it */
+		vertexArray->next = head->next;
+		head->next = vertexArray;
+	}
+	return vertexArray;
+}
+
+static void OPENGL_INTERNAL_DeleteVertexArrays(
+	OpenGLRenderer *renderer,
+	OpenGLVertexArray *vertexArray
+) {
+	OpenGLVertexArray *next;
+
+	while (vertexArray != NULL)
+	{
+		next = vertexArray->next;
+		if (vertexArray == renderer->currentVertexArray)
+		{
+			BindVertexArray(renderer, NULL);
+		}
+		renderer->glDeleteVertexArrays(1, &vertexArray->handle);
+		SDL_free(vertexArray);
+		vertexArray = next;
+	}
+}
+
+/* Attribute locations belong to the linked program, so every VAO built for
+ * a shader has to go when the shader does.
+ */
+static void OPENGL_INTERNAL_EvictVertexArrays(
+	OpenGLRenderer *renderer,
+	MOJOSHADER_glShader *shader
+) {
+	PackedVertexBufferBindingsArray *arr = &renderer->vertexArrayCache;
+	OpenGLVertexArray *head, *curr, *prev, *next;
+	int32_t i;
+
+	/* Reverse order, to minimize the damage of doing memmove a bunch */
+	for (i = arr->count - 1; i >= 0; i -= 1)
+	{
+		head = (OpenGLVertexArray*) arr->elements[i].value;
+		if (arr->elements[i].key.vertexShader != shader)
+		{
+			prev = NULL;
+			curr = head;
+			while (curr != NULL)
+			{
+				next = curr->next;
+				if (curr->pixelShader == shader)
+				{
+					if (prev == NULL)
+					{
+						head = next;
+					}
+					else
+					{
+						prev->next = next;
+					}
+					curr->next = NULL;
+					OPENGL_INTERNAL_DeleteVertexArrays(renderer, curr);
+				}
+				else
+				{
+					prev = curr;
+				}
+				curr = next;
+			}
+			arr->elements[i].value = head;
+			if (head != NULL)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			OPENGL_INTERNAL_DeleteVertexArrays(renderer, head);
+		}
+
+		SDL_memmove(
+			arr->elements + i,
+			arr->elements + i + 1,
+			sizeof(PackedVertexBufferBindingsMap) * (arr->count - i - 1)
+		);
+		arr->count -= 1;
+	}
+}
+
+/* Buffer names get recycled, so no VAO can keep believing it has a deleted
+ * buffer bound. Unbinding also lets GL actually free the old storage.
+ */
+static void OPENGL_INTERNAL_ForgetVertexArrayBuffer(
+	OpenGLRenderer *renderer,
+	GLuint handle
+) {
+	OpenGLVertexArray *prevVertexArray = renderer->currentVertexArray;
+	OpenGLVertexArray *vertexArray;
+	int32_t i, j;
+
+	for (i = 0; i < renderer->vertexArrayCache.count; i += 1)
+	{
+		vertexArray = (OpenGLVertexArray*) renderer->vertexArrayCache.elements[i].value;
+		for (; vertexArray != NULL; vertexArray = vertexArray->next)
+		{
+			for (j = 0; j < MAX_BOUND_VERTEX_BUFFERS; j += 1)
+			{
+				if (vertexArray->buffers[j] == handle)
+				{
+					BindVertexArray(renderer, vertexArray);
+					renderer->glBindVertexBuffer(j, 0, 0, 0);
+					vertexArray->buffers[j] = 0;
+				}
+			}
+		}
+	}
+	BindVertexArray(renderer, prevVertexArray);
+}
+
+/* Worker uploads finish on the GPU in their own time, so the main context
+ * has its command stream wait on them before anything that could read the
+ * results. A shared context also only picks up new buffer contents once the
+ * buffer is bound again, so every cached buffer binding gets thrown out.
+ */
+static void OPENGL_INTERNAL_SyncWorkers(OpenGLRenderer *renderer)
+{
+	OpenGLVertexArray *vertexArray;
+	int32_t generation, i, j;
+
+	if (renderer->workerCount == 0)
+	{
+		return;
+	}
+
+	/* Bumped after the fence is queued, so read it first */
+	generation = SDL_GetAtomicInt(&renderer->bufferGeneration);
+
+	if (SDL_GetAtomicInt(&renderer->workerFencesPending))
+	{
+		SDL_LockMutex(renderer->workersLock);
+		for (i = 0; i < renderer->workerFenceCount; i += 1)
+		{
+			renderer->glWaitSync(
+				renderer->workerFences[i],
+				0,
+				GL_TIMEOUT_IGNORED
+			);
+			renderer->glDeleteSync(renderer->workerFences[i]);
+		}
+		renderer->workerFenceCount = 0;
+		SDL_SetAtomicInt(&renderer->workerFencesPending, 0);
+		SDL_UnlockMutex(renderer->workersLock);
+	}
+
+	if (generation != renderer->bufferGenerationSeen)
+	{
+		renderer->bufferGenerationSeen = generation;
+		renderer->currentVertexBuffer = 0;
+		renderer->currentIndexBuffer = UINT32_MAX;
+		for (i = 0; i < renderer->numVertexAttributes; i += 1)
+		{
+			renderer->attributes[i].currentBuffer = UINT32_MAX;
+		}
+		for (i = 0; i < renderer->vertexArrayCache.count; i += 1)
+		{
+			vertexArray = (OpenGLVertexArray*) renderer->vertexArrayCache.elements[i].value;
+			for (; vertexArray != NULL; vertexArray = vertexArray->next)
+			{
+				for (j = 0; j < MAX_BOUND_VERTEX_BUFFERS; j += 1)
+				{
+					vertexArray->buffers[j] = 0;
+				}
+			}
+		}
+		renderer->ldBaseVertex = -1;
+	}
+}
+
 static void OPENGL_ApplyVertexBufferBindings(
 	FNA3D_Renderer *driverData,
 	FNA3D_VertexBufferBinding *bindings,
@@ -2457,31 +3876,77 @@ static void OPENGL_ApplyVertexBufferBindings(
 ) {
 	uint8_t *basePtr, *ptr;
 	uint8_t normalized;
-	int32_t i, j, k;
-	int32_t usage, index, attribLoc;
+	int32_t i, j;
+	int32_t attribLoc;
+	intptr_t offset;
 	uint8_t attrUse[MOJOSHADER_USAGE_TOTAL][16];
 	FNA3D_VertexElement *element;
 	FNA3D_VertexDeclaration *vertexDeclaration;
 	OpenGLVertexAttribute *attr;
+	OpenGLVertexArray *vertexArray;
 	OpenGLBuffer *buffer;
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	if (renderer->supports_ARB_draw_elements_base_vertex)
 	{
 		baseVertex = 0;
 	}
 
-	if (	bindingsUpdated ||
-		baseVertex != renderer->ldBaseVertex ||
-		renderer->effectApplied	)
+	if (	renderer->useVertexArrayCache &&
+		(	bindingsUpdated ||
+			baseVertex != renderer->ldBaseVertex ||
+			renderer->effectApplied	)	)
 	{
-		/* There's this weird case where you can have overlapping
-		 * vertex usage/index combinations. It seems like the first
-		 * attrib gets priority, so whenever a duplicate attribute
-		 * exists, give it the next available index. If that fails, we
-		 * have to crash :/
-		 * -flibit
+		/* Only a new layout or program needs a different VAO, after
+		 * that it's just the buffers that the VAO doesn't have yet.
 		 */
+		if (	bindingsUpdated ||
+			renderer->effectApplied ||
+			renderer->currentVertexArray == NULL	)
+		{
+			vertexArray = OPENGL_INTERNAL_FetchVertexArray(
+				renderer,
+				bindings,
+				numBindings
+			);
+			BindVertexArray(renderer, vertexArray);
+		}
+		vertexArray = renderer->currentVertexArray;
+
+		for (i = 0; i < numBindings; i += 1)
+		{
+			buffer = (OpenGLBuffer*) bindings[i].vertexBuffer;
+			vertexDeclaration = &bindings[i].vertexDeclaration;
+			offset = (
+				BufferRegionOffset(buffer) +
+				vertexDeclaration->vertexStride *
+				(bindings[i].vertexOffset + baseVertex)
+			);
+			if (	vertexArray->buffers[i] != buffer->handle ||
+				vertexArray->offsets[i] != offset ||
+				vertexArray->strides[i] != vertexDeclaration->vertexStride	)
+			{
+				renderer->glBindVertexBuffer(
+					i,
+					buffer->handle,
+					offset,
+					vertexDeclaration->vertexStride
+				);
+				vertexArray->buffers[i] = buffer->handle;
+				vertexArray->offsets[i] = offset;
+				vertexArray->strides[i] = vertexDeclaration->vertexStride;
+			}
+		}
+
+		renderer->ldBaseVertex = baseVertex;
+		renderer->effectApplied = 0;
+	}
+	else if (	bindingsUpdated ||
+			baseVertex != renderer->ldBaseVertex ||
+			renderer->effectApplied	)
+	{
 		SDL_memset(attrUse, '\0', sizeof(attrUse));
 		for (i = 0; i < numBindings; i += 1)
 		{
@@ -2489,36 +3954,16 @@ static void OPENGL_ApplyVertexBufferBindings(
 			BindVertexBuffer(renderer, buffer->handle);
 			vertexDeclaration = &bindings[i].vertexDeclaration;
 			basePtr = (uint8_t*) (size_t) (
+				BufferRegionOffset(buffer) +
 				vertexDeclaration->vertexStride *
 				(bindings[i].vertexOffset + baseVertex)
 			);
 			for (j = 0; j < vertexDeclaration->elementCount; j += 1)
 			{
 				element = &vertexDeclaration->elements[j];
-				usage = element->vertexElementUsage;
-				index = element->usageIndex;
-				if (attrUse[usage][index])
-				{
-					index = -1;
-					for (k = 0; k < 16; k += 1)
-					{
-						if (!attrUse[usage][k])
-						{
-							index = k;
-							break;
-						}
-					}
-					if (index < 0)
-					{
-						FNA3D_LogError(
-							"Vertex usage collision!"
-						);
-					}
-				}
-				attrUse[usage][index] = 1;
-				attribLoc = MOJOSHADER_glGetVertexAttribLocation(
-					VertexAttribUsage(usage),
-					index
+				attribLoc = OPENGL_INTERNAL_GetAttribLocation(
+					attrUse,
+					element
 				);
 				if (attribLoc == -1)
 				{
@@ -2586,6 +4031,9 @@ static void OPENGL_SetRenderTargets(
 	int32_t i;
 	GLuint handle;
 
+	/* Worker contexts may still be filling in the targets */
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	/* Bind the right framebuffer, if needed */
 	if (numRenderTargets <= 0)
 	{
@@ -3379,7 +4827,7 @@ static void OPENGL_ReadBackbuffer(
 	void* data,
 	int32_t dataLength
 ) {
-	GLuint prevReadBuffer, prevDrawBuffer;
+	GLuint prevReadBuffer;
 	int32_t pitch, row;
 	uint8_t *temp;
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
@@ -3387,65 +4835,22 @@ static void OPENGL_ReadBackbuffer(
 
 	prevReadBuffer = renderer->currentReadFramebuffer;
 
-	if (renderer->backbuffer->multiSampleCount > 0)
+	OPENGL_INTERNAL_BindBackbufferForReading(renderer);
+
+	if (OPENGL_INTERNAL_FlipForReading(renderer, x, y, w, h))
 	{
-		/* We have to resolve the renderbuffer to a texture first. */
-		prevDrawBuffer = renderer->currentDrawFramebuffer;
-
-		if (renderer->backbuffer->opengl.texture == 0)
-		{
-			renderer->glGenTextures(
-				1,
-				&renderer->backbuffer->opengl.texture
-			);
-			renderer->glBindTexture(
-				GL_TEXTURE_2D,
-				renderer->backbuffer->opengl.texture
-			);
-			renderer->glTexImage2D(
-				GL_TEXTURE_2D,
-				0,
-				GL_RGBA,
-				renderer->backbuffer->width,
-				renderer->backbuffer->height,
-				0,
-				GL_RGBA,
-				GL_UNSIGNED_BYTE,
-				NULL
-			);
-			renderer->glBindTexture(
-				renderer->textures[0]->target,
-				renderer->textures[0]->handle
-			);
-		}
-		BindFramebuffer(renderer, renderer->resolveFramebufferDraw);
-		renderer->glFramebufferTexture2D(
-			GL_FRAMEBUFFER,
-			GL_COLOR_ATTACHMENT0,
-			GL_TEXTURE_2D,
-			renderer->backbuffer->opengl.texture,
-			0
-		);
-		BindReadFramebuffer(renderer, renderer->backbuffer->opengl.handle);
-		renderer->glBlitFramebuffer(
-			0, 0, renderer->backbuffer->width, renderer->backbuffer->height,
-			0, 0, renderer->backbuffer->width, renderer->backbuffer->height,
-			GL_COLOR_BUFFER_BIT,
-			GL_LINEAR
-		);
-		/* Don't invalidate the backbuffer here! */
-		BindDrawFramebuffer(renderer, prevDrawBuffer);
-		BindReadFramebuffer(renderer, renderer->resolveFramebufferDraw);
-	}
-	else
-	{
-		BindReadFramebuffer(
-			renderer,
-			(renderer->backbuffer->type == BACKBUFFER_TYPE_OPENGL) ?
-				renderer->backbuffer->opengl.handle :
-				0
-		);
-	}
+		renderer->glReadPixels(
+			0,
+			0,
+			w,
+			h,
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			data
+		);
+		BindReadFramebuffer(renderer, prevReadBuffer);
+		return;
+	}
 
 	renderer->glReadPixels(
 		x,
@@ -3526,6 +4931,7 @@ static inline OpenGLTexture* OPENGL_INTERNAL_CreateTexture(
 	result->format = format;
 	result->next = NULL;
 	result->external = 0;
+	SDL_SetAtomicInt(&result->generation, 0);
 
 	BindTexture(renderer, result);
 	renderer->glTexParameteri(
@@ -3581,6 +4987,62 @@ static inline OpenGLTexture* OPENGL_INTERNAL_CreateTexture(
 	return result;
 }
 
+/* Immutable storage allocates the whole mip chain at once and can never be
+ * incomplete, so drivers get to skip validating it on every bind.
+ * Returns 0 if the levels still have to be allocated one by one.
+ */
+static inline uint8_t OPENGL_INTERNAL_AllocateTextureStorage(
+	OpenGLRenderer *renderer,
+	GLenum target,
+	FNA3D_SurfaceFormat format,
+	int32_t width,
+	int32_t height,
+	int32_t depth,
+	int32_t levelCount
+) {
+	GLenum glInternalFormat = XNAToGL_TextureInternalFormat[format];
+
+	if (!renderer->supports_ARB_texture_storage)
+	{
+		return 0;
+	}
+
+	/* Storage needs sized formats */
+	if (glInternalFormat == GL_SRGB_ALPHA_EXT)
+	{
+		glInternalFormat = GL_SRGB8_ALPHA8_EXT;
+	}
+	else if (glInternalFormat == GL_ALPHA)
+	{
+		/* ALPHA8 doesn't exist in Core, just do it the old way */
+		return 0;
+	}
+
+	if (target == GL_TEXTURE_3D)
+	{
+		renderer->glTexStorage3D(
+			target,
+			levelCount,
+			glInternalFormat,
+			width,
+			height,
+			depth
+		);
+	}
+	else
+	{
+		/* Cube maps get all six faces from this too */
+		renderer->glTexStorage2D(
+			target,
+			levelCount,
+			glInternalFormat,
+			width,
+			height
+		);
+	}
+	return 1;
+}
+
 static inline int32_t OPENGL_INTERNAL_Texture_GetPixelStoreAlignment(
 	FNA3D_SurfaceFormat format
 ) {
@@ -3605,10 +5067,27 @@ static FNA3D_Texture* OPENGL_CreateTexture2D(
 	GLenum glFormat, glInternalFormat, glType;
 	int32_t blockSize, levelWidth, levelHeight, i;
 	uint32_t requiredBytes;
+	OpenGLRenderer *worker;
+	FNA3D_Texture *workerResult;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			workerResult = OPENGL_CreateTexture2D(
+				(FNA3D_Renderer*) worker,
+				format,
+				width,
+				height,
+				levelCount,
+				isRenderTarget
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			return workerResult;
+		}
+
 		cmd.type = FNA3D_COMMAND_CREATETEXTURE2D;
 		cmd.createTexture2D.format = format;
 		cmd.createTexture2D.width = width;
@@ -3629,6 +5108,18 @@ static FNA3D_Texture* OPENGL_CreateTexture2D(
 	result->twod.width = width;
 	result->twod.height = height;
 
+	if (OPENGL_INTERNAL_AllocateTextureStorage(
+		renderer,
+		GL_TEXTURE_2D,
+		format,
+		width,
+		height,
+		1,
+		levelCount
+	)) {
+		return (FNA3D_Texture*) result;
+	}
+
 	glFormat = XNAToGL_TextureFormat[format];
 	glInternalFormat = XNAToGL_TextureInternalFormat[format];
 	if (glFormat == GL_COMPRESSED_TEXTURE_FORMATS)
@@ -3689,12 +5180,29 @@ static FNA3D_Texture* OPENGL_CreateTexture3D(
 	OpenGLTexture *result;
 	GLenum glFormat, glInternalFormat, glType;
 	int32_t i;
+	OpenGLRenderer *worker;
+	FNA3D_Texture *workerResult;
 	FNA3D_Command cmd;
 
 	SDL_assert(renderer->supports_3DTexture);
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			workerResult = OPENGL_CreateTexture3D(
+				(FNA3D_Renderer*) worker,
+				format,
+				width,
+				height,
+				depth,
+				levelCount
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			return workerResult;
+		}
+
 		cmd.type = FNA3D_COMMAND_CREATETEXTURE3D;
 		cmd.createTexture3D.format = format;
 		cmd.createTexture3D.width = width;
@@ -3712,6 +5220,18 @@ static FNA3D_Texture* OPENGL_CreateTexture3D(
 		levelCount
 	);
 
+	if (OPENGL_INTERNAL_AllocateTextureStorage(
+		renderer,
+		GL_TEXTURE_3D,
+		format,
+		width,
+		height,
+		depth,
+		levelCount
+	)) {
+		return (FNA3D_Texture*) result;
+	}
+
 	glFormat = XNAToGL_TextureFormat[format];
 	glInternalFormat = XNAToGL_TextureInternalFormat[format];
 	glType = XNAToGL_TextureDataType[format];
@@ -3745,10 +5265,26 @@ static FNA3D_Texture* OPENGL_CreateTextureCube(
 	GLenum glFormat, glInternalFormat;
 	int32_t blockSize, levelSize, i, l;
 	uint32_t requiredBytes;
+	OpenGLRenderer *worker;
+	FNA3D_Texture *workerResult;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			workerResult = OPENGL_CreateTextureCube(
+				(FNA3D_Renderer*) worker,
+				format,
+				size,
+				levelCount,
+				isRenderTarget
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			return workerResult;
+		}
+
 		cmd.type = FNA3D_COMMAND_CREATETEXTURECUBE;
 		cmd.createTextureCube.format = format;
 		cmd.createTextureCube.size = size;
@@ -3767,6 +5303,18 @@ static FNA3D_Texture* OPENGL_CreateTextureCube(
 
 	result->cube.size = size;
 
+	if (OPENGL_INTERNAL_AllocateTextureStorage(
+		renderer,
+		GL_TEXTURE_CUBE_MAP,
+		format,
+		size,
+		size,
+		1,
+		levelCount
+	)) {
+		return (FNA3D_Texture*) result;
+	}
+
 	glFormat = XNAToGL_TextureFormat[format];
 	glInternalFormat = XNAToGL_TextureInternalFormat[format];
 	if (glFormat == GL_COMPRESSED_TEXTURE_FORMATS)
@@ -3855,7 +5403,6 @@ static void OPENGL_AddDisposeTexture(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLTexture *glTexture = (OpenGLTexture*) texture;
-	OpenGLTexture *curr;
 
 	if (renderer->threadID == SDL_GetCurrentThreadID())
 	{
@@ -3863,9 +5410,149 @@ static void OPENGL_AddDisposeTexture(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeTexturesLock);
-		LinkedList_Add(renderer->disposeTextures, glTexture, curr);
-		SDL_UnlockMutex(renderer->disposeTexturesLock);
+		AtomicList_Push(renderer->disposeTextures, glTexture);
+	}
+}
+
+/* Streaming uploads copy into a persistently mapped GL_PIXEL_UNPACK_BUFFER
+ * ring instead of handing client memory to glTexSubImage, so the GPU pulls
+ * the data whenever it gets to it. The ring is split into segments; leaving
+ * a segment fences it and entering one waits on its fence from the last lap.
+ * Anything bigger than a segment just goes the old way.
+ */
+
+static void OPENGL_INTERNAL_CreateUploadBuffer(
+	OpenGLRenderer *renderer,
+	int32_t size
+) {
+	renderer->uploadBufferSize = size - (size % (UPLOAD_SEGMENTS * 16));
+	renderer->glGenBuffers(1, &renderer->uploadBuffer);
+	renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, renderer->uploadBuffer);
+	renderer->glBufferStorage(
+		GL_PIXEL_UNPACK_BUFFER,
+		renderer->uploadBufferSize,
+		NULL,
+		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+	);
+	renderer->uploadMapping = (uint8_t*) renderer->glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		renderer->uploadBufferSize,
+		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+	);
+	if (renderer->uploadMapping == NULL)
+	{
+		FNA3D_LogWarn("Failed to map upload buffer, uploads will not stream");
+		renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		renderer->glDeleteBuffers(1, &renderer->uploadBuffer);
+		renderer->uploadBuffer = 0;
+		return;
+	}
+	renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+static void OPENGL_INTERNAL_DestroyUploadBuffer(OpenGLRenderer *renderer)
+{
+	int32_t i;
+
+	for (i = 0; i < UPLOAD_SEGMENTS; i += 1)
+	{
+		if (renderer->uploadFences[i] != NULL)
+		{
+			renderer->glDeleteSync(renderer->uploadFences[i]);
+			renderer->uploadFences[i] = NULL;
+		}
+	}
+	renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, renderer->uploadBuffer);
+	renderer->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	renderer->glDeleteBuffers(1, &renderer->uploadBuffer);
+	renderer->uploadBuffer = 0;
+	renderer->uploadMapping = NULL;
+}
+
+static void* OPENGL_INTERNAL_StageUpload(
+	OpenGLRenderer *renderer,
+	void *data,
+	int32_t dataLength
+) {
+	int32_t segmentSize = renderer->uploadBufferSize / UPLOAD_SEGMENTS;
+	int32_t offset, segment;
+	GLsync fence;
+	GLenum waitResult;
+
+	if (renderer->uploadBuffer == 0 || dataLength > segmentSize)
+	{
+		return data;
+	}
+
+	/* Offsets have to be aligned to the pixel type, 16 covers all of them */
+	offset = (renderer->uploadOffset + 15) & ~15;
+	if (offset + dataLength > renderer->uploadBufferSize)
+	{
+		offset = 0;
+	}
+
+	/* Don't let one upload straddle two segments, only one fence is
+	 * going to cover it.
+	 */
+	segment = (offset + dataLength - 1) / segmentSize;
+	if (segment != offset / segmentSize)
+	{
+		offset = segment * segmentSize;
+	}
+
+	while (renderer->uploadSegment != segment)
+	{
+		/* Everything that read from the old segment is queued now... */
+		renderer->uploadFences[renderer->uploadSegment] = renderer->glFenceSync(
+			GL_SYNC_GPU_COMMANDS_COMPLETE,
+			0
+		);
+		renderer->uploadSegment = (
+			(renderer->uploadSegment + 1) % UPLOAD_SEGMENTS
+		);
+
+		/* ... and the GPU has to be done with the new one from last time */
+		fence = renderer->uploadFences[renderer->uploadSegment];
+		if (fence == NULL)
+		{
+			continue;
+		}
+		do
+		{
+			waitResult = renderer->glClientWaitSync(
+				fence,
+				GL_SYNC_FLUSH_COMMANDS_BIT,
+				1000000000 /* 1 second */
+			);
+		} while (waitResult == GL_TIMEOUT_EXPIRED);
+		if (waitResult == GL_WAIT_FAILED)
+		{
+			FNA3D_LogWarn("Upload fence wait failed, uploads will not stream");
+			renderer->glDeleteSync(fence);
+			renderer->uploadFences[renderer->uploadSegment] = NULL;
+			OPENGL_INTERNAL_DestroyUploadBuffer(renderer);
+			return data;
+		}
+		renderer->glDeleteSync(fence);
+		renderer->uploadFences[renderer->uploadSegment] = NULL;
+	}
+
+	SDL_memcpy(renderer->uploadMapping + offset, data, dataLength);
+	renderer->uploadOffset = offset + dataLength;
+
+	renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, renderer->uploadBuffer);
+	renderer->uploadBound = 1;
+	return (void*) (size_t) offset;
+}
+
+static inline void OPENGL_INTERNAL_EndUpload(OpenGLRenderer *renderer)
+{
+	if (renderer->uploadBound)
+	{
+		renderer->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		renderer->uploadBound = 0;
 	}
 }
 
@@ -3884,10 +5571,30 @@ static void OPENGL_SetTextureData2D(
 	OpenGLTexture *glTexture = (OpenGLTexture*) texture;
 	GLenum glFormat;
 	int32_t packSize;
+	OpenGLRenderer *worker;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			OPENGL_SetTextureData2D(
+				(FNA3D_Renderer*) worker,
+				texture,
+				x,
+				y,
+				w,
+				h,
+				level,
+				data,
+				dataLength
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			SDL_AddAtomicInt(&glTexture->generation, 1);
+			return;
+		}
+
 		cmd.type = FNA3D_COMMAND_SETTEXTUREDATA2D;
 		cmd.setTextureData2D.texture = texture;
 		cmd.setTextureData2D.x = x;
@@ -3901,7 +5608,10 @@ static void OPENGL_SetTextureData2D(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	BindTexture(renderer, glTexture);
+	data = OPENGL_INTERNAL_StageUpload(renderer, data, dataLength);
 
 	glFormat = XNAToGL_TextureFormat[glTexture->format];
 	if (glFormat == GL_COMPRESSED_TEXTURE_FORMATS)
@@ -3957,6 +5667,8 @@ static void OPENGL_SetTextureData2D(
 			);
 		}
 	}
+
+	OPENGL_INTERNAL_EndUpload(renderer);
 }
 
 static void OPENGL_SetTextureData3D(
@@ -3974,12 +5686,34 @@ static void OPENGL_SetTextureData3D(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLTexture *glTexture = (OpenGLTexture*) texture;
+	OpenGLRenderer *worker;
 	FNA3D_Command cmd;
 
 	SDL_assert(renderer->supports_3DTexture);
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			OPENGL_SetTextureData3D(
+				(FNA3D_Renderer*) worker,
+				texture,
+				x,
+				y,
+				z,
+				w,
+				h,
+				d,
+				level,
+				data,
+				dataLength
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			SDL_AddAtomicInt(&glTexture->generation, 1);
+			return;
+		}
+
 		cmd.type = FNA3D_COMMAND_SETTEXTUREDATA3D;
 		cmd.setTextureData3D.texture = texture;
 		cmd.setTextureData3D.x = x;
@@ -3995,7 +5729,10 @@ static void OPENGL_SetTextureData3D(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	BindTexture(renderer, glTexture);
+	data = OPENGL_INTERNAL_StageUpload(renderer, data, dataLength);
 
 	renderer->glTexSubImage3D(
 		GL_TEXTURE_3D,
@@ -4010,6 +5747,7 @@ static void OPENGL_SetTextureData3D(
 		XNAToGL_TextureDataType[glTexture->format],
 		data
 	);
+	OPENGL_INTERNAL_EndUpload(renderer);
 }
 
 static void OPENGL_SetTextureDataCube(
@@ -4027,10 +5765,31 @@ static void OPENGL_SetTextureDataCube(
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLTexture *glTexture = (OpenGLTexture*) texture;
 	GLenum glFormat;
+	OpenGLRenderer *worker;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			OPENGL_SetTextureDataCube(
+				(FNA3D_Renderer*) worker,
+				texture,
+				x,
+				y,
+				w,
+				h,
+				cubeMapFace,
+				level,
+				data,
+				dataLength
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			SDL_AddAtomicInt(&glTexture->generation, 1);
+			return;
+		}
+
 		cmd.type = FNA3D_COMMAND_SETTEXTUREDATACUBE;
 		cmd.setTextureDataCube.texture = texture;
 		cmd.setTextureDataCube.x = x;
@@ -4045,7 +5804,10 @@ static void OPENGL_SetTextureDataCube(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	BindTexture(renderer, glTexture);
+	data = OPENGL_INTERNAL_StageUpload(renderer, data, dataLength);
 
 	glFormat = XNAToGL_TextureFormat[glTexture->format];
 	if (glFormat == GL_COMPRESSED_TEXTURE_FORMATS)
@@ -4082,6 +5844,8 @@ static void OPENGL_SetTextureDataCube(
 			data
 		);
 	}
+
+	OPENGL_INTERNAL_EndUpload(renderer);
 }
 
 static void OPENGL_SetTextureDataYUV(
@@ -4097,7 +5861,10 @@ static void OPENGL_SetTextureDataYUV(
 	int32_t dataLength
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
-	uint8_t *dataPtr = (uint8_t*) data;
+	uint8_t *dataPtr;
+
+	/* Video frames are the worst case for synchronous uploads */
+	dataPtr = (uint8_t*) OPENGL_INTERNAL_StageUpload(renderer, data, dataLength);
 
 	renderer->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 	BindTexture(renderer, (OpenGLTexture*) y);
@@ -4139,6 +5906,82 @@ static void OPENGL_SetTextureDataYUV(
 		dataPtr
 	);
 	renderer->glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	OPENGL_INTERNAL_EndUpload(renderer);
+}
+
+/* Reads only the requested region of a 2D texture level. If a pixel pack
+ * buffer is bound, data is an offset into it. Returns 0 if the texture
+ * can't be read this way, in which case the whole level has to come back.
+ */
+static uint8_t OPENGL_INTERNAL_ReadTextureSubImage(
+	OpenGLRenderer *renderer,
+	OpenGLTexture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	void* data,
+	int32_t dataLength
+) {
+	GLuint prevReadBuffer, prevWriteBuffer;
+
+	if (renderer->supports_ARB_get_texture_sub_image)
+	{
+		renderer->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		renderer->glGetTextureSubImage(
+			texture->handle,
+			level,
+			x,
+			y,
+			0,
+			w,
+			h,
+			1,
+			XNAToGL_TextureFormat[texture->format],
+			XNAToGL_TextureDataType[texture->format],
+			dataLength,
+			data
+		);
+		renderer->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		return 1;
+	}
+
+	/* Other formats may not be color-renderable or readable as-is */
+	if (texture->format != FNA3D_SURFACEFORMAT_COLOR)
+	{
+		return 0;
+	}
+
+	prevReadBuffer = renderer->currentReadFramebuffer;
+	prevWriteBuffer = renderer->currentDrawFramebuffer;
+	BindFramebuffer(renderer, renderer->resolveFramebufferRead);
+	renderer->glFramebufferTexture2D(
+		GL_FRAMEBUFFER,
+		GL_COLOR_ATTACHMENT0,
+		GL_TEXTURE_2D,
+		texture->handle,
+		level
+	);
+	renderer->glReadPixels(
+		x,
+		y,
+		w,
+		h,
+		GL_RGBA,
+		GL_UNSIGNED_BYTE,
+		data
+	);
+	if (prevReadBuffer == prevWriteBuffer)
+	{
+		BindFramebuffer(renderer, prevReadBuffer);
+	}
+	else
+	{
+		BindReadFramebuffer(renderer, prevReadBuffer);
+		BindDrawFramebuffer(renderer, prevWriteBuffer);
+	}
+	return 1;
 }
 
 static void OPENGL_GetTextureData2D(
@@ -4179,6 +6022,8 @@ static void OPENGL_GetTextureData2D(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	if (level == 0 && OPENGL_INTERNAL_ReadTargetIfApplicable(
 		driverData,
 		texture,
@@ -4218,8 +6063,17 @@ static void OPENGL_GetTextureData2D(
 			data
 		);
 	}
-	else
-	{
+	else if (!OPENGL_INTERNAL_ReadTextureSubImage(
+		renderer,
+		glTexture,
+		x,
+		y,
+		w,
+		h,
+		level,
+		data,
+		dataLength
+	)) {
 		glFormatSize = Texture_GetFormatSize(glTexture->format);
 
 		/* Get the whole texture... */
@@ -4514,7 +6368,6 @@ static void OPENGL_AddDisposeRenderbuffer(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLRenderbuffer *buffer = (OpenGLRenderbuffer*) renderbuffer;
-	OpenGLRenderbuffer *curr;
 
 	if (renderer->threadID == SDL_GetCurrentThreadID())
 	{
@@ -4522,10 +6375,158 @@ static void OPENGL_AddDisposeRenderbuffer(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeRenderbuffersLock);
-		LinkedList_Add(renderer->disposeRenderbuffers, buffer, curr);
-		SDL_UnlockMutex(renderer->disposeRenderbuffersLock);
+		AtomicList_Push(renderer->disposeRenderbuffers, buffer);
+	}
+}
+
+/* Persistent Buffers */
+
+/* Dynamic buffers can hold BUFFER_REGIONS copies of their contents in one
+ * persistently mapped allocation. A discard moves on to the next copy rather
+ * than orphaning: the region being left is fenced and the region being
+ * entered is polled, which normally signaled frames ago. Discard and
+ * NoOverwrite writes are then plain memcpys, with no map or reallocation
+ * anywhere near the draw calls. If the GPU is still reading the region, writes
+ * to it go through glBufferSubData until the next discard, which the driver
+ * orders for us instead of stalling here.
+ *
+ * That's BUFFER_REGIONS times the memory, so big buffers orphan as before.
+ */
+
+/* Expects a freshly generated buffer bound to target. If the mapping fails
+ * the buffer is replaced with a new one, since storage can't be respecified.
+ */
+static uint8_t OPENGL_INTERNAL_CreateBufferRegions(
+	OpenGLRenderer *renderer,
+	OpenGLBuffer *buffer,
+	GLenum target
+) {
+	if (buffer->size > MAX_REGION_BUFFER_SIZE)
+	{
+		return 0;
+	}
+
+	renderer->glBufferStorage(
+		target,
+		buffer->size * BUFFER_REGIONS,
+		NULL,
+		(
+			GL_MAP_WRITE_BIT |
+			GL_MAP_PERSISTENT_BIT |
+			GL_MAP_COHERENT_BIT |
+			GL_DYNAMIC_STORAGE_BIT
+		)
+	);
+	buffer->mapping = (uint8_t*) renderer->glMapBufferRange(
+		target,
+		0,
+		buffer->size * BUFFER_REGIONS,
+		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+	);
+	if (buffer->mapping == NULL)
+	{
+		FNA3D_LogWarn("Failed to map dynamic buffer, disabling persistent buffers");
+		renderer->persistentBuffers = 0;
+		renderer->glDeleteBuffers(1, &buffer->handle);
+		renderer->glGenBuffers(1, &buffer->handle);
+		renderer->glBindBuffer(target, buffer->handle);
+		return 0;
 	}
+	return 1;
+}
+
+static void OPENGL_INTERNAL_DestroyBufferRegions(
+	OpenGLRenderer *renderer,
+	OpenGLBuffer *buffer
+) {
+	int32_t i;
+
+	/* Deleting the buffer unmaps it, only the fences are left */
+	for (i = 0; i < BUFFER_REGIONS; i += 1)
+	{
+		if (buffer->regionFences[i] != NULL)
+		{
+			renderer->glDeleteSync(buffer->regionFences[i]);
+		}
+	}
+}
+
+static void OPENGL_INTERNAL_SetBufferRegionData(
+	OpenGLRenderer *renderer,
+	OpenGLBuffer *buffer,
+	GLenum target,
+	int32_t offsetInBytes,
+	void* data,
+	int32_t dataLength,
+	FNA3D_SetDataOptions options
+) {
+	GLsync fence;
+	GLenum waitResult;
+
+	/* Replacing everything is as good as a discard */
+	if (	options == FNA3D_SETDATAOPTIONS_NONE &&
+		offsetInBytes == 0 &&
+		dataLength == buffer->size	)
+	{
+		options = FNA3D_SETDATAOPTIONS_DISCARD;
+	}
+
+	if (options == FNA3D_SETDATAOPTIONS_DISCARD)
+	{
+		/* A busy region kept its old fence, this one covers it too */
+		if (buffer->regionFences[buffer->region] != NULL)
+		{
+			renderer->glDeleteSync(buffer->regionFences[buffer->region]);
+		}
+		buffer->regionFences[buffer->region] = renderer->glFenceSync(
+			GL_SYNC_GPU_COMMANDS_COMPLETE,
+			0
+		);
+		buffer->region = (buffer->region + 1) % BUFFER_REGIONS;
+		buffer->regionBusy = 0;
+		fence = buffer->regionFences[buffer->region];
+		if (fence != NULL)
+		{
+			waitResult = renderer->glClientWaitSync(fence, 0, 0);
+			if (waitResult == GL_TIMEOUT_EXPIRED)
+			{
+				buffer->regionBusy = 1;
+			}
+			else
+			{
+				if (waitResult == GL_WAIT_FAILED)
+				{
+					FNA3D_LogWarn("Buffer fence wait failed, data may be overwritten");
+				}
+				renderer->glDeleteSync(fence);
+				buffer->regionFences[buffer->region] = NULL;
+			}
+		}
+
+		/* Attribute pointers include the region, force an update */
+		renderer->ldBaseVertex = -1;
+	}
+
+	if (options == FNA3D_SETDATAOPTIONS_NONE || buffer->regionBusy)
+	{
+		/* A partial write has to keep the rest of the region, and a
+		 * busy one can't stomp on draws in flight, so let the driver
+		 * order it for us.
+		 */
+		renderer->glBufferSubData(
+			target,
+			(GLintptr) (BufferRegionOffset(buffer) + offsetInBytes),
+			(GLsizeiptr) dataLength,
+			data
+		);
+		return;
+	}
+
+	SDL_memcpy(
+		buffer->mapping + BufferRegionOffset(buffer) + offsetInBytes,
+		data,
+		dataLength
+	);
 }
 
 /* Vertex Buffers */
@@ -4539,10 +6540,25 @@ static FNA3D_Buffer* OPENGL_GenVertexBuffer(
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *result = NULL;
 	GLuint handle;
+	OpenGLRenderer *worker;
+	FNA3D_Buffer *workerResult;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			workerResult = OPENGL_GenVertexBuffer(
+				(FNA3D_Renderer*) worker,
+				dynamic,
+				usage,
+				sizeInBytes
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			return workerResult;
+		}
+
 		cmd.type = FNA3D_COMMAND_GENVERTEXBUFFER;
 		cmd.genVertexBuffer.dynamic = dynamic;
 		cmd.genVertexBuffer.usage = usage;
@@ -4554,18 +6570,25 @@ static FNA3D_Buffer* OPENGL_GenVertexBuffer(
 	renderer->glGenBuffers(1, &handle);
 
 	result = (OpenGLBuffer*) SDL_malloc(sizeof(OpenGLBuffer));
+	SDL_memset(result, '\0', sizeof(OpenGLBuffer));
 	result->handle = handle;
 	result->size = (intptr_t) sizeInBytes;
 	result->dynamic = (dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW);
-	result->next = NULL;
 
 	BindVertexBuffer(renderer, handle);
-	renderer->glBufferData(
-		GL_ARRAY_BUFFER,
-		result->size,
-		NULL,
-		result->dynamic
-	);
+	if (	!dynamic ||
+		!renderer->persistentBuffers ||
+		!OPENGL_INTERNAL_CreateBufferRegions(renderer, result, GL_ARRAY_BUFFER)	)
+	{
+		/* The handle is new if the mapping failed */
+		BindVertexBuffer(renderer, result->handle);
+		renderer->glBufferData(
+			GL_ARRAY_BUFFER,
+			result->size,
+			NULL,
+			result->dynamic
+		);
+	}
 
 	return (FNA3D_Buffer*) result;
 }
@@ -4589,6 +6612,14 @@ static void OPENGL_INTERNAL_DestroyVertexBuffer(
 			renderer->attributes[i].currentBuffer = UINT32_MAX;
 		}
 	}
+	if (renderer->useVertexArrayCache)
+	{
+		OPENGL_INTERNAL_ForgetVertexArrayBuffer(renderer, buffer->handle);
+	}
+	if (buffer->mapping != NULL)
+	{
+		OPENGL_INTERNAL_DestroyBufferRegions(renderer, buffer);
+	}
 	renderer->glDeleteBuffers(1, &buffer->handle);
 
 	SDL_free(buffer);
@@ -4600,7 +6631,6 @@ static void OPENGL_AddDisposeVertexBuffer(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *glBuffer = (OpenGLBuffer*) buffer;
-	OpenGLBuffer *curr;
 
 	if (renderer->threadID == SDL_GetCurrentThreadID())
 	{
@@ -4608,9 +6638,7 @@ static void OPENGL_AddDisposeVertexBuffer(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeVertexBuffersLock);
-		LinkedList_Add(renderer->disposeVertexBuffers, glBuffer, curr);
-		SDL_UnlockMutex(renderer->disposeVertexBuffersLock);
+		AtomicList_Push(renderer->disposeVertexBuffers, glBuffer);
 	}
 }
 
@@ -4626,10 +6654,32 @@ static void OPENGL_SetVertexBufferData(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *glBuffer = (OpenGLBuffer*) buffer;
+	OpenGLRenderer *worker;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		/* Regions are tracked by the main context, don't race it */
+		worker = (glBuffer->mapping == NULL) ?
+			OPENGL_INTERNAL_GetWorker(renderer) :
+			NULL;
+		if (worker != NULL)
+		{
+			OPENGL_SetVertexBufferData(
+				(FNA3D_Renderer*) worker,
+				buffer,
+				offsetInBytes,
+				data,
+				elementCount,
+				elementSizeInBytes,
+				vertexStride,
+				options
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			SDL_AddAtomicInt(&renderer->bufferGeneration, 1);
+			return;
+		}
+
 		cmd.type = FNA3D_COMMAND_SETVERTEXBUFFERDATA;
 		cmd.setVertexBufferData.buffer = buffer;
 		cmd.setVertexBufferData.offsetInBytes = offsetInBytes;
@@ -4642,6 +6692,23 @@ static void OPENGL_SetVertexBufferData(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
+	if (glBuffer->mapping != NULL)
+	{
+		BindVertexBuffer(renderer, glBuffer->handle);
+		OPENGL_INTERNAL_SetBufferRegionData(
+			renderer,
+			glBuffer,
+			GL_ARRAY_BUFFER,
+			offsetInBytes,
+			data,
+			elementCount * vertexStride,
+			options
+		);
+		return;
+	}
+
 	BindVertexBuffer(renderer, glBuffer->handle);
 
 	/* FIXME: Staging buffer for elementSizeInBytes < vertexStride! */
@@ -4712,6 +6779,8 @@ static void OPENGL_GetVertexBufferData(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	dataBytes = (uint8_t*) data;
 	useStagingBuffer = elementSizeInBytes < vertexStride;
 	if (useStagingBuffer)
@@ -4727,7 +6796,7 @@ static void OPENGL_GetVertexBufferData(
 
 	renderer->glGetBufferSubData(
 		GL_ARRAY_BUFFER,
-		(GLintptr) offsetInBytes,
+		(GLintptr) (BufferRegionOffset(glBuffer) + offsetInBytes),
 		(GLsizeiptr) (elementCount * vertexStride),
 		cpy
 	);
@@ -4757,10 +6826,25 @@ static FNA3D_Buffer* OPENGL_GenIndexBuffer(
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *result = NULL;
 	GLuint handle;
+	OpenGLRenderer *worker;
+	FNA3D_Buffer *workerResult;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = OPENGL_INTERNAL_GetWorker(renderer);
+		if (worker != NULL)
+		{
+			workerResult = OPENGL_GenIndexBuffer(
+				(FNA3D_Renderer*) worker,
+				dynamic,
+				usage,
+				sizeInBytes
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			return workerResult;
+		}
+
 		cmd.type = FNA3D_COMMAND_GENINDEXBUFFER;
 		cmd.genIndexBuffer.dynamic = dynamic;
 		cmd.genIndexBuffer.usage = usage;
@@ -4772,18 +6856,25 @@ static FNA3D_Buffer* OPENGL_GenIndexBuffer(
 	renderer->glGenBuffers(1, &handle);
 
 	result = (OpenGLBuffer*) SDL_malloc(sizeof(OpenGLBuffer));
+	SDL_memset(result, '\0', sizeof(OpenGLBuffer));
 	result->handle = handle;
 	result->size = (intptr_t) sizeInBytes;
 	result->dynamic = (dynamic ? GL_STREAM_DRAW : GL_STATIC_DRAW);
-	result->next = NULL;
 
 	BindIndexBuffer(renderer, handle);
-	renderer->glBufferData(
-		GL_ELEMENT_ARRAY_BUFFER,
-		result->size,
-		NULL,
-		result->dynamic
-	);
+	if (	!dynamic ||
+		!renderer->persistentBuffers ||
+		!OPENGL_INTERNAL_CreateBufferRegions(renderer, result, GL_ELEMENT_ARRAY_BUFFER)	)
+	{
+		/* The handle is new if the mapping failed */
+		BindIndexBuffer(renderer, result->handle);
+		renderer->glBufferData(
+			GL_ELEMENT_ARRAY_BUFFER,
+			result->size,
+			NULL,
+			result->dynamic
+		);
+	}
 
 	return (FNA3D_Buffer*) result;
 }
@@ -4797,6 +6888,10 @@ static void OPENGL_INTERNAL_DestroyIndexBuffer(
 		renderer->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 		renderer->currentIndexBuffer = 0;
 	}
+	if (buffer->mapping != NULL)
+	{
+		OPENGL_INTERNAL_DestroyBufferRegions(renderer, buffer);
+	}
 	renderer->glDeleteBuffers(1, &buffer->handle);
 	SDL_free(buffer);
 }
@@ -4807,7 +6902,6 @@ static void OPENGL_AddDisposeIndexBuffer(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *glBuffer = (OpenGLBuffer*) buffer;
-	OpenGLBuffer *curr;
 
 	if (renderer->threadID == SDL_GetCurrentThreadID())
 	{
@@ -4815,9 +6909,7 @@ static void OPENGL_AddDisposeIndexBuffer(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeIndexBuffersLock);
-		LinkedList_Add(renderer->disposeIndexBuffers, glBuffer, curr);
-		SDL_UnlockMutex(renderer->disposeIndexBuffersLock);
+		AtomicList_Push(renderer->disposeIndexBuffers, glBuffer);
 	}
 }
 
@@ -4831,10 +6923,29 @@ static void OPENGL_SetIndexBufferData(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLBuffer *glBuffer = (OpenGLBuffer*) buffer;
+	OpenGLRenderer *worker;
 	FNA3D_Command cmd;
 
 	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
+		worker = (glBuffer->mapping == NULL) ?
+			OPENGL_INTERNAL_GetWorker(renderer) :
+			NULL;
+		if (worker != NULL)
+		{
+			OPENGL_SetIndexBufferData(
+				(FNA3D_Renderer*) worker,
+				buffer,
+				offsetInBytes,
+				data,
+				dataLength,
+				options
+			);
+			OPENGL_INTERNAL_FinishWorker(renderer, worker);
+			SDL_AddAtomicInt(&renderer->bufferGeneration, 1);
+			return;
+		}
+
 		cmd.type = FNA3D_COMMAND_SETINDEXBUFFERDATA;
 		cmd.setIndexBufferData.buffer = buffer;
 		cmd.setIndexBufferData.offsetInBytes = offsetInBytes;
@@ -4845,6 +6956,23 @@ static void OPENGL_SetIndexBufferData(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
+	if (glBuffer->mapping != NULL)
+	{
+		BindIndexBuffer(renderer, glBuffer->handle);
+		OPENGL_INTERNAL_SetBufferRegionData(
+			renderer,
+			glBuffer,
+			GL_ELEMENT_ARRAY_BUFFER,
+			offsetInBytes,
+			data,
+			dataLength,
+			options
+		);
+		return;
+	}
+
 	BindIndexBuffer(renderer, glBuffer->handle);
 
 	if (	options == FNA3D_SETDATAOPTIONS_NOOVERWRITE &&
@@ -4906,11 +7034,13 @@ static void OPENGL_GetIndexBufferData(
 		return;
 	}
 
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
 	BindIndexBuffer(renderer, glBuffer->handle);
 
 	renderer->glGetBufferSubData(
 		GL_ELEMENT_ARRAY_BUFFER,
-		(GLintptr) offsetInBytes,
+		(GLintptr) (BufferRegionOffset(glBuffer) + offsetInBytes),
 		(GLsizeiptr) dataLength,
 		data
 	);
@@ -4943,6 +7073,13 @@ static void MOJOSHADERCALL OPENGL_INTERNAL_DeleteShader(
 	void *shader
 ) {
 	MOJOSHADER_glShader *glShader = (MOJOSHADER_glShader*) shader;
+	const MOJOSHADER_parseData *pd = MOJOSHADER_glGetShaderParseData(glShader);
+	OpenGLRenderer *renderer = (OpenGLRenderer*) pd->malloc_data;
+
+	if (renderer->useVertexArrayCache)
+	{
+		OPENGL_INTERNAL_EvictVertexArrays(renderer, glShader);
+	}
 	MOJOSHADER_glDeleteShader(glShader);
 }
 
@@ -5107,7 +7244,6 @@ static void OPENGL_AddDisposeEffect(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLEffect *fnaEffect = (OpenGLEffect*) effect;
-	OpenGLEffect *curr;
 
 	if (renderer->threadID == SDL_GetCurrentThreadID())
 	{
@@ -5115,9 +7251,7 @@ static void OPENGL_AddDisposeEffect(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeEffectsLock);
-		LinkedList_Add(renderer->disposeEffects, fnaEffect, curr);
-		SDL_UnlockMutex(renderer->disposeEffectsLock);
+		AtomicList_Push(renderer->disposeEffects, fnaEffect);
 	}
 }
 
@@ -5208,6 +7342,13 @@ static void OPENGL_EndPassRestore(
 	renderer->effectApplied = 1;
 }
 
+static MOJOSHADER_effect* OPENGL_GetEffectData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	return ((OpenGLEffect*) effect)->effect;
+}
+
 /* Queries */
 
 static FNA3D_Query* OPENGL_CreateQuery(FNA3D_Renderer *driverData)
@@ -5240,7 +7381,6 @@ static void OPENGL_AddDisposeQuery(
 ) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
 	OpenGLQuery *glQuery = (OpenGLQuery*) query;
-	OpenGLQuery *curr;
 
 	SDL_assert(renderer->supports_ARB_occlusion_query);
 
@@ -5250,9 +7390,7 @@ static void OPENGL_AddDisposeQuery(
 	}
 	else
 	{
-		SDL_LockMutex(renderer->disposeQueriesLock);
-		LinkedList_Add(renderer->disposeQueries, glQuery, curr);
-		SDL_UnlockMutex(renderer->disposeQueriesLock);
+		AtomicList_Push(renderer->disposeQueries, glQuery);
 	}
 }
 
@@ -5366,110 +7504,442 @@ static void OPENGL_GetMaxTextureSlots(
 	*vertexTextures = renderer->numVertexTextureSlots;
 }
 
-static int32_t OPENGL_GetMaxMultiSampleCount(
+static int32_t OPENGL_GetMaxMultiSampleCount(
+	FNA3D_Renderer *driverData,
+	FNA3D_SurfaceFormat format,
+	int32_t multiSampleCount
+) {
+	int32_t maxSamples;
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+
+	if (renderer->supports_ARB_internalformat_query)
+	{
+		maxSamples = renderer->maxMultiSampleCountFormat[format];
+	}
+	else
+	{
+		/* This number isn't very good, but it's all we have... */
+		maxSamples = renderer->maxMultiSampleCount;
+	}
+	if (renderer->windowSampleCount > 0)
+	{
+		/* Desperate attempt to align multisample count with the window
+		 * sample count, otherwise glBlitFramebuffer will return
+		 * GL_INVALID_OPERATION
+		 */
+		maxSamples = SDL_min(maxSamples, renderer->windowSampleCount);
+	}
+	return SDL_min(maxSamples, multiSampleCount);
+}
+
+/* Debugging */
+
+static void OPENGL_SetStringMarker(FNA3D_Renderer *driverData, const char *text)
+{
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	if (renderer->supports_GREMEDY_string_marker)
+	{
+		renderer->glStringMarkerGREMEDY(SDL_strlen(text), text);
+	}
+}
+
+static void OPENGL_SetTextureName(FNA3D_Renderer* driverData, FNA3D_Texture* texture, const char* text)
+{
+	/* No OpenGL API for this that I'm aware of -kg */
+	return;
+}
+
+static const char *debugSourceStr[] = {
+	"GL_DEBUG_SOURCE_API",
+	"GL_DEBUG_SOURCE_WINDOW_SYSTEM",
+	"GL_DEBUG_SOURCE_SHADER_COMPILER",
+	"GL_DEBUG_SOURCE_THIRD_PARTY",
+	"GL_DEBUG_SOURCE_APPLICATION",
+	"GL_DEBUG_SOURCE_OTHER"
+};
+static const char *debugTypeStr[] = {
+	"GL_DEBUG_TYPE_ERROR",
+	"GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR",
+	"GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR",
+	"GL_DEBUG_TYPE_PORTABILITY",
+	"GL_DEBUG_TYPE_PERFORMANCE",
+	"GL_DEBUG_TYPE_OTHER"
+};
+/* Debug severity values are disjointed */
+static inline const char *GetSeverityString(GLenum severity)
+{
+	switch (severity)
+	{
+	case GL_DEBUG_SEVERITY_HIGH: return "GL_DEBUG_SEVERITY_HIGH";
+	case GL_DEBUG_SEVERITY_MEDIUM: return "GL_DEBUG_SEVERITY_MEDIUM";
+	case GL_DEBUG_SEVERITY_LOW: return "GL_DEBUG_SEVERITY_LOW";
+	case GL_DEBUG_SEVERITY_NOTIFICATION: return "GL_DEBUG_SEVERITY_NOTIFICATION";
+	default:
+		return "FNA3D_UNKNOWN_SEVERITY";
+	}
+}
+
+static void GLAPIENTRY DebugCall(
+	GLenum source,
+	GLenum type,
+	GLuint id,
+	GLenum severity,
+	GLsizei length,
+	const GLchar *message,
+	const void *userParam
+) {
+	if (type == GL_DEBUG_TYPE_ERROR)
+	{
+		FNA3D_LogError(
+			"%s\n\tSource: %s\n\tType: %s\n\tSeverity: %s",
+			message,
+			debugSourceStr[source - GL_DEBUG_SOURCE_API],
+			debugTypeStr[type - GL_DEBUG_TYPE_ERROR],
+			GetSeverityString(severity)
+		);
+	}
+	else
+	{
+		FNA3D_LogWarn(
+			"%s\n\tSource: %s\n\tType: %s\n\tSeverity: %s",
+			message,
+			debugSourceStr[source - GL_DEBUG_SOURCE_API],
+			debugTypeStr[type - GL_DEBUG_TYPE_ERROR],
+			GetSeverityString(severity)
+		);
+	}
+}
+
+/* Pipeline Cache Statistics */
+
+static void OPENGL_GetPipelineCacheStats(
+	FNA3D_Renderer *driverData,
+	FNA3D_PipelineCacheStatsEXT *stats
+) {
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT],
+		renderer->samplerStateCache.count,
+		renderer->samplerStateCache.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT],
+		renderer->vertexArrayCache.count,
+		renderer->vertexArrayCache.capacity
+	);
+
+	/* Everything else is applied directly, those counters stay zeroed */
+	SDL_memcpy(
+		stats->caches,
+		renderer->cacheStats,
+		sizeof(renderer->cacheStats)
+	);
+}
+
+/* Backbuffer Capture */
+
+static void OPENGL_SetBackbufferCapture(
+	FNA3D_Renderer *driverData,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+) {
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+
+	/* The PBOs are read back from here, so no command forwarding */
+	SDL_assert(renderer->threadID == SDL_GetCurrentThreadID());
+
+	if (callback != NULL && !renderer->supports_NonES3)
+	{
+		FNA3D_LogError(
+			"Backbuffer capture requires glGetBufferSubData!"
+		);
+		return;
+	}
+
+	/* The ring layout depends on the frame count, so start over */
+	OPENGL_INTERNAL_FlushCaptureFrames(renderer);
+
+	renderer->captureCallback = callback;
+	renderer->captureUserdata = userdata;
+	renderer->captureFrameCount = frameCount;
+}
+
+/* Asynchronous Readback */
+
+typedef struct OpenGLReadback /* Cast from FNA3D_ReadbackEXT* */
+{
+	uint8_t *data;
+	int32_t dataLength;
+	GLuint pbo;	/* 0 if data already holds the result */
+	GLsync fence;
+} OpenGLReadback;
+
+static FNA3D_ReadbackEXT* OPENGL_GetTextureDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+) {
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	OpenGLTexture *glTexture = (OpenGLTexture*) texture;
+	OpenGLReadback *readback;
+	uint8_t queued;
+	FNA3D_Command cmd;
+
+	if (renderer->threadID != SDL_GetCurrentThreadID())
+	{
+		cmd.type = FNA3D_COMMAND_GETTEXTUREDATAASYNC;
+		cmd.getTextureDataAsync.texture = texture;
+		cmd.getTextureDataAsync.x = x;
+		cmd.getTextureDataAsync.y = y;
+		cmd.getTextureDataAsync.w = w;
+		cmd.getTextureDataAsync.h = h;
+		cmd.getTextureDataAsync.level = level;
+		cmd.getTextureDataAsync.dataLength = dataLength;
+		ForceToMainThread(renderer, &cmd);
+		return cmd.getTextureDataAsync.retval;
+	}
+
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
+	readback = (OpenGLReadback*) SDL_malloc(sizeof(OpenGLReadback));
+	readback->data = NULL;
+	readback->dataLength = dataLength;
+	readback->pbo = 0;
+	readback->fence = NULL;
+
+	/* Queue the copy into a pack buffer and fence it. The CPU only
+	 * touches the result when the readback is waited on.
+	 */
+	if (	renderer->supports_NonES3 &&
+		renderer->supports_ARB_sync &&
+		XNAToGL_TextureFormat[glTexture->format] != GL_COMPRESSED_TEXTURE_FORMATS	)
+	{
+		renderer->glGenBuffers(1, &readback->pbo);
+		renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pbo);
+		renderer->glBufferData(
+			GL_PIXEL_PACK_BUFFER,
+			(GLsizeiptr) dataLength,
+			NULL,
+			GL_STREAM_READ
+		);
+		if (	x == 0 &&
+			y == 0 &&
+			w == (glTexture->twod.width >> level) &&
+			h == (glTexture->twod.height >> level)	)
+		{
+			/* Rows are tightly packed, same as the sub-image path */
+			BindTexture(renderer, glTexture);
+			renderer->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			renderer->glGetTexImage(
+				GL_TEXTURE_2D,
+				level,
+				XNAToGL_TextureFormat[glTexture->format],
+				XNAToGL_TextureDataType[glTexture->format],
+				NULL
+			);
+			renderer->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			queued = 1;
+		}
+		else
+		{
+			queued = OPENGL_INTERNAL_ReadTextureSubImage(
+				renderer,
+				glTexture,
+				x,
+				y,
+				w,
+				h,
+				level,
+				NULL,
+				dataLength
+			);
+		}
+		renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (queued)
+		{
+			readback->fence = renderer->glFenceSync(
+				GL_SYNC_GPU_COMMANDS_COMPLETE,
+				0
+			);
+			return (FNA3D_ReadbackEXT*) readback;
+		}
+		renderer->glDeleteBuffers(1, &readback->pbo);
+		readback->pbo = 0;
+	}
+
+	/* Otherwise read it now, the readback is already complete */
+	readback->data = (uint8_t*) SDL_malloc(dataLength);
+	OPENGL_GetTextureData2D(
+		driverData,
+		texture,
+		x,
+		y,
+		w,
+		h,
+		level,
+		readback->data,
+		dataLength
+	);
+	return (FNA3D_ReadbackEXT*) readback;
+}
+
+static FNA3D_ReadbackEXT* OPENGL_GetBufferDataAsync(
 	FNA3D_Renderer *driverData,
-	FNA3D_SurfaceFormat format,
-	int32_t multiSampleCount
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
 ) {
-	int32_t maxSamples;
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	OpenGLBuffer *glBuffer = (OpenGLBuffer*) buffer;
+	OpenGLReadback *readback;
+	FNA3D_Command cmd;
 
-	if (renderer->supports_ARB_internalformat_query)
-	{
-		maxSamples = renderer->maxMultiSampleCountFormat[format];
-	}
-	else
+	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
-		/* This number isn't very good, but it's all we have... */
-		maxSamples = renderer->maxMultiSampleCount;
+		cmd.type = FNA3D_COMMAND_GETBUFFERDATAASYNC;
+		cmd.getBufferDataAsync.buffer = buffer;
+		cmd.getBufferDataAsync.offsetInBytes = offsetInBytes;
+		cmd.getBufferDataAsync.dataLength = dataLength;
+		ForceToMainThread(renderer, &cmd);
+		return cmd.getBufferDataAsync.retval;
 	}
-	if (renderer->windowSampleCount > 0)
+
+	OPENGL_INTERNAL_SyncWorkers(renderer);
+
+	readback = (OpenGLReadback*) SDL_malloc(sizeof(OpenGLReadback));
+	readback->data = NULL;
+	readback->dataLength = dataLength;
+	readback->pbo = 0;
+	readback->fence = NULL;
+
+	/* Same as textures, but the copy is buffer to buffer. The copy
+	 * targets leave the vertex and index bindings alone.
+	 */
+	if (	renderer->supports_NonES3 &&
+		renderer->supports_ARB_sync &&
+		renderer->supports_ARB_copy_buffer	)
 	{
-		/* Desperate attempt to align multisample count with the window
-		 * sample count, otherwise glBlitFramebuffer will return
-		 * GL_INVALID_OPERATION
-		 */
-		maxSamples = SDL_min(maxSamples, renderer->windowSampleCount);
+		renderer->glGenBuffers(1, &readback->pbo);
+		renderer->glBindBuffer(GL_COPY_WRITE_BUFFER, readback->pbo);
+		renderer->glBufferData(
+			GL_COPY_WRITE_BUFFER,
+			(GLsizeiptr) dataLength,
+			NULL,
+			GL_STREAM_READ
+		);
+		renderer->glBindBuffer(GL_COPY_READ_BUFFER, glBuffer->handle);
+		renderer->glCopyBufferSubData(
+			GL_COPY_READ_BUFFER,
+			GL_COPY_WRITE_BUFFER,
+			(GLintptr) (BufferRegionOffset(glBuffer) + offsetInBytes),
+			0,
+			(GLsizeiptr) dataLength
+		);
+		renderer->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		renderer->glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		readback->fence = renderer->glFenceSync(
+			GL_SYNC_GPU_COMMANDS_COMPLETE,
+			0
+		);
+		return (FNA3D_ReadbackEXT*) readback;
 	}
-	return SDL_min(maxSamples, multiSampleCount);
-}
 
-/* Debugging */
+	/* Otherwise read it now. GL buffers are untyped, so read it as
+	 * tightly packed bytes.
+	 */
+	readback->data = (uint8_t*) SDL_malloc(dataLength);
+	OPENGL_GetVertexBufferData(
+		driverData,
+		buffer,
+		offsetInBytes,
+		readback->data,
+		dataLength,
+		1,
+		1
+	);
+	return (FNA3D_ReadbackEXT*) readback;
+}
 
-static void OPENGL_SetStringMarker(FNA3D_Renderer *driverData, const char *text)
-{
+static uint8_t OPENGL_PollReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback
+) {
 	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
-	if (renderer->supports_GREMEDY_string_marker)
+	OpenGLReadback *r = (OpenGLReadback*) readback;
+	FNA3D_Command cmd;
+
+	if (r->pbo == 0)
 	{
-		renderer->glStringMarkerGREMEDY(SDL_strlen(text), text);
+		return 1;
 	}
-}
-
-static void OPENGL_SetTextureName(FNA3D_Renderer* driverData, FNA3D_Texture* texture, const char* text)
-{
-	/* No OpenGL API for this that I'm aware of -kg */
-	return;
-}
 
-static const char *debugSourceStr[] = {
-	"GL_DEBUG_SOURCE_API",
-	"GL_DEBUG_SOURCE_WINDOW_SYSTEM",
-	"GL_DEBUG_SOURCE_SHADER_COMPILER",
-	"GL_DEBUG_SOURCE_THIRD_PARTY",
-	"GL_DEBUG_SOURCE_APPLICATION",
-	"GL_DEBUG_SOURCE_OTHER"
-};
-static const char *debugTypeStr[] = {
-	"GL_DEBUG_TYPE_ERROR",
-	"GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR",
-	"GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR",
-	"GL_DEBUG_TYPE_PORTABILITY",
-	"GL_DEBUG_TYPE_PERFORMANCE",
-	"GL_DEBUG_TYPE_OTHER"
-};
-/* Debug severity values are disjointed */
-static inline const char *GetSeverityString(GLenum severity)
-{
-	switch (severity)
+	if (renderer->threadID != SDL_GetCurrentThreadID())
 	{
-	case GL_DEBUG_SEVERITY_HIGH: return "GL_DEBUG_SEVERITY_HIGH";
-	case GL_DEBUG_SEVERITY_MEDIUM: return "GL_DEBUG_SEVERITY_MEDIUM";
-	case GL_DEBUG_SEVERITY_LOW: return "GL_DEBUG_SEVERITY_LOW";
-	case GL_DEBUG_SEVERITY_NOTIFICATION: return "GL_DEBUG_SEVERITY_NOTIFICATION";
-	default:
-		return "FNA3D_UNKNOWN_SEVERITY";
+		cmd.type = FNA3D_COMMAND_POLLREADBACK;
+		cmd.pollReadback.readback = readback;
+		ForceToMainThread(renderer, &cmd);
+		return cmd.pollReadback.retval;
 	}
+
+	/* Flush, or a poll loop would never see the fence signal */
+	return renderer->glClientWaitSync(
+		r->fence,
+		GL_SYNC_FLUSH_COMMANDS_BIT,
+		0
+	) != GL_TIMEOUT_EXPIRED;
 }
 
-static void GLAPIENTRY DebugCall(
-	GLenum source,
-	GLenum type,
-	GLuint id,
-	GLenum severity,
-	GLsizei length,
-	const GLchar *message,
-	const void *userParam
+static void OPENGL_WaitReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
 ) {
-	if (type == GL_DEBUG_TYPE_ERROR)
+	OpenGLRenderer *renderer = (OpenGLRenderer*) driverData;
+	OpenGLReadback *r = (OpenGLReadback*) readback;
+	FNA3D_Command cmd;
+
+	if (r->pbo != 0)
 	{
-		FNA3D_LogError(
-			"%s\n\tSource: %s\n\tType: %s\n\tSeverity: %s",
-			message,
-			debugSourceStr[source - GL_DEBUG_SOURCE_API],
-			debugTypeStr[type - GL_DEBUG_TYPE_ERROR],
-			GetSeverityString(severity)
-		);
+		if (renderer->threadID != SDL_GetCurrentThreadID())
+		{
+			cmd.type = FNA3D_COMMAND_WAITREADBACK;
+			cmd.waitReadback.readback = readback;
+			cmd.waitReadback.data = data;
+			cmd.waitReadback.dataLength = dataLength;
+			ForceToMainThread(renderer, &cmd);
+			return;
+		}
+
+		/* If the copy isn't done yet, this is where we stall */
+		if (data != NULL)
+		{
+			renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, r->pbo);
+			renderer->glGetBufferSubData(
+				GL_PIXEL_PACK_BUFFER,
+				0,
+				(GLsizeiptr) SDL_min(dataLength, r->dataLength),
+				data
+			);
+			renderer->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		}
+		renderer->glDeleteSync(r->fence);
+		renderer->glDeleteBuffers(1, &r->pbo);
 	}
-	else
+	else if (data != NULL)
 	{
-		FNA3D_LogWarn(
-			"%s\n\tSource: %s\n\tType: %s\n\tSeverity: %s",
-			message,
-			debugSourceStr[source - GL_DEBUG_SOURCE_API],
-			debugTypeStr[type - GL_DEBUG_TYPE_ERROR],
-			GetSeverityString(severity)
-		);
+		SDL_memcpy(data, r->data, SDL_min(dataLength, r->dataLength));
 	}
+	SDL_free(r->data);
+	SDL_free(r);
 }
 
 /* External Interop */
@@ -5735,10 +8205,224 @@ static inline void LoadEntryPoints(
 	}
 }
 
+/* Program Binary Cache */
+
+/* MojoShader links its own programs, so GLGetProcAddress gives it this
+ * glLinkProgram instead.
+ */
+static uint64_t HashProgramCacheString(
+	uint64_t hash,
+	const char *str,
+	size_t len
+) {
+	size_t i;
+
+	/* FNV-1a */
+	for (i = 0; i < len; i += 1)
+	{
+		hash ^= (uint8_t) str[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static void OPENGL_INTERNAL_RegisterProgramCache(OpenGLRenderer *renderer)
+{
+	SDL_LockSpinlock(&programCacheLock);
+	renderer->programCacheNext = programCacheRenderers;
+	programCacheRenderers = renderer;
+	SDL_UnlockSpinlock(&programCacheLock);
+}
+
+static void OPENGL_INTERNAL_UnregisterProgramCache(OpenGLRenderer *renderer)
+{
+	OpenGLRenderer **curr;
+
+	SDL_LockSpinlock(&programCacheLock);
+	for (curr = &programCacheRenderers; *curr != NULL; curr = &(*curr)->programCacheNext)
+	{
+		if (*curr == renderer)
+		{
+			*curr = renderer->programCacheNext;
+			break;
+		}
+	}
+	SDL_UnlockSpinlock(&programCacheLock);
+}
+
+static OpenGLRenderer* OPENGL_INTERNAL_FetchProgramCache(void)
+{
+	SDL_GLContext context = SDL_GL_GetCurrentContext();
+	OpenGLRenderer *result;
+
+	SDL_LockSpinlock(&programCacheLock);
+	for (result = programCacheRenderers; result != NULL; result = result->programCacheNext)
+	{
+		if (result->context == context)
+		{
+			break;
+		}
+	}
+	SDL_UnlockSpinlock(&programCacheLock);
+	return result;
+}
+
+static void GLAPIENTRY OPENGL_INTERNAL_LinkProgram(GLuint program)
+{
+	OpenGLRenderer *renderer = OPENGL_INTERNAL_FetchProgramCache();
+	GLuint shaders[2];
+	GLsizei numShaders, i;
+	GLint length, status = 0;
+	GLenum binaryFormat;
+	uint32_t packedFormat;
+	uint64_t key = 0;
+	char *source;
+	char path[1024];
+	char tempPath[1024 + 32];
+	uint8_t *data;
+	size_t dataLength;
+	SDL_IOStream *file;
+	uint8_t written = 0;
+	glfntype_glLinkProgram linkProgram;
+
+	if (renderer == NULL)
+	{
+		/* Not one of ours, just link it */
+		linkProgram = (glfntype_glLinkProgram) SDL_GL_GetProcAddress(
+			"glLinkProgram"
+		);
+		linkProgram(program);
+		return;
+	}
+
+	renderer->glGetAttachedShaders(program, 2, &numShaders, shaders);
+	for (i = 0; i < numShaders; i += 1)
+	{
+		renderer->glGetShaderiv(
+			shaders[i],
+			GL_SHADER_SOURCE_LENGTH,
+			&length
+		);
+		if (length <= 1)
+		{
+			/* SPIR-V has no source for us to hash */
+			renderer->glLinkProgram(program);
+			return;
+		}
+		source = (char*) SDL_malloc(length);
+		renderer->glGetShaderSource(shaders[i], length, NULL, source);
+
+		/* Attachment order doesn't matter, so add the hashes */
+		key += HashProgramCacheString(
+			renderer->programCacheSeed,
+			source,
+			length
+		);
+		SDL_free(source);
+	}
+	SDL_snprintf(
+		path,
+		sizeof(path),
+		"%s/%016llx.glbin",
+		renderer->programCacheDir,
+		(unsigned long long) key
+	);
+
+	/* File layout: uint32_t binaryFormat, then the binary */
+	data = (uint8_t*) SDL_LoadFile(path, &dataLength);
+	if (data != NULL)
+	{
+		if (dataLength > sizeof(packedFormat))
+		{
+			SDL_memcpy(&packedFormat, data, sizeof(packedFormat));
+			renderer->glProgramBinary(
+				program,
+				(GLenum) packedFormat,
+				data + sizeof(packedFormat),
+				(GLsizei) (dataLength - sizeof(packedFormat))
+			);
+			renderer->glGetProgramiv(program, GL_LINK_STATUS, &status);
+		}
+		SDL_free(data);
+		if (status)
+		{
+			return;
+		}
+
+		/* New driver or a torn write, link and replace it */
+	}
+
+	renderer->glProgramParameteri(
+		program,
+		GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+		GL_TRUE
+	);
+	renderer->glLinkProgram(program);
+	renderer->glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (!status)
+	{
+		/* MojoShader will report the link log */
+		return;
+	}
+
+	renderer->glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+	data = (uint8_t*) SDL_malloc(sizeof(packedFormat) + length);
+	renderer->glGetProgramBinary(
+		program,
+		length,
+		&length,
+		&binaryFormat,
+		data + sizeof(packedFormat)
+	);
+	packedFormat = (uint32_t) binaryFormat;
+	SDL_memcpy(data, &packedFormat, sizeof(packedFormat));
+
+	/* Other processes may be loading this key, so they should only ever
+	 * see a complete file. Write next to it, then move it into place.
+	 */
+	SDL_snprintf(
+		tempPath,
+		sizeof(tempPath),
+		"%s.%llx.tmp",
+		path,
+		(unsigned long long) (
+			SDL_GetPerformanceCounter() ^
+			(uint64_t) SDL_GetCurrentThreadID()
+		)
+	);
+	file = SDL_IOFromFile(tempPath, "wb");
+	if (file != NULL)
+	{
+		written = SDL_WriteIO(file, data, sizeof(packedFormat) + length) != 0;
+		SDL_CloseIO(file);
+		if (!written || !SDL_RenamePath(tempPath, path))
+		{
+			written = 0;
+			SDL_RemovePath(tempPath);
+		}
+	}
+	if (!written)
+	{
+		FNA3D_LogWarn("Could not write program binary %s", path);
+	}
+	SDL_free(data);
+}
+
 static void* MOJOSHADERCALL GLGetProcAddress(const char *ep, void* d)
 {
+	OpenGLRenderer *renderer = (OpenGLRenderer*) d;
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
+	if (	renderer != NULL &&
+		renderer->programCacheDir != NULL &&
+		SDL_strcmp(ep, "glLinkProgram") == 0	)
+	{
+		return (void*) OPENGL_INTERNAL_LinkProgram;
+	}
 	return SDL_GL_GetProcAddress(ep);
 #pragma GCC diagnostic pop
 }
@@ -5906,6 +8590,7 @@ FNA3D_Device* OPENGL_CreateDevice(
 	int32_t flags;
 	int32_t depthSize, stencilSize;
 	const char *rendererStr, *versionStr, *vendorStr;
+	const char *hint;
 	char driverInfo[256];
 	int32_t i;
 	int32_t numExtensions, numSamplers, numAttributes, numAttachments;
@@ -6066,10 +8751,41 @@ FNA3D_Device* OPENGL_CreateDevice(
 			renderer->shaderProfile = "glsl120";
 		}
 	}
+
+	/* Linked programs can be cached on disk, if we're told where */
+	hint = SDL_GetHint("FNA3D_OPENGL_PROGRAM_CACHE_DIR");
+	if (	hint != NULL &&
+		hint[0] != '\0' &&
+		renderer->supports_ARB_get_program_binary	)
+	{
+		renderer->glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &i);
+		if (i > 0)
+		{
+			renderer->programCacheDir = SDL_strdup(hint);
+
+			/* Binaries are only good for this exact driver */
+			renderer->programCacheSeed = HashProgramCacheString(
+				0xCBF29CE484222325ULL,
+				rendererStr,
+				SDL_strlen(rendererStr)
+			);
+			renderer->programCacheSeed = HashProgramCacheString(
+				renderer->programCacheSeed,
+				versionStr,
+				SDL_strlen(versionStr)
+			);
+			OPENGL_INTERNAL_RegisterProgramCache(renderer);
+		}
+		else
+		{
+			FNA3D_LogWarn("No program binary formats, disk cache disabled");
+		}
+	}
+
 	renderer->shaderContext = MOJOSHADER_glCreateContext(
 		renderer->shaderProfile,
 		GLGetProcAddress,
-		NULL,
+		renderer,
 		NULL,
 		NULL,
 		renderer
@@ -6082,6 +8798,24 @@ FNA3D_Device* OPENGL_CreateDevice(
 		"FNA3D_BACKBUFFER_SCALE_NEAREST", 0
 	) ? GL_NEAREST : GL_LINEAR;
 
+	/* ... and some users might want to trade throughput for latency */
+	hint = SDL_GetHint("FNA3D_FRAMES_IN_FLIGHT");
+	if (hint != NULL && SDL_atoi(hint) > 0)
+	{
+		if (renderer->supports_ARB_sync)
+		{
+			renderer->framesInFlight = SDL_clamp(
+				SDL_atoi(hint),
+				1,
+				MAX_FRAMES_IN_FLIGHT
+			);
+		}
+		else
+		{
+			FNA3D_LogWarn("ARB_sync not supported, ignoring frames in flight");
+		}
+	}
+
 	/* Load the extension list, initialize extension-dependent components */
 	renderer->supports_s3tc = 0;
 	renderer->supports_dxt1 = 0;
@@ -6166,6 +8900,8 @@ FNA3D_Device* OPENGL_CreateDevice(
 	for (i = 0; i < numSamplers; i += 1)
 	{
 		renderer->textures[i] = &NullTexture;
+		renderer->textureGenerations[i] = 0;
+		renderer->samplers[i] = 0;
 	}
 
 	/* Initialize vertex attribute state arrays */
@@ -6211,6 +8947,7 @@ FNA3D_Device* OPENGL_CreateDevice(
 		/* Generate and bind a VAO, to shut Core up */
 		renderer->glGenVertexArrays(1, &renderer->vao);
 		renderer->glBindVertexArray(renderer->vao);
+		renderer->useVertexArrayCache = renderer->supports_ARB_vertex_attrib_binding;
 	}
 	else if (!renderer->useES3)
 	{
@@ -6233,6 +8970,21 @@ FNA3D_Device* OPENGL_CreateDevice(
 		}
 	}
 
+	/* Stream texture uploads through a PBO ring, if we can map it forever */
+	hint = SDL_GetHint("FNA3D_OPENGL_UPLOAD_BUFFER_SIZE");
+	i = (hint != NULL) ? SDL_atoi(hint) : (16 * 1024 * 1024);
+	if (i > 0 && renderer->supports_ARB_buffer_storage && renderer->supports_ARB_sync)
+	{
+		OPENGL_INTERNAL_CreateUploadBuffer(renderer, i);
+	}
+
+	/* Same requirements for persistently mapped dynamic buffers */
+	renderer->persistentBuffers = (
+		renderer->supports_ARB_buffer_storage &&
+		renderer->supports_ARB_sync &&
+		!SDL_GetHintBoolean("FNA3D_OPENGL_DISABLE_PERSISTENT_BUFFERS", 0)
+	);
+
 	/* Initialize renderer members not covered by SDL_memset('\0') */
 	renderer->dstBlend = FNA3D_BLEND_ZERO; /* ZERO is really 1. -caleb */
 	renderer->dstBlendAlpha = FNA3D_BLEND_ZERO; /* ZERO is really 1. -caleb */
@@ -6249,13 +9001,36 @@ FNA3D_Device* OPENGL_CreateDevice(
 
 	/* The creation thread will be the "main" thread */
 	renderer->threadID = SDL_GetCurrentThreadID();
-	renderer->commandsLock = SDL_CreateMutex();
-	renderer->disposeTexturesLock = SDL_CreateMutex();
-	renderer->disposeRenderbuffersLock = SDL_CreateMutex();
-	renderer->disposeVertexBuffersLock = SDL_CreateMutex();
-	renderer->disposeIndexBuffersLock = SDL_CreateMutex();
-	renderer->disposeEffectsLock = SDL_CreateMutex();
-	renderer->disposeQueriesLock = SDL_CreateMutex();
+
+	/* Loader threads can get their own contexts, this must come last! */
+	hint = SDL_GetHint("FNA3D_OPENGL_WORKER_CONTEXTS");
+	if (hint != NULL && SDL_atoi(hint) > 0)
+	{
+		if (renderer->supports_ARB_sync)
+		{
+			OPENGL_INTERNAL_CreateWorkers(
+				renderer,
+				(SDL_Window*) presentationParameters->deviceWindowHandle,
+				SDL_atoi(hint)
+			);
+		}
+		else
+		{
+			FNA3D_LogWarn("ARB_sync not supported, ignoring worker contexts");
+		}
+	}
+
+	/* Hand the context over to a render thread, after the workers are made.
+	 * Note that this means presenting off of the main thread, which not
+	 * every platform is happy with (looking at you, macOS).
+	 */
+	if (SDL_GetHintBoolean("FNA3D_OPENGL_RENDER_THREAD", 0))
+	{
+		return OPENGL_INTERNAL_StartRenderThread(
+			renderer,
+			(SDL_Window*) presentationParameters->deviceWindowHandle
+		);
+	}
 
 	/* Return the FNA3D_Device */
 	return result;
@@ -42,6 +42,8 @@ typedef char		GLchar;
 typedef uintptr_t	GLsizeiptr;
 typedef intptr_t	GLintptr;
 typedef unsigned char	GLboolean;
+typedef uint64_t	GLuint64;
+typedef struct __GLsync	*GLsync;
 
 /* Hint */
 #define GL_DONT_CARE					0x1100
@@ -219,10 +221,12 @@ typedef unsigned char	GLboolean;
 #define GL_TEXTURE_MAG_FILTER				0x2800
 #define GL_TEXTURE_MIN_FILTER				0x2801
 #define GL_TEXTURE_MAX_ANISOTROPY_EXT			0x84FE
+#define GL_TEXTURE_MIN_LOD				0x813A
 #define GL_TEXTURE_BASE_LEVEL				0x813C
 #define GL_TEXTURE_MAX_LEVEL				0x813D
 #define GL_TEXTURE_LOD_BIAS				0x8501
 #define GL_UNPACK_ALIGNMENT				0x0CF5
+#define GL_PACK_ALIGNMENT				0x0D05
 
 /* Multitexture */
 #define GL_TEXTURE0					0x84C0
@@ -234,12 +238,22 @@ typedef unsigned char	GLboolean;
 #define GL_ELEMENT_ARRAY_BUFFER 			0x8893
 #define GL_STREAM_DRAW  				0x88E0
 #define GL_STATIC_DRAW  				0x88E4
+#define GL_STREAM_READ  				0x88E1
+#define GL_PIXEL_PACK_BUFFER				0x88EB
+#define GL_PIXEL_UNPACK_BUFFER				0x88EC
+#define GL_COPY_READ_BUFFER				0x8F36
+#define GL_COPY_WRITE_BUFFER				0x8F37
 #define GL_MAX_VERTEX_ATTRIBS				0x8869
 
 /* NoOverwrite Uploads */
 #define GL_MAP_WRITE_BIT				0x0002
 #define GL_MAP_UNSYNCHRONIZED_BIT			0x0020
 
+/* Persistent Mapping */
+#define GL_MAP_PERSISTENT_BIT				0x0040
+#define GL_MAP_COHERENT_BIT				0x0080
+#define GL_DYNAMIC_STORAGE_BIT				0x0100
+
 /* Render targets */
 #define GL_FRAMEBUFFER  				0x8D40
 #define GL_READ_FRAMEBUFFER				0x8CA8
@@ -259,6 +273,21 @@ typedef unsigned char	GLboolean;
 #define GL_QUERY_RESULT_AVAILABLE			0x8867
 #define GL_SAMPLES_PASSED				0x8914
 
+/* Sync Objects */
+#define GL_SYNC_GPU_COMMANDS_COMPLETE			0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT			0x00000001
+#define GL_ALREADY_SIGNALED				0x911A
+#define GL_TIMEOUT_EXPIRED				0x911B
+#define GL_WAIT_FAILED					0x911D
+#define GL_TIMEOUT_IGNORED				0xFFFFFFFFFFFFFFFFull
+
+/* Program Binaries */
+#define GL_SHADER_SOURCE_LENGTH				0x8B88
+#define GL_LINK_STATUS					0x8B82
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT		0x8257
+#define GL_PROGRAM_BINARY_LENGTH			0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS			0x87FE
+
 /* Multisampling */
 #define GL_MULTISAMPLE  				0x809D
 #define GL_MAX_SAMPLES  				0x8D57
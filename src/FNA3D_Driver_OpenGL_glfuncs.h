@@ -44,6 +44,14 @@ GL_EXT(ARB_draw_elements_base_vertex)
 GL_EXT(EXT_draw_buffers2)
 GL_EXT(ARB_texture_multisample)
 GL_EXT(ARB_map_buffer_range)
+GL_EXT(ARB_sync)
+GL_EXT(ARB_buffer_storage)
+GL_EXT(ARB_get_texture_sub_image)
+GL_EXT(ARB_vertex_attrib_binding)
+GL_EXT(ARB_sampler_objects)
+GL_EXT(ARB_get_program_binary)
+GL_EXT(ARB_texture_storage)
+GL_EXT(ARB_copy_buffer)
 GL_EXT(KHR_debug)
 GL_EXT(GREMEDY_string_marker)
 
@@ -72,6 +80,7 @@ GL_PROC(BaseGL, void, glDrawBuffers, (GLsizei a, const GLenum *b))
 GL_PROC(BaseGL, void, glDrawRangeElements, (GLenum a, GLuint b, GLuint c, GLsizei d, GLenum e, const GLvoid *f))
 GL_PROC(BaseGL, void, glEnable, (GLenum a))
 GL_PROC(BaseGL, void, glEnableVertexAttribArray, (GLint a))
+GL_PROC(BaseGL, void, glFlush, (void))
 GL_PROC(BaseGL, void, glFrontFace, (GLenum a))
 GL_PROC(BaseGL, void, glGenBuffers, (GLint a, GLuint *b))
 GL_PROC(BaseGL, void, glGenTextures, (GLsizei a, GLuint *b))
@@ -172,6 +181,48 @@ GL_PROC(ARB_texture_multisample, void, glSampleMaski, (GLuint a, GLuint b))
 /* Technically UnmapBuffer is core, but useless without MapBufferRange */
 GL_PROC_EXT(ARB_map_buffer_range, EXT, GLvoid*, glMapBufferRange, (GLenum a, GLintptr b, GLsizeiptr c, GLbitfield d))
 
+/* Only needed for frame pacing, so this is optional */
+GL_PROC(ARB_sync, GLsync, glFenceSync, (GLenum a, GLbitfield b))
+GL_PROC(ARB_sync, GLenum, glClientWaitSync, (GLsync a, GLbitfield b, GLuint64 c))
+GL_PROC(ARB_sync, void, glDeleteSync, (GLsync a))
+GL_PROC(ARB_sync, void, glWaitSync, (GLsync a, GLbitfield b, GLuint64 c))
+
+/* Persistent mappings for streaming uploads, also optional */
+GL_PROC_EXT(ARB_buffer_storage, EXT, void, glBufferStorage, (GLenum a, GLsizeiptr b, const GLvoid *c, GLbitfield d))
+
+/* Sub-rectangle texture reads, otherwise we download the whole level */
+GL_PROC(ARB_get_texture_sub_image, void, glGetTextureSubImage, (GLuint a, GLint b, GLint c, GLint d, GLint e, GLsizei f, GLsizei g, GLsizei h, GLenum i, GLenum j, GLsizei k, GLvoid *l))
+
+/* Buffer to buffer copies, for queued buffer readbacks */
+GL_PROC(ARB_copy_buffer, void, glCopyBufferSubData, (GLenum a, GLenum b, GLintptr c, GLintptr d, GLsizeiptr e))
+
+/* Separate vertex formats from buffers, so Core can cache VAOs */
+GL_PROC(ARB_vertex_attrib_binding, void, glBindVertexBuffer, (GLuint a, GLuint b, GLintptr c, GLsizei d))
+GL_PROC(ARB_vertex_attrib_binding, void, glVertexAttribFormat, (GLuint a, GLint b, GLenum c, GLboolean d, GLuint e))
+GL_PROC(ARB_vertex_attrib_binding, void, glVertexAttribBinding, (GLuint a, GLuint b))
+GL_PROC(ARB_vertex_attrib_binding, void, glVertexBindingDivisor, (GLuint a, GLuint b))
+
+/* Sampler state separate from textures, so one texture can use many */
+GL_PROC(ARB_sampler_objects, void, glGenSamplers, (GLsizei a, GLuint *b))
+GL_PROC(ARB_sampler_objects, void, glDeleteSamplers, (GLsizei a, const GLuint *b))
+GL_PROC(ARB_sampler_objects, void, glBindSampler, (GLuint a, GLuint b))
+GL_PROC(ARB_sampler_objects, void, glSamplerParameteri, (GLuint a, GLenum b, GLint c))
+GL_PROC(ARB_sampler_objects, void, glSamplerParameterf, (GLuint a, GLenum b, GLfloat c))
+
+/* Program binary disk cache, plus what it needs to link for MojoShader */
+GL_PROC(ARB_get_program_binary, void, glGetProgramBinary, (GLuint a, GLsizei b, GLsizei *c, GLenum *d, GLvoid *e))
+GL_PROC(ARB_get_program_binary, void, glProgramBinary, (GLuint a, GLenum b, const GLvoid *c, GLsizei d))
+GL_PROC(ARB_get_program_binary, void, glProgramParameteri, (GLuint a, GLenum b, GLint c))
+GL_PROC(ARB_get_program_binary, void, glLinkProgram, (GLuint a))
+GL_PROC(ARB_get_program_binary, void, glGetProgramiv, (GLuint a, GLenum b, GLint *c))
+GL_PROC(ARB_get_program_binary, void, glGetAttachedShaders, (GLuint a, GLsizei b, GLsizei *c, GLuint *d))
+GL_PROC(ARB_get_program_binary, void, glGetShaderiv, (GLuint a, GLenum b, GLint *c))
+GL_PROC(ARB_get_program_binary, void, glGetShaderSource, (GLuint a, GLsizei b, GLsizei *c, GLchar *d))
+
+/* Immutable texture storage, otherwise every level is allocated separately */
+GL_PROC(ARB_texture_storage, void, glTexStorage2D, (GLenum a, GLsizei b, GLenum c, GLsizei d, GLsizei e))
+GL_PROC(ARB_texture_storage, void, glTexStorage3D, (GLenum a, GLsizei b, GLenum c, GLsizei d, GLsizei e, GLsizei f))
+
 /* "NOTE: when implemented in an OpenGL ES context, all entry points defined
  * by this extension must have a "KHR" suffix. When implemented in an
  * OpenGL context, all entry points must have NO suffix, as shown below."
@@ -32,8 +32,10 @@
 #include "FNA3D_PipelineCache.h"
 
 #define MAX_FRAMES_IN_FLIGHT 3
-#define MAX_UPLOAD_CYCLE_COUNT 4
 #define TRANSFER_BUFFER_SIZE 16777216 /* 16 MiB */
+#define MAX_FREE_STAGING_BUFFERS 8
+#define DYNAMIC_RING_SIZE 4194304 /* 4 MiB */
+#define DYNAMIC_RING_ALIGNMENT 16
 
 static inline SDL_GPUSampleCount XNAToSDL_SampleCount(int32_t sampleCount)
 {
@@ -344,12 +346,61 @@ typedef struct SDLGPU_BufferHandle /* Cast from FNA3D_Buffer* */
 {
 	SDL_GPUBuffer *buffer;
 	uint32_t size;
+	uint8_t dynamic;
+	uint8_t ringRedirect; /* Contents live in the dynamic ring this frame */
+	uint32_t ringOffset;
+	uint32_t ringSize; /* Only what has been written since the discard */
 } SDLGPU_BufferHandle;
 
+typedef struct SDLGPU_BufferHandleArray
+{
+	SDLGPU_BufferHandle **elements;
+	int32_t count;
+	int32_t capacity;
+} SDLGPU_BufferHandleArray;
+
+typedef struct SDLGPU_Readback /* Cast from FNA3D_ReadbackEXT* */
+{
+	SDL_GPUTransferBuffer *transferBuffer;
+	SDL_GPUFence *fence;
+	uint32_t size;
+} SDLGPU_Readback;
+
+/* Upload staging memory. Small uploads share TRANSFER_BUFFER_SIZE blocks,
+ * larger ones get a whole buffer rounded up to a power of two. Buffers go back
+ * to the free list once the fence of the submission that used them signals.
+ */
+typedef struct SDLGPU_StagingBuffer
+{
+	SDL_GPUTransferBuffer *transferBuffer;
+	uint32_t size;
+	uint32_t offset;
+	SDL_GPUFence *fence; /* Shared by every buffer of one submission */
+	int32_t writers; /* Reserved ranges whose upload isn't recorded yet */
+} SDLGPU_StagingBuffer;
+
+typedef struct SDLGPU_StagingBufferArray
+{
+	SDLGPU_StagingBuffer **elements;
+	int32_t count;
+	int32_t capacity;
+} SDLGPU_StagingBufferArray;
+
+typedef struct SDLGPU_CaptureFrame
+{
+	SDL_GPUTransferBuffer *transferBuffer;
+	SDL_GPUFence *fence;
+	uint32_t transferBufferSize;
+	uint32_t width;
+	uint32_t height;
+	uint32_t dataLength;
+} SDLGPU_CaptureFrame;
+
 typedef struct SamplerStateHashMap
 {
 	PackedState key;
 	SDL_GPUSampler *value;
+	uint64_t lastUsedFrame;
 } SamplerStateHashMap;
 
 typedef struct SamplerStateHashArray
@@ -361,7 +412,8 @@ typedef struct SamplerStateHashArray
 
 static inline SDL_GPUSampler* SamplerStateHashArray_Fetch(
 	SamplerStateHashArray *arr,
-	PackedState key
+	PackedState key,
+	uint64_t frame
 ) {
 	int32_t i;
 
@@ -370,6 +422,7 @@ static inline SDL_GPUSampler* SamplerStateHashArray_Fetch(
 		if (	key.a == arr->elements[i].key.a &&
 			key.b == arr->elements[i].key.b		)
 		{
+			arr->elements[i].lastUsedFrame = frame;
 			return arr->elements[i].value;
 		}
 	}
@@ -380,12 +433,14 @@ static inline SDL_GPUSampler* SamplerStateHashArray_Fetch(
 static inline void SamplerStateHashArray_Insert(
 	SamplerStateHashArray *arr,
 	PackedState key,
-	SDL_GPUSampler *value
+	SDL_GPUSampler *value,
+	uint64_t frame
 ) {
 	SamplerStateHashMap map;
 	map.key.a = key.a;
 	map.key.b = key.b;
 	map.value = value;
+	map.lastUsedFrame = frame;
 
 	EXPAND_ARRAY_IF_NEEDED(arr, 4, SamplerStateHashMap)
 
@@ -399,7 +454,7 @@ typedef struct GraphicsPipelineHash
 	PackedState blendState;
 	PackedState rasterizerState;
 	PackedState depthStencilState;
-	uint32_t vertexBufferBindingsIndex;
+	uint32_t vertexInputLayoutIndex;
 	FNA3D_PrimitiveType primitiveType;
 	SDL_GPUSampleCount sampleCount;
 	uint32_t sampleMask;
@@ -415,6 +470,7 @@ typedef struct GraphicsPipelineHashMap
 {
 	GraphicsPipelineHash key;
 	SDL_GPUGraphicsPipeline *value;
+	uint64_t lastUsedFrame;
 } GraphicsPipelineHashMap;
 
 typedef struct GraphicsPipelineHashArray
@@ -429,6 +485,7 @@ typedef struct GraphicsPipelineHashArray
 typedef struct GraphicsPipelineHashTable
 {
 	GraphicsPipelineHashArray buckets[NUM_PIPELINE_HASH_BUCKETS];
+	int32_t count;
 } GraphicsPipelineHashTable;
 
 static inline uint64_t GraphicsPipelineHashTable_GetHashCode(GraphicsPipelineHash hash)
@@ -446,7 +503,7 @@ static inline uint64_t GraphicsPipelineHashTable_GetHashCode(GraphicsPipelineHas
 	result = result * HASH_FACTOR + hash.rasterizerState.b;
 	result = result * HASH_FACTOR + hash.depthStencilState.a;
 	result = result * HASH_FACTOR + hash.depthStencilState.b;
-	result = result * HASH_FACTOR + hash.vertexBufferBindingsIndex;
+	result = result * HASH_FACTOR + hash.vertexInputLayoutIndex;
 	result = result * HASH_FACTOR + hash.primitiveType;
 	result = result * HASH_FACTOR + hash.sampleCount;
 	result = result * HASH_FACTOR + hash.sampleMask;
@@ -464,7 +521,8 @@ static inline uint64_t GraphicsPipelineHashTable_GetHashCode(GraphicsPipelineHas
 
 static inline SDL_GPUGraphicsPipeline *GraphicsPipelineHashTable_Fetch(
 	GraphicsPipelineHashTable *table,
-	GraphicsPipelineHash key
+	GraphicsPipelineHash key,
+	uint64_t frame
 ) {
 	int32_t i;
 	uint64_t hashcode = GraphicsPipelineHashTable_GetHashCode(key);
@@ -479,7 +537,7 @@ static inline SDL_GPUGraphicsPipeline *GraphicsPipelineHashTable_Fetch(
 			key.rasterizerState.b == e->rasterizerState.b &&
 			key.depthStencilState.a == e->depthStencilState.a &&
 			key.depthStencilState.b == e->depthStencilState.b &&
-			key.vertexBufferBindingsIndex == e->vertexBufferBindingsIndex &&
+			key.vertexInputLayoutIndex == e->vertexInputLayoutIndex &&
 			key.primitiveType == e->primitiveType &&
 			key.sampleMask == e->sampleMask &&
 			key.vertShader == e->vertShader &&
@@ -492,6 +550,7 @@ static inline SDL_GPUGraphicsPipeline *GraphicsPipelineHashTable_Fetch(
 			key.hasDepthStencilAttachment == e->hasDepthStencilAttachment &&
 			key.depthStencilFormat == e->depthStencilFormat )
 		{
+			arr->elements[i].lastUsedFrame = frame;
 			return arr->elements[i].value;
 		}
 	}
@@ -502,20 +561,252 @@ static inline SDL_GPUGraphicsPipeline *GraphicsPipelineHashTable_Fetch(
 static inline void GraphicsPipelineHashTable_Insert(
 	GraphicsPipelineHashTable *table,
 	GraphicsPipelineHash key,
-	SDL_GPUGraphicsPipeline *value
+	SDL_GPUGraphicsPipeline *value,
+	uint64_t frame
 ) {
 	uint64_t hashcode = GraphicsPipelineHashTable_GetHashCode(key);
 	GraphicsPipelineHashArray *arr = &table->buckets[hashcode % NUM_PIPELINE_HASH_BUCKETS];
 	GraphicsPipelineHashMap map;
 	map.key = key;
 	map.value = value;
+	map.lastUsedFrame = frame;
 
 	EXPAND_ARRAY_IF_NEEDED(arr, 2, GraphicsPipelineHashMap)
 
 	arr->elements[arr->count] = map;
 	arr->count += 1;
+	table->count += 1;
+}
+
+/* Canonical vertex input state, interned so that pipelines are keyed on the
+ * layout the GPU actually sees rather than on the declaration that produced
+ * it. Declarations that only differ in element order or unused elements end
+ * up sharing a layout, and therefore share pipelines.
+ */
+typedef struct VertexInputLayout
+{
+	uint64_t hash;
+	SDL_GPUVertexBufferDescription vertexDescriptions[MAX_BOUND_VERTEX_BUFFERS];
+	uint32_t numVertexBindings;
+	SDL_GPUVertexAttribute vertexAttributes[MAX_VERTEX_ATTRIBUTES];
+	uint32_t numVertexAttributes;
+} VertexInputLayout;
+
+typedef struct VertexInputLayoutArray
+{
+	VertexInputLayout *elements;
+	int32_t count;
+	int32_t capacity;
+} VertexInputLayoutArray;
+
+static inline void VertexInputLayout_Canonicalize(VertexInputLayout *layout)
+{
+	const uint64_t HASH_FACTOR = 97;
+	SDL_GPUVertexAttribute attr;
+	uint32_t i, j;
+	uint64_t result = 1;
+
+	/* Element order is irrelevant, only the shader locations matter */
+	for (i = 1; i < layout->numVertexAttributes; i += 1)
+	{
+		attr = layout->vertexAttributes[i];
+		j = i;
+		while (j > 0 && layout->vertexAttributes[j - 1].location > attr.location)
+		{
+			layout->vertexAttributes[j] = layout->vertexAttributes[j - 1];
+			j -= 1;
+		}
+		layout->vertexAttributes[j] = attr;
+	}
+
+	result = result * HASH_FACTOR + layout->numVertexBindings;
+	for (i = 0; i < layout->numVertexBindings; i += 1)
+	{
+		result = result * HASH_FACTOR + layout->vertexDescriptions[i].pitch;
+		result = result * HASH_FACTOR + layout->vertexDescriptions[i].input_rate;
+	}
+	result = result * HASH_FACTOR + layout->numVertexAttributes;
+	for (i = 0; i < layout->numVertexAttributes; i += 1)
+	{
+		result = result * HASH_FACTOR + layout->vertexAttributes[i].location;
+		result = result * HASH_FACTOR + layout->vertexAttributes[i].buffer_slot;
+		result = result * HASH_FACTOR + layout->vertexAttributes[i].format;
+		result = result * HASH_FACTOR + layout->vertexAttributes[i].offset;
+	}
+	layout->hash = result;
+}
+
+static inline uint32_t VertexInputLayoutArray_Intern(
+	VertexInputLayoutArray *arr,
+	VertexInputLayout *layout
+) {
+	int32_t i;
+	const VertexInputLayout *e;
+
+	VertexInputLayout_Canonicalize(layout);
+
+	for (i = 0; i < arr->count; i += 1)
+	{
+		e = &arr->elements[i];
+		if (	layout->hash == e->hash &&
+			layout->numVertexBindings == e->numVertexBindings &&
+			layout->numVertexAttributes == e->numVertexAttributes &&
+			SDL_memcmp(
+				layout->vertexDescriptions,
+				e->vertexDescriptions,
+				sizeof(SDL_GPUVertexBufferDescription) * layout->numVertexBindings
+			) == 0 &&
+			SDL_memcmp(
+				layout->vertexAttributes,
+				e->vertexAttributes,
+				sizeof(SDL_GPUVertexAttribute) * layout->numVertexAttributes
+			) == 0	)
+		{
+			return (uint32_t) i;
+		}
+	}
+
+	EXPAND_ARRAY_IF_NEEDED(arr, 4, VertexInputLayout)
+
+	arr->elements[arr->count] = *layout;
+	arr->count += 1;
+	return (uint32_t) (arr->count - 1);
+}
+
+/* Linked shader program and vertex input layout, memoized per bindings/shader
+ * pair so that pipeline cache hits don't have to relink anything.
+ */
+typedef struct VertexInputHash
+{
+	int32_t vertexBufferBindingsIndex;
+	MOJOSHADER_sdlShaderData *vertShaderData;
+	MOJOSHADER_sdlShaderData *fragShaderData;
+} VertexInputHash;
+
+typedef struct VertexInputInfo
+{
+	MOJOSHADER_sdlProgram *program;
+	SDL_GPUShader *vertShader;
+	SDL_GPUShader *fragShader;
+	uint32_t layoutIndex;
+} VertexInputInfo;
+
+typedef struct VertexInputHashMap
+{
+	VertexInputHash key;
+	VertexInputInfo *value;
+} VertexInputHashMap;
+
+typedef struct VertexInputHashArray
+{
+	VertexInputHashMap *elements;
+	int32_t count;
+	int32_t capacity;
+} VertexInputHashArray;
+
+#define NUM_VERTEX_INPUT_HASH_BUCKETS 257
+
+typedef struct VertexInputHashTable
+{
+	VertexInputHashArray buckets[NUM_VERTEX_INPUT_HASH_BUCKETS];
+} VertexInputHashTable;
+
+static inline uint64_t VertexInputHashTable_GetHashCode(VertexInputHash hash)
+{
+	/* Same Bloch hash as the pipeline table */
+	const uint64_t HASH_FACTOR = 97;
+	uint64_t result = 1;
+	result = result * HASH_FACTOR + (uint32_t) hash.vertexBufferBindingsIndex;
+	result = result * HASH_FACTOR + (uint64_t) (size_t) hash.vertShaderData;
+	result = result * HASH_FACTOR + (uint64_t) (size_t) hash.fragShaderData;
+	return result;
+}
+
+static inline VertexInputInfo* VertexInputHashTable_Fetch(
+	VertexInputHashTable *table,
+	VertexInputHash key
+) {
+	int32_t i;
+	uint64_t hashcode = VertexInputHashTable_GetHashCode(key);
+	VertexInputHashArray *arr = &table->buckets[hashcode % NUM_VERTEX_INPUT_HASH_BUCKETS];
+
+	for (i = 0; i < arr->count; i += 1)
+	{
+		const VertexInputHash *e = &arr->elements[i].key;
+		if (	key.vertexBufferBindingsIndex == e->vertexBufferBindingsIndex &&
+			key.vertShaderData == e->vertShaderData &&
+			key.fragShaderData == e->fragShaderData	)
+		{
+			return arr->elements[i].value;
+		}
+	}
+
+	return NULL;
+}
+
+static inline void VertexInputHashTable_Insert(
+	VertexInputHashTable *table,
+	VertexInputHash key,
+	VertexInputInfo *value
+) {
+	uint64_t hashcode = VertexInputHashTable_GetHashCode(key);
+	VertexInputHashArray *arr = &table->buckets[hashcode % NUM_VERTEX_INPUT_HASH_BUCKETS];
+	VertexInputHashMap map;
+	map.key = key;
+	map.value = value;
+
+	EXPAND_ARRAY_IF_NEEDED(arr, 2, VertexInputHashMap)
+
+	arr->elements[arr->count] = map;
+	arr->count += 1;
+}
+
+static inline void VertexInputHashTable_RemoveShader(
+	VertexInputHashTable *table,
+	MOJOSHADER_sdlShaderData *shaderData
+) {
+	int32_t i, j;
+	VertexInputHashArray *arr;
+
+	for (i = 0; i < NUM_VERTEX_INPUT_HASH_BUCKETS; i += 1)
+	{
+		arr = &table->buckets[i];
+		j = 0;
+		while (j < arr->count)
+		{
+			if (	arr->elements[j].key.vertShaderData == shaderData ||
+				arr->elements[j].key.fragShaderData == shaderData	)
+			{
+				SDL_free(arr->elements[j].value);
+				arr->elements[j] = arr->elements[arr->count - 1];
+				arr->count -= 1;
+			}
+			else
+			{
+				j += 1;
+			}
+		}
+	}
 }
 
+/* Shader Reflection */
+
+/* What the draw path needs to know about the bound shader pair, captured
+ * whenever an effect (re)binds shaders so draws don't query MojoShader.
+ */
+typedef struct SDLGPU_ShaderReflection
+{
+	MOJOSHADER_sdlShaderData *vertShader;
+	MOJOSHADER_sdlShaderData *fragShader;
+	const MOJOSHADER_parseData *vertParseData;
+	const MOJOSHADER_parseData *fragParseData;
+	uint32_t vertSamplerSlots;
+	uint32_t fragSamplerSlots;
+	MOJOSHADER_samplerType vertSamplerTypes[MAX_VERTEXTEXTURE_SAMPLERS];
+	MOJOSHADER_samplerType fragSamplerTypes[MAX_TEXTURE_SAMPLERS];
+	uint8_t valid; /* Cleared when an effect, and its shaders, is freed */
+} SDLGPU_ShaderReflection;
+
 typedef struct SDLGPU_Renderer
 {
 	SDL_GPUDevice *device;
@@ -545,6 +836,17 @@ typedef struct SDLGPU_Renderer
 
 	SDLGPU_TextureHandle *nextRenderPassDepthStencilAttachment; /* may be NULL */
 
+	/* Attachments of the active render pass, so rebinding them can be elided.
+	 * These are SDL textures rather than our handles: SDL keeps released
+	 * textures alive until the command buffer completes, so a pointer
+	 * can't be recycled while the pass that uses it is still open.
+	 */
+	SDL_GPUTexture *currentRenderPassColorAttachments[MAX_RENDERTARGET_BINDINGS];
+	SDL_GPUTexture *currentRenderPassColorResolves[MAX_RENDERTARGET_BINDINGS];
+	SDL_GPUCubeMapFace currentRenderPassColorAttachmentCubeFace[MAX_RENDERTARGET_BINDINGS];
+	uint32_t currentRenderPassColorAttachmentCount;
+	SDL_GPUTexture *currentRenderPassDepthStencilAttachment;
+
 	uint8_t renderTargetInUse;
 
 	uint8_t needNewGraphicsPipeline;
@@ -553,6 +855,18 @@ typedef struct SDLGPU_Renderer
 	SDL_GPUGraphicsPipeline *currentGraphicsPipeline;
 	MOJOSHADER_sdlShaderData *currentVertexShader;
 	MOJOSHADER_sdlShaderData *currentFragmentShader;
+	SDLGPU_ShaderReflection shaderReflection;
+
+	/* Uniforms are only pushed when the registers the bound shaders read
+	 * actually differ from what was last pushed. The snapshot holds those
+	 * registers, packed in parse data order.
+	 */
+	uint8_t uniformsDirty;
+	uint8_t needUniformPush;
+	uint8_t *uniformSnapshot;
+	uint8_t *uniformScratch;
+	int32_t uniformSnapshotSize;
+	int32_t uniformSnapshotCapacity;
 
 	PackedVertexBufferBindingsArray vertexBufferBindingsCache;
 
@@ -571,9 +885,19 @@ typedef struct SDLGPU_Renderer
 	/* Sampler bind settings */
 	SDL_GPUTextureSamplerBinding vertexTextureSamplerBindings[MAX_VERTEXTEXTURE_SAMPLERS];
 	uint8_t needVertexSamplerBind;
+	uint32_t vertexSamplerDirtyStart;
+	uint32_t vertexSamplerDirtyEnd;
 
 	SDL_GPUTextureSamplerBinding fragmentTextureSamplerBindings[MAX_TEXTURE_SAMPLERS];
 	uint8_t needFragmentSamplerBind;
+	uint32_t fragmentSamplerDirtyStart;
+	uint32_t fragmentSamplerDirtyEnd;
+
+	/* Last texture/sampler passed to each slot, NULL for dummy bindings */
+	SDLGPU_TextureHandle *vertexSamplerTextures[MAX_VERTEXTEXTURE_SAMPLERS];
+	FNA3D_SamplerState vertexSamplerStates[MAX_VERTEXTEXTURE_SAMPLERS];
+	SDLGPU_TextureHandle *fragmentSamplerTextures[MAX_TEXTURE_SAMPLERS];
+	FNA3D_SamplerState fragmentSamplerStates[MAX_TEXTURE_SAMPLERS];
 
 	/* Pipeline state */
 	FNA3D_BlendState fnaBlendState;
@@ -589,9 +913,6 @@ typedef struct SDLGPU_Renderer
 
 	/* Pipeline cache */
 	GraphicsPipelineHash nextPipelineHash;
-	SDL_GPUVertexBufferDescription vertexDescriptions[16];
-	SDL_GPUVertexAttribute vertexAttributes[16 * MAX_VERTEX_ATTRIBUTES];
-	uint32_t numVertexAttributes;
 
 	/* Presentation structure */
 
@@ -609,13 +930,26 @@ typedef struct SDLGPU_Renderer
 	SDL_GPUTransferBuffer *bufferDownloadBuffer;
 	uint32_t bufferDownloadBufferSize;
 
-	SDL_GPUTransferBuffer *textureUploadBuffer;
-	uint32_t textureUploadBufferOffset;
-	uint32_t textureUploadCycleCount;
+	SDLGPU_StagingBufferArray stagingFree;
+	SDLGPU_StagingBufferArray stagingInFlight;	/* In submission order */
+	SDLGPU_StagingBufferArray stagingPending;	/* Used by uploadCommandBuffer */
+	SDLGPU_StagingBuffer *stagingCurrent;		/* Shared block in stagingPending */
 
-	SDL_GPUTransferBuffer *bufferUploadBuffer;
-	uint32_t bufferUploadBufferOffset;
-	uint32_t bufferUploadCycleCount;
+	/* Per-frame ring that DISCARD writes to dynamic buffers are
+	 * redirected into, copied back to the real buffers at SwapBuffers
+	 */
+	SDL_GPUBuffer *dynamicRing;
+	uint32_t dynamicRingSize;
+	uint32_t dynamicRingOffset;
+	uint32_t dynamicRingRequested;	/* Grows the ring at the end of a frame */
+	uint8_t dynamicRingCycle;	/* Next ring upload is the frame's first */
+	SDLGPU_BufferHandleArray dynamicRingHandles;
+
+	/* Contiguous ring writes, recorded as one upload */
+	SDLGPU_StagingBuffer *ringUploadStaging;
+	uint32_t ringUploadSrcOffset;
+	uint32_t ringUploadDstOffset;
+	uint32_t ringUploadSize;
 
 	/* RT tracking to reduce unnecessary cycling */
 
@@ -626,7 +960,22 @@ typedef struct SDLGPU_Renderer
 	/* Hashing */
 
 	GraphicsPipelineHashTable graphicsPipelineHashTable;
+	VertexInputHashTable vertexInputHashTable;
+	VertexInputLayoutArray vertexInputLayouts;
 	SamplerStateHashArray samplerStateArray;
+	FNA3D_PipelineCacheCountersEXT cacheStats[FNA3D_PIPELINECACHE_TYPE_COUNT_EXT];
+
+	/* Cache eviction, 0 means unlimited */
+	uint64_t frameCounter;
+	int32_t maxCachedPipelines;
+	int32_t maxCachedSamplers;
+
+	/* Backbuffer capture, frames are delivered captureFrameCount presents late */
+	FNA3D_BackbufferCaptureFuncEXT captureCallback;
+	void *captureUserdata;
+	int32_t captureFrameCount;
+	int32_t captureIndex;
+	SDLGPU_CaptureFrame captureFrames[FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT];
 
 	/* MOJOSHADER */
 
@@ -945,6 +1294,19 @@ static void SDLGPU_INTERNAL_BeginRenderPass(
 		renderer->nextRenderPassDepthStencilAttachment != NULL ? &depthStencilAttachmentInfo : NULL
 	);
 
+	for (i = 0; i < renderer->nextRenderPassColorAttachmentCount; i += 1)
+	{
+		renderer->currentRenderPassColorAttachments[i] = colorAttachmentInfos[i].texture;
+		renderer->currentRenderPassColorResolves[i] = colorAttachmentInfos[i].resolve_texture;
+		renderer->currentRenderPassColorAttachmentCubeFace[i] = renderer->nextRenderPassColorAttachmentCubeFace[i];
+	}
+	renderer->currentRenderPassColorAttachmentCount = renderer->nextRenderPassColorAttachmentCount;
+	renderer->currentRenderPassDepthStencilAttachment = (
+		renderer->nextRenderPassDepthStencilAttachment != NULL ?
+			depthStencilAttachmentInfo.texture :
+			NULL
+	);
+
 	SDLGPU_INTERNAL_UpdateViewport(renderer);
 
 	renderer->shouldClearColorOnBeginPass = 0;
@@ -952,140 +1314,964 @@ static void SDLGPU_INTERNAL_BeginRenderPass(
 	renderer->shouldClearStencilOnBeginPass = 0;
 
 	renderer->needNewGraphicsPipeline = 1;
+	renderer->needUniformPush = 1;
 }
 
-static void SDLGPU_INTERNAL_ResetUploadCommandBufferState(
-	SDLGPU_Renderer *renderer
+/* Staging Pool */
+
+static void SDLGPU_INTERNAL_ReturnStagingBuffer(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_StagingBuffer *staging
 ) {
-	/* commandLock should be acquired by this point */
+	SDLGPU_StagingBufferArray *arr = &renderer->stagingFree;
 
-	renderer->uploadCommandBuffer = SDL_AcquireGPUCommandBuffer(renderer->device);
-	SDLGPU_INTERNAL_BeginCopyPass(renderer);
+	/* Oversized buffers are for one-off uploads, don't hang on to them.
+	 * That keeps the free list under MAX_FREE_STAGING_BUFFERS blocks of
+	 * TRANSFER_BUFFER_SIZE.
+	 */
+	if (	arr->count >= MAX_FREE_STAGING_BUFFERS ||
+		staging->size > TRANSFER_BUFFER_SIZE	)
+	{
+		SDL_ReleaseGPUTransferBuffer(
+			renderer->device,
+			staging->transferBuffer
+		);
+		SDL_free(staging);
+		return;
+	}
 
-	/* Reset state */
-	renderer->textureUploadCycleCount = 0;
-	renderer->bufferUploadCycleCount = 0;
-	renderer->textureUploadBufferOffset = 0;
-	renderer->bufferUploadBufferOffset = 0;
+	staging->offset = 0;
+	staging->fence = NULL;
+	EXPAND_ARRAY_IF_NEEDED(arr, 4, SDLGPU_StagingBuffer*)
+	arr->elements[arr->count] = staging;
+	arr->count += 1;
 }
 
-static void SDLGPU_INTERNAL_ResetRenderCommandBufferState(
+static void SDLGPU_INTERNAL_RecycleStagingBuffers(
 	SDLGPU_Renderer *renderer
 ) {
 	/* commandLock should be acquired by this point */
 
-	renderer->renderCommandBuffer = SDL_AcquireGPUCommandBuffer(renderer->device);
+	SDLGPU_StagingBufferArray *arr = &renderer->stagingInFlight;
+	SDL_GPUFence *fence;
+	int32_t i = 0;
 
-	/* Reset state */
-	renderer->needNewRenderPass = 1;
-	renderer->needNewGraphicsPipeline = 1;
-	renderer->needVertexBufferBind = 1;
-	renderer->needVertexSamplerBind = 1;
-	renderer->needFragmentSamplerBind = 1;
+	while (i < arr->count)
+	{
+		/* Submissions retire in order, stop at the first busy one */
+		fence = arr->elements[i]->fence;
+		if (!SDL_QueryGPUFence(renderer->device, fence))
+		{
+			break;
+		}
+
+		while (i < arr->count && arr->elements[i]->fence == fence)
+		{
+			SDLGPU_INTERNAL_ReturnStagingBuffer(
+				renderer,
+				arr->elements[i]
+			);
+			i += 1;
+		}
+		SDL_ReleaseGPUFence(renderer->device, fence);
+	}
+
+	if (i > 0)
+	{
+		SDL_memmove(
+			arr->elements,
+			arr->elements + i,
+			sizeof(SDLGPU_StagingBuffer*) * (arr->count - i)
+		);
+		arr->count -= i;
+	}
 }
 
-static void SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
+static SDLGPU_StagingBuffer* SDLGPU_INTERNAL_AcquireStagingBuffer(
 	SDLGPU_Renderer *renderer,
-	SDL_GPUFence **uploadFence
+	uint32_t size
 ) {
 	/* commandLock should be acquired by this point */
 
-	SDLGPU_INTERNAL_EndCopyPass(renderer);
+	SDLGPU_StagingBufferArray *freeArr = &renderer->stagingFree;
+	SDLGPU_StagingBufferArray *arr = &renderer->stagingPending;
+	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
+	SDLGPU_StagingBuffer *staging = NULL;
+	int32_t i;
 
-	*uploadFence = SDL_SubmitGPUCommandBufferAndAcquireFence(
-		renderer->uploadCommandBuffer
-	);
+	SDLGPU_INTERNAL_RecycleStagingBuffers(renderer);
 
-	if (!*uploadFence) {
-		const char *error = SDL_GetError();
-		FNA3D_LogError("SDL_SubmitGPUCommandBufferAndAcquireFence failed: %s", error);
+	for (i = 0; i < freeArr->count; i += 1)
+	{
+		if (freeArr->elements[i]->size == size)
+		{
+			staging = freeArr->elements[i];
+			freeArr->elements[i] = freeArr->elements[freeArr->count - 1];
+			freeArr->count -= 1;
+			break;
+		}
 	}
 
-	SDLGPU_INTERNAL_ResetUploadCommandBufferState(renderer);
+	if (staging == NULL)
+	{
+		transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+		transferBufferCreateInfo.size = size;
+		transferBufferCreateInfo.props = 0;
+
+		staging = (SDLGPU_StagingBuffer*) SDL_malloc(
+			sizeof(SDLGPU_StagingBuffer)
+		);
+		staging->transferBuffer = SDL_CreateGPUTransferBuffer(
+			renderer->device,
+			&transferBufferCreateInfo
+		);
+		if (staging->transferBuffer == NULL)
+		{
+			FNA3D_LogError(
+				"Failed to create staging buffer: %s",
+				SDL_GetError()
+			);
+			SDL_free(staging);
+			return NULL;
+		}
+		staging->size = size;
+		staging->offset = 0;
+		staging->fence = NULL;
+	}
+	staging->writers = 0;
+
+	EXPAND_ARRAY_IF_NEEDED(arr, 4, SDLGPU_StagingBuffer*)
+	arr->elements[arr->count] = staging;
+	arr->count += 1;
+	return staging;
 }
 
-static void SDLGPU_INTERNAL_FlushUploadCommands(
-	SDLGPU_Renderer *renderer
+/* Reserves dataLength bytes of staging memory. Only the reservation needs
+ * commandLock; the caller copies into the range without holding it, then
+ * takes the lock again to record the upload and end the write.
+ */
+static SDLGPU_StagingBuffer* SDLGPU_INTERNAL_ReserveStagingMemory(
+	SDLGPU_Renderer *renderer,
+	uint32_t dataLength,
+	uint32_t alignment,
+	uint32_t *offset
 ) {
 	/* commandLock should be acquired by this point */
 
-	SDLGPU_INTERNAL_EndCopyPass(renderer);
-	SDL_SubmitGPUCommandBuffer(renderer->uploadCommandBuffer);
-	SDLGPU_INTERNAL_ResetUploadCommandBufferState(renderer);
+	SDLGPU_StagingBuffer *staging = renderer->stagingCurrent;
+	uint32_t start, size;
+
+	if (dataLength >= TRANSFER_BUFFER_SIZE)
+	{
+		/* Too big to share, take a whole buffer from its size class */
+		size = TRANSFER_BUFFER_SIZE;
+		while (size < dataLength && size < 0x80000000)
+		{
+			size *= 2;
+		}
+		size = SDL_max(size, dataLength);
+
+		staging = SDLGPU_INTERNAL_AcquireStagingBuffer(renderer, size);
+		if (staging == NULL)
+		{
+			return NULL;
+		}
+		staging->offset = staging->size;
+		staging->writers += 1;
+		*offset = 0;
+		return staging;
+	}
+
+	if (staging != NULL)
+	{
+		start = SDLGPU_INTERNAL_RoundToAlignment(staging->offset, alignment);
+		if (start + dataLength <= staging->size)
+		{
+			staging->offset = start + dataLength;
+			staging->writers += 1;
+			*offset = start;
+			return staging;
+		}
+	}
+
+	/* Out of room, the full block stays pending until the next submit */
+	staging = SDLGPU_INTERNAL_AcquireStagingBuffer(
+		renderer,
+		TRANSFER_BUFFER_SIZE
+	);
+	renderer->stagingCurrent = staging;
+	if (staging == NULL)
+	{
+		return NULL;
+	}
+	staging->offset = dataLength;
+	staging->writers += 1;
+	*offset = 0;
+	return staging;
 }
 
-static void SDLGPU_INTERNAL_FlushCommands(
+static void SDLGPU_INTERNAL_DestroyStagingBuffers(
 	SDLGPU_Renderer *renderer
 ) {
-	/* commandLock should be acquired by this point */
+	SDLGPU_StagingBufferArray *arrs[3];
+	SDL_GPUFence *prevFence = NULL;
+	int32_t i, j;
 
-	SDLGPU_INTERNAL_EndCopyPass(renderer);
-	SDL_SubmitGPUCommandBuffer(renderer->uploadCommandBuffer);
-	SDLGPU_INTERNAL_ResetUploadCommandBufferState(renderer);
+	arrs[0] = &renderer->stagingFree;
+	arrs[1] = &renderer->stagingInFlight;
+	arrs[2] = &renderer->stagingPending;
 
-	SDLGPU_INTERNAL_EndRenderPass(renderer);
-	SDL_SubmitGPUCommandBuffer(renderer->renderCommandBuffer);
-	SDLGPU_INTERNAL_ResetRenderCommandBufferState(renderer);
+	for (i = 0; i < 3; i += 1)
+	{
+		for (j = 0; j < arrs[i]->count; j += 1)
+		{
+			if (	arrs[i]->elements[j]->fence != NULL &&
+				arrs[i]->elements[j]->fence != prevFence	)
+			{
+				prevFence = arrs[i]->elements[j]->fence;
+				SDL_ReleaseGPUFence(renderer->device, prevFence);
+			}
+			SDL_ReleaseGPUTransferBuffer(
+				renderer->device,
+				arrs[i]->elements[j]->transferBuffer
+			);
+			SDL_free(arrs[i]->elements[j]);
+		}
+		SDL_free(arrs[i]->elements);
+	}
 }
 
-static void SDLGPU_INTERNAL_FlushCommandsAndStall(
-	SDLGPU_Renderer *renderer
+/* Dynamic Ring */
+
+static void SDLGPU_INTERNAL_UnlinkRingHandle(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_BufferHandle *handle
 ) {
 	/* commandLock should be acquired by this point */
 
-	SDL_GPUFence* fences[2];
+	SDLGPU_BufferHandleArray *arr = &renderer->dynamicRingHandles;
+	int32_t i;
 
-	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(renderer, &fences[0]);
+	for (i = 0; i < arr->count; i += 1)
+	{
+		if (arr->elements[i] == handle)
+		{
+			arr->elements[i] = arr->elements[arr->count - 1];
+			arr->count -= 1;
+			break;
+		}
+	}
+	handle->ringRedirect = 0;
+}
 
-	SDLGPU_INTERNAL_EndRenderPass(renderer);
+static uint8_t SDLGPU_INTERNAL_AllocateRingRegion(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_BufferHandle *handle,
+	uint32_t length
+) {
+	/* commandLock should be acquired by this point */
 
-	fences[1] = SDL_SubmitGPUCommandBufferAndAcquireFence(
-		renderer->renderCommandBuffer
+	SDLGPU_BufferHandleArray *arr = &renderer->dynamicRingHandles;
+	SDL_GPUBufferCreateInfo createInfo;
+	uint32_t start, size;
+
+	size = SDLGPU_INTERNAL_RoundToAlignment(
+		length,
+		DYNAMIC_RING_ALIGNMENT
+	);
+	start = SDLGPU_INTERNAL_RoundToAlignment(
+		renderer->dynamicRingOffset,
+		DYNAMIC_RING_ALIGNMENT
+	);
+	renderer->dynamicRingRequested += size;
+
+	if (renderer->dynamicRing == NULL)
+	{
+		createInfo.usage = (
+			SDL_GPU_BUFFERUSAGE_VERTEX |
+			SDL_GPU_BUFFERUSAGE_INDEX
+		);
+		createInfo.size = renderer->dynamicRingSize;
+		createInfo.props = 0;
+		renderer->dynamicRing = SDL_CreateGPUBuffer(
+			renderer->device,
+			&createInfo
+		);
+		if (renderer->dynamicRing == NULL)
+		{
+			FNA3D_LogError(
+				"Failed to create dynamic ring: %s",
+				SDL_GetError()
+			);
+		}
+	}
+
+	if (	renderer->dynamicRing == NULL ||
+		start + size > renderer->dynamicRingSize	)
+	{
+		/* Out of room, the buffer cycles on its own until next frame */
+		if (handle->ringRedirect)
+		{
+			SDLGPU_INTERNAL_UnlinkRingHandle(renderer, handle);
+		}
+		return 0;
+	}
+
+	renderer->dynamicRingOffset = start + size;
+	handle->ringOffset = start;
+	handle->ringSize = size;
+	if (!handle->ringRedirect)
+	{
+		EXPAND_ARRAY_IF_NEEDED(arr, 4, SDLGPU_BufferHandle*)
+		arr->elements[arr->count] = handle;
+		arr->count += 1;
+		handle->ringRedirect = 1;
+	}
+	return 1;
+}
+
+static uint8_t SDLGPU_INTERNAL_GrowRingRegion(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_BufferHandle *handle,
+	uint32_t length
+) {
+	/* commandLock should be acquired by this point */
+
+	uint32_t size = SDLGPU_INTERNAL_RoundToAlignment(
+		length,
+		DYNAMIC_RING_ALIGNMENT
+	);
+
+	if (size <= handle->ringSize)
+	{
+		return 1;
+	}
+	renderer->dynamicRingRequested += size - handle->ringSize;
+
+	/* Only the newest region has free space after it */
+	if (	handle->ringOffset + handle->ringSize != renderer->dynamicRingOffset ||
+		handle->ringOffset + size > renderer->dynamicRingSize	)
+	{
+		return 0;
+	}
+
+	renderer->dynamicRingOffset = handle->ringOffset + size;
+	handle->ringSize = size;
+	return 1;
+}
+
+static void SDLGPU_INTERNAL_FlushRingUploads(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDL_GPUTransferBufferLocation transferLocation;
+	SDL_GPUBufferRegion bufferRegion;
+
+	if (renderer->ringUploadSize == 0)
+	{
+		return;
+	}
+
+	transferLocation.transfer_buffer = renderer->ringUploadStaging->transferBuffer;
+	transferLocation.offset = renderer->ringUploadSrcOffset;
+
+	bufferRegion.buffer = renderer->dynamicRing;
+	bufferRegion.offset = renderer->ringUploadDstOffset;
+	bufferRegion.size = renderer->ringUploadSize;
+
+	/* The first upload of a frame cycles, so last frame's draws and
+	 * copy-backs keep reading the old contents.
+	 */
+	SDLGPU_INTERNAL_BeginCopyPass(renderer);
+	SDL_UploadToGPUBuffer(
+		renderer->copyPass,
+		&transferLocation,
+		&bufferRegion,
+		renderer->dynamicRingCycle
+	);
+	renderer->dynamicRingCycle = 0;
+
+	renderer->ringUploadStaging = NULL;
+	renderer->ringUploadSize = 0;
+}
+
+static void SDLGPU_INTERNAL_RecordRingUpload(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_StagingBuffer *staging,
+	uint32_t srcOffset,
+	uint32_t dstOffset,
+	uint32_t dataLength
+) {
+	/* commandLock should be acquired by this point */
+
+	if (	renderer->ringUploadSize > 0 &&
+		renderer->ringUploadStaging == staging &&
+		renderer->ringUploadSrcOffset + renderer->ringUploadSize == srcOffset &&
+		renderer->ringUploadDstOffset + renderer->ringUploadSize == dstOffset	)
+	{
+		renderer->ringUploadSize += dataLength;
+		return;
+	}
+
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+	renderer->ringUploadStaging = staging;
+	renderer->ringUploadSrcOffset = srcOffset;
+	renderer->ringUploadDstOffset = dstOffset;
+	renderer->ringUploadSize = dataLength;
+}
+
+static void SDLGPU_INTERNAL_ReturnRingRegion(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_BufferHandle *handle
+) {
+	/* commandLock should be acquired by this point */
+
+	SDL_GPUBufferLocation src, dst;
+
+	/* The region has everything written since the discard, the buffer
+	 * gets it back so writes the ring can't take can go there instead.
+	 * Cycling keeps this frame's earlier draws on the old contents.
+	 */
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+	SDLGPU_INTERNAL_BeginCopyPass(renderer);
+	src.buffer = renderer->dynamicRing;
+	src.offset = handle->ringOffset;
+	dst.buffer = handle->buffer;
+	dst.offset = 0;
+	SDL_CopyGPUBufferToBuffer(
+		renderer->copyPass,
+		&src,
+		&dst,
+		SDL_min(handle->ringSize, handle->size),
+		true
+	);
+	SDLGPU_INTERNAL_UnlinkRingHandle(renderer, handle);
+}
+
+static void SDLGPU_INTERNAL_ResolveDynamicRing(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDLGPU_BufferHandleArray *arr = &renderer->dynamicRingHandles;
+	SDL_GPUCopyPass *copyPass;
+	SDL_GPUBufferLocation src, dst;
+	int32_t i;
+
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+
+	/* Redirected buffers get their final contents back, in case they are
+	 * drawn again without new data.
+	 */
+	if (arr->count > 0)
+	{
+		copyPass = SDL_BeginGPUCopyPass(renderer->renderCommandBuffer);
+		for (i = 0; i < arr->count; i += 1)
+		{
+			src.buffer = renderer->dynamicRing;
+			src.offset = arr->elements[i]->ringOffset;
+			dst.buffer = arr->elements[i]->buffer;
+			dst.offset = 0;
+			SDL_CopyGPUBufferToBuffer(
+				copyPass,
+				&src,
+				&dst,
+				SDL_min(arr->elements[i]->ringSize, arr->elements[i]->size),
+				true
+			);
+			arr->elements[i]->ringRedirect = 0;
+		}
+		SDL_EndGPUCopyPass(copyPass);
+		arr->count = 0;
+	}
+
+	if (renderer->dynamicRingRequested > renderer->dynamicRingSize)
+	{
+		while (	renderer->dynamicRingSize < renderer->dynamicRingRequested &&
+			renderer->dynamicRingSize < 0x80000000	)
+		{
+			renderer->dynamicRingSize *= 2;
+		}
+		if (renderer->dynamicRing != NULL)
+		{
+			SDL_ReleaseGPUBuffer(renderer->device, renderer->dynamicRing);
+			renderer->dynamicRing = NULL;
+		}
+	}
+
+	renderer->dynamicRingOffset = 0;
+	renderer->dynamicRingRequested = 0;
+	renderer->dynamicRingCycle = 1;
+}
+
+static void SDLGPU_INTERNAL_ResetUploadCommandBufferState(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	renderer->uploadCommandBuffer = SDL_AcquireGPUCommandBuffer(renderer->device);
+	SDLGPU_INTERNAL_BeginCopyPass(renderer);
+}
+
+static void SDLGPU_INTERNAL_ResetRenderCommandBufferState(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	renderer->renderCommandBuffer = SDL_AcquireGPUCommandBuffer(renderer->device);
+
+	/* Reset state */
+	renderer->needNewRenderPass = 1;
+	renderer->needNewGraphicsPipeline = 1;
+	renderer->needVertexBufferBind = 1;
+	renderer->needVertexSamplerBind = 1;
+	renderer->needFragmentSamplerBind = 1;
+}
+
+static void SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
+	SDLGPU_Renderer *renderer,
+	SDL_GPUFence **uploadFence /* May be NULL */
+) {
+	/* commandLock should be acquired by this point */
+
+	SDLGPU_StagingBufferArray *pending = &renderer->stagingPending;
+	SDLGPU_StagingBufferArray *inFlight = &renderer->stagingInFlight;
+	SDLGPU_StagingBuffer *staging;
+	SDL_GPUFence *fence;
+	int32_t i, kept = 0;
+
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+	SDLGPU_INTERNAL_EndCopyPass(renderer);
+
+	if (uploadFence != NULL)
+	{
+		/* The caller owns this fence, so pending staging memory is
+		 * retired by the next submission instead, which cannot
+		 * complete before this one does.
+		 */
+		*uploadFence = SDL_SubmitGPUCommandBufferAndAcquireFence(
+			renderer->uploadCommandBuffer
+		);
+
+		if (!*uploadFence) {
+			const char *error = SDL_GetError();
+			FNA3D_LogError("SDL_SubmitGPUCommandBufferAndAcquireFence failed: %s", error);
+		}
+	}
+	else if (pending->count > 0)
+	{
+		fence = SDL_SubmitGPUCommandBufferAndAcquireFence(
+			renderer->uploadCommandBuffer
+		);
+
+		if (fence == NULL)
+		{
+			const char *error = SDL_GetError();
+			FNA3D_LogError("SDL_SubmitGPUCommandBufferAndAcquireFence failed: %s", error);
+
+			/* Nothing to wait on, so make sure the GPU is done */
+			SDL_WaitForGPUIdle(renderer->device);
+		}
+
+		for (i = 0; i < pending->count; i += 1)
+		{
+			staging = pending->elements[i];
+			if (staging->writers > 0)
+			{
+				/* Another thread is still copying into this one,
+				 * its upload will be part of the next submission.
+				 */
+				pending->elements[kept] = staging;
+				kept += 1;
+			}
+			else if (fence == NULL)
+			{
+				SDLGPU_INTERNAL_ReturnStagingBuffer(renderer, staging);
+			}
+			else
+			{
+				staging->fence = fence;
+				EXPAND_ARRAY_IF_NEEDED(inFlight, 4, SDLGPU_StagingBuffer*)
+				inFlight->elements[inFlight->count] = staging;
+				inFlight->count += 1;
+			}
+		}
+
+		if (	renderer->stagingCurrent != NULL &&
+			renderer->stagingCurrent->writers == 0	)
+		{
+			renderer->stagingCurrent = NULL;
+		}
+		if (fence != NULL && kept == pending->count)
+		{
+			/* Every buffer was kept, nothing refers to this fence */
+			SDL_ReleaseGPUFence(renderer->device, fence);
+		}
+		pending->count = kept;
+	}
+	else
+	{
+		SDL_SubmitGPUCommandBuffer(renderer->uploadCommandBuffer);
+	}
+
+	SDLGPU_INTERNAL_ResetUploadCommandBufferState(renderer);
+}
+
+static void SDLGPU_INTERNAL_FlushCommands(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(renderer, NULL);
+
+	SDLGPU_INTERNAL_EndRenderPass(renderer);
+	SDL_SubmitGPUCommandBuffer(renderer->renderCommandBuffer);
+	SDLGPU_INTERNAL_ResetRenderCommandBufferState(renderer);
+}
+
+static void SDLGPU_INTERNAL_FlushCommandsAndAcquireFence(
+	SDLGPU_Renderer *renderer,
+	SDL_GPUFence **renderFence
+) {
+	/* commandLock should be acquired by this point */
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(renderer, NULL);
+
+	SDLGPU_INTERNAL_EndRenderPass(renderer);
+	*renderFence = SDL_SubmitGPUCommandBufferAndAcquireFence(
+		renderer->renderCommandBuffer
+	);
+
+	if (!*renderFence) {
+		const char *error = SDL_GetError();
+		FNA3D_LogError("SDL_SubmitGPUCommandBufferAndAcquireFence failed: %s", error);
+	}
+
+	SDLGPU_INTERNAL_ResetRenderCommandBufferState(renderer);
+}
+
+static void SDLGPU_INTERNAL_FlushCommandsAndStall(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDL_GPUFence* fences[2];
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(renderer, &fences[0]);
+
+	SDLGPU_INTERNAL_EndRenderPass(renderer);
+
+	fences[1] = SDL_SubmitGPUCommandBufferAndAcquireFence(
+		renderer->renderCommandBuffer
+	);
+
+	SDLGPU_INTERNAL_ResetRenderCommandBufferState(renderer);
+
+	SDL_WaitForGPUFences(
+		renderer->device,
+		1,
+		fences,
+		2
+	);
+
+	SDL_ReleaseGPUFence(
+		renderer->device,
+		fences[0]
+	);
+
+	SDL_ReleaseGPUFence(
+		renderer->device,
+		fences[1]
+	);
+}
+
+static void SDLGPU_INTERNAL_FlushUploadCommandsAndStall(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDL_GPUFence* fences[1];
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
+		renderer,
+		&fences[0]
+	);
+
+	SDL_WaitForGPUFences(
+		renderer->device,
+		1,
+		fences,
+		1
+	);
+
+	SDL_ReleaseGPUFence(
+		renderer->device,
+		fences[0]
 	);
+}
+
+/* Cache Eviction */
+
+static uint8_t SDLGPU_INTERNAL_SamplerIsBound(
+	SDLGPU_Renderer *renderer,
+	SDL_GPUSampler *sampler
+) {
+	int32_t i;
+
+	for (i = 0; i < MAX_TEXTURE_SAMPLERS; i += 1)
+	{
+		if (renderer->fragmentTextureSamplerBindings[i].sampler == sampler)
+		{
+			return 1;
+		}
+	}
+	for (i = 0; i < MAX_VERTEXTEXTURE_SAMPLERS; i += 1)
+	{
+		if (renderer->vertexTextureSamplerBindings[i].sampler == sampler)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void SDLGPU_INTERNAL_EvictCaches(
+	SDLGPU_Renderer *renderer
+) {
+	/* Entries touched within MAX_FRAMES_IN_FLIGHT frames may still be
+	 * referenced by a submitted command buffer, so they are never evicted.
+	 * SDL_GPU defers the actual release until the GPU is done with them.
+	 */
+	GraphicsPipelineHashTable *table = &renderer->graphicsPipelineHashTable;
+	SamplerStateHashArray *samplers = &renderer->samplerStateArray;
+	GraphicsPipelineHashArray *arr, *oldestArr;
+	int32_t i, j, oldestIndex;
+	uint64_t oldestFrame;
+
+	if (renderer->frameCounter < MAX_FRAMES_IN_FLIGHT)
+	{
+		return;
+	}
+
+	while (	renderer->maxCachedPipelines > 0 &&
+		table->count > renderer->maxCachedPipelines	)
+	{
+		oldestArr = NULL;
+		oldestIndex = -1;
+		oldestFrame = renderer->frameCounter - MAX_FRAMES_IN_FLIGHT;
+		for (i = 0; i < NUM_PIPELINE_HASH_BUCKETS; i += 1)
+		{
+			arr = &table->buckets[i];
+			for (j = 0; j < arr->count; j += 1)
+			{
+				if (	arr->elements[j].lastUsedFrame <= oldestFrame &&
+					arr->elements[j].value != renderer->currentGraphicsPipeline	)
+				{
+					oldestArr = arr;
+					oldestIndex = j;
+					oldestFrame = arr->elements[j].lastUsedFrame;
+				}
+			}
+		}
+
+		if (oldestArr == NULL)
+		{
+			/* Everything left is still hot, try again next frame */
+			break;
+		}
+
+		if (oldestArr->elements[oldestIndex].value != NULL)
+		{
+			SDL_ReleaseGPUGraphicsPipeline(
+				renderer->device,
+				oldestArr->elements[oldestIndex].value
+			);
+		}
+		oldestArr->elements[oldestIndex] = oldestArr->elements[oldestArr->count - 1];
+		oldestArr->count -= 1;
+		table->count -= 1;
+	}
+
+	while (	renderer->maxCachedSamplers > 0 &&
+		samplers->count > renderer->maxCachedSamplers	)
+	{
+		oldestIndex = -1;
+		oldestFrame = renderer->frameCounter - MAX_FRAMES_IN_FLIGHT;
+		for (i = 0; i < samplers->count; i += 1)
+		{
+			if (	samplers->elements[i].lastUsedFrame <= oldestFrame &&
+				!SDLGPU_INTERNAL_SamplerIsBound(renderer, samplers->elements[i].value)	)
+			{
+				oldestIndex = i;
+				oldestFrame = samplers->elements[i].lastUsedFrame;
+			}
+		}
+
+		if (oldestIndex < 0)
+		{
+			break;
+		}
+
+		SDL_ReleaseGPUSampler(
+			renderer->device,
+			samplers->elements[oldestIndex].value
+		);
+		samplers->elements[oldestIndex] = samplers->elements[samplers->count - 1];
+		samplers->count -= 1;
+	}
+}
 
-	SDLGPU_INTERNAL_ResetRenderCommandBufferState(renderer);
+/* Backbuffer Capture */
+
+static void SDLGPU_INTERNAL_DeliverCaptureFrame(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_CaptureFrame *frame
+) {
+	/* commandLock should be acquired by this point */
+
+	uint8_t *src;
+
+	if (frame->fence == NULL)
+	{
+		return;
+	}
 
+	/* Normally signaled long ago, this only waits when the GPU is behind */
 	SDL_WaitForGPUFences(
 		renderer->device,
 		1,
-		fences,
-		2
+		&frame->fence,
+		1
 	);
+	SDL_ReleaseGPUFence(renderer->device, frame->fence);
+	frame->fence = NULL;
 
-	SDL_ReleaseGPUFence(
+	src = (uint8_t*) SDL_MapGPUTransferBuffer(
 		renderer->device,
-		fences[0]
+		frame->transferBuffer,
+		false
 	);
-
-	SDL_ReleaseGPUFence(
-		renderer->device,
-		fences[1]
+	renderer->captureCallback(
+		src,
+		(int32_t) frame->width,
+		(int32_t) frame->height,
+		(int32_t) frame->dataLength,
+		renderer->captureUserdata
 	);
+	SDL_UnmapGPUTransferBuffer(renderer->device, frame->transferBuffer);
 }
 
-static void SDLGPU_INTERNAL_FlushUploadCommandsAndStall(
+static void SDLGPU_INTERNAL_FlushCaptureFrames(
 	SDLGPU_Renderer *renderer
 ) {
 	/* commandLock should be acquired by this point */
 
-	SDL_GPUFence* fences[1];
+	SDLGPU_CaptureFrame *frame;
+	int32_t i;
 
-	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
-		renderer,
-		&fences[0]
+	/* Oldest first, which is the next slot to be reused */
+	for (i = 0; i < renderer->captureFrameCount; i += 1)
+	{
+		frame = &renderer->captureFrames[
+			(renderer->captureIndex + i) % renderer->captureFrameCount
+		];
+		SDLGPU_INTERNAL_DeliverCaptureFrame(renderer, frame);
+		if (frame->transferBuffer != NULL)
+		{
+			SDL_ReleaseGPUTransferBuffer(
+				renderer->device,
+				frame->transferBuffer
+			);
+			frame->transferBuffer = NULL;
+			frame->transferBufferSize = 0;
+		}
+	}
+	renderer->captureIndex = 0;
+}
+
+static SDLGPU_CaptureFrame* SDLGPU_INTERNAL_CaptureBackbuffer(
+	SDLGPU_Renderer *renderer
+) {
+	/* commandLock should be acquired by this point */
+
+	SDLGPU_CaptureFrame *frame = &renderer->captureFrames[renderer->captureIndex];
+	SDLGPU_TextureHandle *backbuffer = renderer->fauxBackbufferColorTexture;
+	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
+	SDL_GPUTextureRegion region;
+	SDL_GPUTextureTransferInfo textureCopyParams;
+	SDL_GPUCopyPass *copyPass;
+
+	/* Make room by handing off the oldest frame */
+	SDLGPU_INTERNAL_DeliverCaptureFrame(renderer, frame);
+
+	frame->width = backbuffer->createInfo.width;
+	frame->height = backbuffer->createInfo.height;
+	frame->dataLength = (
+		frame->width *
+		frame->height *
+		SDL_GPUTextureFormatTexelBlockSize(backbuffer->createInfo.format)
 	);
 
-	SDL_WaitForGPUFences(
-		renderer->device,
-		1,
-		fences,
-		1
+	if (frame->transferBufferSize < frame->dataLength)
+	{
+		if (frame->transferBuffer != NULL)
+		{
+			SDL_ReleaseGPUTransferBuffer(
+				renderer->device,
+				frame->transferBuffer
+			);
+		}
+
+		transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+		transferBufferCreateInfo.size = frame->dataLength;
+		transferBufferCreateInfo.props = 0;
+		frame->transferBuffer = SDL_CreateGPUTransferBuffer(
+			renderer->device,
+			&transferBufferCreateInfo
+		);
+
+		if (frame->transferBuffer == NULL)
+		{
+			FNA3D_LogError(
+				"Failed to create capture buffer: %s",
+				SDL_GetError()
+			);
+			frame->transferBufferSize = 0;
+			return NULL;
+		}
+		frame->transferBufferSize = frame->dataLength;
+	}
+
+	region.texture = backbuffer->texture;
+	region.mip_level = 0;
+	region.layer = 0;
+	region.x = 0;
+	region.y = 0;
+	region.z = 0;
+	region.w = frame->width;
+	region.h = frame->height;
+	region.d = 1;
+
+	/* All zeroes, assume tight packing */
+	textureCopyParams.transfer_buffer = frame->transferBuffer;
+	textureCopyParams.offset = 0;
+	textureCopyParams.pixels_per_row = 0;
+	textureCopyParams.rows_per_layer = 0;
+
+	/* Recorded on the render commands, so it sees this frame's rendering */
+	copyPass = SDL_BeginGPUCopyPass(renderer->renderCommandBuffer);
+	SDL_DownloadFromGPUTexture(
+		copyPass,
+		&region,
+		&textureCopyParams
 	);
+	SDL_EndGPUCopyPass(copyPass);
 
-	SDL_ReleaseGPUFence(
-		renderer->device,
-		fences[0]
+	renderer->captureIndex = (
+		(renderer->captureIndex + 1) % renderer->captureFrameCount
 	);
+	return frame;
 }
 
 static bool SDLGPU_INTERNAL_ClaimWindow(
@@ -1125,12 +2311,14 @@ static void SDLGPU_SwapBuffers(
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDL_GPUTexture *swapchainTexture;
 	SDL_GPUBlitInfo blitInfo;
+	SDLGPU_CaptureFrame *captureFrame = NULL;
 	uint32_t width, height;
 	uint32_t i;
 
 	SDL_LockMutex(renderer->commandLock);
 	SDLGPU_INTERNAL_EndCopyPass(renderer);
 	SDLGPU_INTERNAL_EndRenderPass(renderer);
+	SDLGPU_INTERNAL_ResolveDynamicRing(renderer);
 
 	if (!SDLGPU_INTERNAL_ClaimWindow(
 		renderer,
@@ -1200,7 +2388,25 @@ static void SDLGPU_SwapBuffers(
 		);
 	}
 
-	SDLGPU_INTERNAL_FlushCommands(renderer);
+	if (renderer->captureCallback != NULL)
+	{
+		captureFrame = SDLGPU_INTERNAL_CaptureBackbuffer(renderer);
+	}
+
+	if (captureFrame != NULL)
+	{
+		SDLGPU_INTERNAL_FlushCommandsAndAcquireFence(
+			renderer,
+			&captureFrame->fence
+		);
+	}
+	else
+	{
+		SDLGPU_INTERNAL_FlushCommands(renderer);
+	}
+
+	renderer->frameCounter += 1;
+	SDLGPU_INTERNAL_EvictCaches(renderer);
 
 	/* Reset bound RT state */
 	for (i = 0; i < renderer->boundRenderTargetCount; i += 1)
@@ -1318,6 +2524,48 @@ static void SDLGPU_Clear(
 	);
 }
 
+static uint8_t SDLGPU_INTERNAL_RenderPassMatchesNext(
+	SDLGPU_Renderer *renderer
+) {
+	uint32_t i;
+
+	if (renderer->renderPass == NULL)
+	{
+		return 0;
+	}
+
+	if (renderer->currentRenderPassColorAttachmentCount != renderer->nextRenderPassColorAttachmentCount)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < renderer->nextRenderPassColorAttachmentCount; i += 1)
+	{
+		if (	renderer->currentRenderPassColorAttachments[i] != renderer->nextRenderPassColorAttachments[i]->texture ||
+			renderer->currentRenderPassColorAttachmentCubeFace[i] != renderer->nextRenderPassColorAttachmentCubeFace[i]	)
+		{
+			return 0;
+		}
+		if (renderer->nextRenderPassColorResolves[i] == NULL)
+		{
+			if (renderer->currentRenderPassColorResolves[i] != NULL)
+			{
+				return 0;
+			}
+		}
+		else if (renderer->currentRenderPassColorResolves[i] != renderer->nextRenderPassColorResolves[i]->texture)
+		{
+			return 0;
+		}
+	}
+
+	if (renderer->nextRenderPassDepthStencilAttachment == NULL)
+	{
+		return renderer->currentRenderPassDepthStencilAttachment == NULL;
+	}
+	return renderer->currentRenderPassDepthStencilAttachment == renderer->nextRenderPassDepthStencilAttachment->texture;
+}
+
 static void SDLGPU_SetRenderTargets(
 	FNA3D_Renderer *driverData,
 	FNA3D_RenderTargetBinding *renderTargets,
@@ -1428,7 +2676,16 @@ static void SDLGPU_SetRenderTargets(
 		renderer->nextPipelineHash.depthStencilFormat = SDL_GPU_TEXTUREFORMAT_D16_UNORM;
 	}
 
-	renderer->needNewRenderPass = 1;
+	/* Rebinding the attachments of the active pass is a no-op, and ending
+	 * it anyway would cost a full store and load of every attachment.
+	 * Pending clears were flushed above, so there is nothing else to apply.
+	 */
+	SDL_LockMutex(renderer->commandLock);
+	if (!SDLGPU_INTERNAL_RenderPassMatchesNext(renderer))
+	{
+		renderer->needNewRenderPass = 1;
+	}
+	SDL_UnlockMutex(renderer->commandLock);
 }
 
 static void SDLGPU_ResolveTarget(
@@ -1455,11 +2712,12 @@ static void SDLGPU_ResolveTarget(
 
 static void SDLGPU_INTERNAL_GenerateVertexInputInfo(
 	SDLGPU_Renderer *renderer,
-	SDL_GPUVertexBufferDescription *bindings,
-	SDL_GPUVertexAttribute *attributes,
-	uint32_t *attributeCount
+	MOJOSHADER_sdlShaderData *vertexShader,
+	VertexInputInfo *info
 ) {
-	MOJOSHADER_sdlShaderData *vertexShader, *blah;
+	VertexInputLayout layout;
+	SDL_GPUVertexBufferDescription *bindings = layout.vertexDescriptions;
+	SDL_GPUVertexAttribute *attributes = layout.vertexAttributes;
 	uint8_t attrUse[MOJOSHADER_USAGE_TOTAL][16];
 	uint32_t attributeDescriptionCounter = 0;
 	int32_t i, j, k;
@@ -1469,8 +2727,7 @@ static void SDLGPU_INTERNAL_GenerateVertexInputInfo(
 	MOJOSHADER_vertexAttribute mojoshaderVertexAttributes[16];
 	int32_t index, attribLoc;
 
-	MOJOSHADER_sdlGetBoundShaderData(renderer->mojoshaderContext, &vertexShader, &blah);
-
+	SDL_zero(layout);
 	SDL_memset(attrUse, '\0', sizeof(attrUse));
 	for (i = 0; i < (int32_t) renderer->numVertexBindings; i += 1)
 	{
@@ -1551,45 +2808,92 @@ static void SDLGPU_INTERNAL_GenerateVertexInputInfo(
 		}
 	}
 
-	*attributeCount = attributeDescriptionCounter;
+	layout.numVertexBindings = renderer->numVertexBindings;
+	layout.numVertexAttributes = attributeDescriptionCounter;
+	info->layoutIndex = VertexInputLayoutArray_Intern(
+		&renderer->vertexInputLayouts,
+		&layout
+	);
 
-	MOJOSHADER_sdlLinkProgram(
+	info->program = MOJOSHADER_sdlLinkProgram(
 		renderer->mojoshaderContext,
 		mojoshaderVertexAttributes,
 		attributeDescriptionCounter
 	);
 	MOJOSHADER_sdlGetShaders(
 		renderer->mojoshaderContext,
-		&renderer->nextPipelineHash.vertShader,
-		&renderer->nextPipelineHash.fragShader
+		&info->vertShader,
+		&info->fragShader
 	);
 }
 
 static SDL_GPUGraphicsPipeline* SDLGPU_INTERNAL_FetchGraphicsPipeline(
-	SDLGPU_Renderer *renderer
+	SDLGPU_Renderer *renderer,
+	MOJOSHADER_sdlShaderData *vertShaderData,
+	MOJOSHADER_sdlShaderData *fragShaderData
 ) {
 	SDL_GPUGraphicsPipeline *pipeline;
 	SDL_GPUGraphicsPipelineCreateInfo createInfo;
 	SDL_GPUColorTargetDescription colorAttachmentDescriptions[MAX_RENDERTARGET_BINDINGS];
-
-	/* We have to do this to link the vertex attribute modified shader program */
-	SDLGPU_INTERNAL_GenerateVertexInputInfo(
-		renderer,
-		renderer->vertexDescriptions,
-		renderer->vertexAttributes,
-		&renderer->numVertexAttributes
+	VertexInputHash vertexInputHash;
+	VertexInputInfo *vertexInput;
+	VertexInputLayout *layout;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_GRAPHICSPIPELINE_EXT
+	];
+	uint64_t createStart;
+
+	/* Can we just reuse the vertex attribute modified shader program? */
+	vertexInputHash.vertexBufferBindingsIndex = renderer->currentVertexBufferBindingsIndex;
+	vertexInputHash.vertShaderData = vertShaderData;
+	vertexInputHash.fragShaderData = fragShaderData;
+	vertexInput = VertexInputHashTable_Fetch(
+		&renderer->vertexInputHashTable,
+		vertexInputHash
 	);
 
+	if (vertexInput != NULL)
+	{
+		MOJOSHADER_sdlBindProgram(
+			renderer->mojoshaderContext,
+			vertexInput->program
+		);
+	}
+	else
+	{
+		/* We have to do this to link the vertex attribute modified shader program */
+		vertexInput = (VertexInputInfo*) SDL_malloc(sizeof(VertexInputInfo));
+		SDLGPU_INTERNAL_GenerateVertexInputInfo(
+			renderer,
+			vertShaderData,
+			vertexInput
+		);
+		VertexInputHashTable_Insert(
+			&renderer->vertexInputHashTable,
+			vertexInputHash,
+			vertexInput
+		);
+	}
+
+	renderer->nextPipelineHash.vertShader = vertexInput->vertShader;
+	renderer->nextPipelineHash.fragShader = vertexInput->fragShader;
+	renderer->nextPipelineHash.vertexInputLayoutIndex = vertexInput->layoutIndex;
+
 	pipeline = GraphicsPipelineHashTable_Fetch(
 		&renderer->graphicsPipelineHashTable,
-		renderer->nextPipelineHash
+		renderer->nextPipelineHash,
+		renderer->frameCounter
 	);
 
 	if (pipeline != NULL)
 	{
+		stats->hits += 1;
 		return pipeline;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	createInfo.primitive_type = XNAToSDL_PrimitiveType[renderer->fnaPrimitiveType];
 
 	/* Active Shader */
@@ -1598,10 +2902,11 @@ static SDL_GPUGraphicsPipeline* SDLGPU_INTERNAL_FetchGraphicsPipeline(
 
 	/* Vertex Input State */
 
-	createInfo.vertex_input_state.vertex_buffer_descriptions = renderer->vertexDescriptions;
-	createInfo.vertex_input_state.num_vertex_buffers = renderer->numVertexBindings;
-	createInfo.vertex_input_state.vertex_attributes = renderer->vertexAttributes;
-	createInfo.vertex_input_state.num_vertex_attributes = renderer->numVertexAttributes;
+	layout = &renderer->vertexInputLayouts.elements[vertexInput->layoutIndex];
+	createInfo.vertex_input_state.vertex_buffer_descriptions = layout->vertexDescriptions;
+	createInfo.vertex_input_state.num_vertex_buffers = layout->numVertexBindings;
+	createInfo.vertex_input_state.vertex_attributes = layout->vertexAttributes;
+	createInfo.vertex_input_state.num_vertex_attributes = layout->numVertexAttributes;
 
 	/* Rasterizer */
 
@@ -1761,67 +3066,199 @@ static SDL_GPUGraphicsPipeline* SDLGPU_INTERNAL_FetchGraphicsPipeline(
 		FNA3D_LogError("Failed to create graphics pipeline!");
 	}
 
+	PipelineCacheStats_EndCreate(stats, createStart);
+
 	GraphicsPipelineHashTable_Insert(
 		&renderer->graphicsPipelineHashTable,
 		renderer->nextPipelineHash,
-		pipeline
+		pipeline,
+		renderer->frameCounter
 	);
 
 	return pipeline;
 }
 
+static int32_t SDLGPU_INTERNAL_GatherUniforms(
+	const MOJOSHADER_parseData *pd,
+	float *regF,
+	int *regI,
+	unsigned char *regB,
+	uint8_t *dst /* NULL to just measure */
+) {
+	const MOJOSHADER_uniform *uniform;
+	int32_t i, count, len;
+	int32_t total = 0;
+	const void *src;
+
+	if (pd == NULL)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < pd->uniform_count; i += 1)
+	{
+		uniform = &pd->uniforms[i];
+		count = (uniform->array_count > 0) ? uniform->array_count : 1;
+		if (uniform->type == MOJOSHADER_UNIFORM_FLOAT)
+		{
+			src = regF + (uniform->index * 4);
+			len = count * 4 * sizeof(float);
+		}
+		else if (uniform->type == MOJOSHADER_UNIFORM_INT)
+		{
+			src = regI + (uniform->index * 4);
+			len = count * 4 * sizeof(int);
+		}
+		else
+		{
+			src = regB + uniform->index;
+			len = count;
+		}
+		if (dst != NULL)
+		{
+			SDL_memcpy(dst + total, src, len);
+		}
+		total += len;
+	}
+	return total;
+}
+
+static uint8_t SDLGPU_INTERNAL_SnapshotUniforms(
+	SDLGPU_Renderer *renderer
+) {
+	const MOJOSHADER_parseData *vertParseData = renderer->shaderReflection.vertParseData;
+	const MOJOSHADER_parseData *fragParseData = renderer->shaderReflection.fragParseData;
+	float *vsf, *psf;
+	int *vsi, *psi;
+	unsigned char *vsb, *psb;
+	int32_t vertSize, size;
+	uint8_t *swap;
+	uint8_t changed;
+
+	MOJOSHADER_sdlMapUniformBufferMemory(
+		renderer->mojoshaderContext,
+		&vsf, &vsi, &vsb,
+		&psf, &psi, &psb
+	);
+
+	vertSize = SDLGPU_INTERNAL_GatherUniforms(vertParseData, vsf, vsi, vsb, NULL);
+	size = vertSize + SDLGPU_INTERNAL_GatherUniforms(fragParseData, psf, psi, psb, NULL);
+
+	if (size > renderer->uniformSnapshotCapacity)
+	{
+		renderer->uniformSnapshotCapacity = size;
+		renderer->uniformSnapshot = SDL_realloc(
+			renderer->uniformSnapshot,
+			size
+		);
+		renderer->uniformScratch = SDL_realloc(
+			renderer->uniformScratch,
+			size
+		);
+	}
+
+	SDLGPU_INTERNAL_GatherUniforms(vertParseData, vsf, vsi, vsb, renderer->uniformScratch);
+	SDLGPU_INTERNAL_GatherUniforms(fragParseData, psf, psi, psb, renderer->uniformScratch + vertSize);
+
+	MOJOSHADER_sdlUnmapUniformBufferMemory(renderer->mojoshaderContext);
+
+	changed = (
+		size != renderer->uniformSnapshotSize ||
+		SDL_memcmp(renderer->uniformScratch, renderer->uniformSnapshot, size) != 0
+	);
+	if (changed)
+	{
+		swap = renderer->uniformSnapshot;
+		renderer->uniformSnapshot = renderer->uniformScratch;
+		renderer->uniformScratch = swap;
+		renderer->uniformSnapshotSize = size;
+	}
+	return changed;
+}
+
 static void SDLGPU_INTERNAL_BindGraphicsPipeline(
 	SDLGPU_Renderer *renderer
 ) {
 	/* commandLock should be acquired by this point */
 
 	SDL_GPUGraphicsPipeline *pipeline;
-	MOJOSHADER_sdlShaderData *vertShaderData, *fragShaderData;
+	MOJOSHADER_sdlShaderData *vertShaderData = renderer->shaderReflection.vertShader;
+	MOJOSHADER_sdlShaderData *fragShaderData = renderer->shaderReflection.fragShader;
+	uint8_t shadersChanged;
 
-	MOJOSHADER_sdlGetBoundShaderData(
-		renderer->mojoshaderContext,
-		&vertShaderData,
-		&fragShaderData
+	shadersChanged = (
+		renderer->currentVertexShader != vertShaderData ||
+		renderer->currentFragmentShader != fragShaderData
 	);
 
 	if (
 		!renderer->needNewGraphicsPipeline &&
-		renderer->currentVertexShader == vertShaderData &&
-		renderer->currentFragmentShader == fragShaderData
+		!shadersChanged &&
+		!renderer->uniformsDirty &&
+		!renderer->needUniformPush
 	) {
 		return;
 	}
 
-	pipeline = SDLGPU_INTERNAL_FetchGraphicsPipeline(renderer);
-
-	SDL_LockMutex(renderer->commandLock);
-
-	if (pipeline != renderer->currentGraphicsPipeline)
+	/* Uniform-only changes don't need a pipeline lookup */
+	if (renderer->needNewGraphicsPipeline || shadersChanged)
 	{
-		SDL_BindGPUGraphicsPipeline(
-			renderer->renderPass,
-			pipeline
+		pipeline = SDLGPU_INTERNAL_FetchGraphicsPipeline(
+			renderer,
+			vertShaderData,
+			fragShaderData
 		);
 
-		renderer->currentGraphicsPipeline = pipeline;
-	}
+		SDL_LockMutex(renderer->commandLock);
 
-	MOJOSHADER_sdlUpdateUniformBuffers(
-		renderer->mojoshaderContext,
-		renderer->renderCommandBuffer
-	);
+		if (pipeline != renderer->currentGraphicsPipeline)
+		{
+			SDL_BindGPUGraphicsPipeline(
+				renderer->renderPass,
+				pipeline
+			);
 
-	SDL_UnlockMutex(renderer->commandLock);
+			renderer->currentGraphicsPipeline = pipeline;
+		}
 
-	renderer->currentVertexShader = vertShaderData;
-	renderer->currentFragmentShader = fragShaderData;
+		SDL_UnlockMutex(renderer->commandLock);
 
-	/* Reset deferred binding state */
-	renderer->needNewGraphicsPipeline = 0;
-	renderer->needFragmentSamplerBind = 1;
-	renderer->needVertexSamplerBind = 1;
-	renderer->needVertexBufferBind = 1;
-	renderer->indexBufferBinding.buffer = NULL;
+		renderer->currentVertexShader = vertShaderData;
+		renderer->currentFragmentShader = fragShaderData;
+
+		/* Reset deferred binding state */
+		renderer->needNewGraphicsPipeline = 0;
+		renderer->needFragmentSamplerBind = 1;
+		renderer->needVertexSamplerBind = 1;
+		renderer->needVertexBufferBind = 1;
+		renderer->indexBufferBinding.buffer = NULL;
+	}
+
+	/* A new shader pair has a new uniform layout, so always push for those.
+	 * Otherwise only push when the registers they read have changed.
+	 */
+	if (shadersChanged || renderer->needUniformPush)
+	{
+		SDLGPU_INTERNAL_SnapshotUniforms(renderer);
+		renderer->needUniformPush = 1;
+	}
+	else if (renderer->uniformsDirty)
+	{
+		renderer->needUniformPush = SDLGPU_INTERNAL_SnapshotUniforms(renderer);
+	}
+
+	if (renderer->needUniformPush)
+	{
+		SDL_LockMutex(renderer->commandLock);
+		MOJOSHADER_sdlUpdateUniformBuffers(
+			renderer->mojoshaderContext,
+			renderer->renderCommandBuffer
+		);
+		SDL_UnlockMutex(renderer->commandLock);
+	}
+
+	renderer->uniformsDirty = 0;
+	renderer->needUniformPush = 0;
 }
 
 static SDL_GPUSampler* SDLGPU_INTERNAL_FetchSamplerState(
@@ -1830,17 +3267,26 @@ static SDL_GPUSampler* SDLGPU_INTERNAL_FetchSamplerState(
 ) {
 	SDL_GPUSamplerCreateInfo samplerCreateInfo;
 	SDL_GPUSampler *sampler;
+	FNA3D_PipelineCacheCountersEXT *stats = &renderer->cacheStats[
+		FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT
+	];
+	uint64_t createStart;
 
 	PackedState hash = GetPackedSamplerState(*samplerState);
 	sampler = SamplerStateHashArray_Fetch(
 		&renderer->samplerStateArray,
-		hash
+		hash,
+		renderer->frameCounter
 	);
 	if (sampler != NULL)
 	{
+		stats->hits += 1;
 		return sampler;
 	}
 
+	stats->misses += 1;
+	createStart = PipelineCacheStats_BeginCreate();
+
 	samplerCreateInfo.mag_filter = XNAToSDL_MagFilter[samplerState->filter];
 	samplerCreateInfo.min_filter = XNAToSDL_MinFilter[samplerState->filter];
 	samplerCreateInfo.mipmap_mode = XNAToSDL_MipFilter[samplerState->filter];
@@ -1868,6 +3314,8 @@ static SDL_GPUSampler* SDLGPU_INTERNAL_FetchSamplerState(
 		&samplerCreateInfo
 	);
 
+	PipelineCacheStats_EndCreate(stats, createStart);
+
 	if (sampler == NULL)
 	{
 		FNA3D_LogError("Failed to create sampler!");
@@ -1877,12 +3325,30 @@ static SDL_GPUSampler* SDLGPU_INTERNAL_FetchSamplerState(
 	SamplerStateHashArray_Insert(
 		&renderer->samplerStateArray,
 		hash,
-		sampler
+		sampler,
+		renderer->frameCounter
 	);
 
 	return sampler;
 }
 
+static inline void SDLGPU_INTERNAL_MarkSamplerDirty(
+	uint32_t *dirtyStart,
+	uint32_t *dirtyEnd,
+	int32_t index
+) {
+	if (*dirtyStart >= *dirtyEnd)
+	{
+		*dirtyStart = (uint32_t) index;
+		*dirtyEnd = (uint32_t) index + 1;
+	}
+	else
+	{
+		*dirtyStart = SDL_min(*dirtyStart, (uint32_t) index);
+		*dirtyEnd = SDL_max(*dirtyEnd, (uint32_t) index + 1);
+	}
+}
+
 static void SDLGPU_VerifyVertexSampler(
 	FNA3D_Renderer *driverData,
 	int32_t index,
@@ -1891,65 +3357,63 @@ static void SDLGPU_VerifyVertexSampler(
 ) {
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDLGPU_TextureHandle *textureHandle = (SDLGPU_TextureHandle*) texture;
+	SDL_GPUTextureSamplerBinding *binding = &renderer->vertexTextureSamplerBindings[index];
+	SDL_GPUTexture *gpuTexture;
 	SDL_GPUSampler *gpuSampler;
-	MOJOSHADER_sdlShaderData *vertShader, *blah;
 	MOJOSHADER_samplerType samplerType;
 
-	MOJOSHADER_sdlGetBoundShaderData(renderer->mojoshaderContext, &vertShader, &blah);
-
-	renderer->needVertexSamplerBind = 1;
-
 	if (texture == NULL || sampler == NULL)
 	{
-		renderer->vertexTextureSamplerBindings[index].sampler = renderer->dummySampler;
-
-		if (vertShader)
+		samplerType = renderer->shaderReflection.vertSamplerTypes[index];
+		if (samplerType == MOJOSHADER_SAMPLER_2D)
 		{
-			const MOJOSHADER_parseData *pd = MOJOSHADER_sdlGetShaderParseData(vertShader);
-			if (index < pd->sampler_count)
-			{
-				samplerType = MOJOSHADER_sdlGetShaderParseData(vertShader)->samplers[index].type;
-
-				if (samplerType == MOJOSHADER_SAMPLER_2D)
-				{
-					renderer->vertexTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
-				}
-				else if (samplerType == MOJOSHADER_SAMPLER_VOLUME)
-				{
-					renderer->vertexTextureSamplerBindings[index].texture = renderer->dummyTexture3D;
-				}
-				else
-				{
-					renderer->vertexTextureSamplerBindings[index].texture = renderer->dummyTextureCube;
-				}
-			}
-			else
-			{
-				renderer->vertexTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
-			}
+			gpuTexture = renderer->dummyTexture2D;
+		}
+		else if (samplerType == MOJOSHADER_SAMPLER_VOLUME)
+		{
+			gpuTexture = renderer->dummyTexture3D;
 		}
 		else
 		{
-			renderer->vertexTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
+			gpuTexture = renderer->dummyTextureCube;
+		}
+
+		renderer->vertexSamplerTextures[index] = NULL;
+		gpuSampler = renderer->dummySampler;
+	}
+	else
+	{
+		/* Nothing to do if this slot hasn't changed since the last call */
+		if (	textureHandle == renderer->vertexSamplerTextures[index] &&
+			textureHandle->texture == binding->texture &&
+			SDL_memcmp(
+				sampler,
+				&renderer->vertexSamplerStates[index],
+				sizeof(FNA3D_SamplerState)
+			) == 0	)
+		{
+			return;
 		}
 
-		return;
-	}
+		gpuTexture = textureHandle->texture;
+		gpuSampler = SDLGPU_INTERNAL_FetchSamplerState(
+			renderer,
+			sampler
+		);
 
-	if (textureHandle->texture != renderer->vertexTextureSamplerBindings[index].texture)
-	{
-		renderer->vertexTextureSamplerBindings[index].texture = textureHandle->texture;
+		renderer->vertexSamplerTextures[index] = textureHandle;
+		renderer->vertexSamplerStates[index] = *sampler;
 	}
 
-	gpuSampler = SDLGPU_INTERNAL_FetchSamplerState(
-		renderer,
-		sampler
-	);
-
-	if (gpuSampler != renderer->vertexTextureSamplerBindings[index].sampler)
+	if (gpuTexture != binding->texture || gpuSampler != binding->sampler)
 	{
-		renderer->vertexTextureSamplerBindings[index].sampler = gpuSampler;
-		renderer->needVertexSamplerBind = 1;
+		binding->texture = gpuTexture;
+		binding->sampler = gpuSampler;
+		SDLGPU_INTERNAL_MarkSamplerDirty(
+			&renderer->vertexSamplerDirtyStart,
+			&renderer->vertexSamplerDirtyEnd,
+			index
+		);
 	}
 }
 
@@ -1961,64 +3425,63 @@ static void SDLGPU_VerifySampler(
 ) {
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDLGPU_TextureHandle *textureHandle = (SDLGPU_TextureHandle*) texture;
+	SDL_GPUTextureSamplerBinding *binding = &renderer->fragmentTextureSamplerBindings[index];
+	SDL_GPUTexture *gpuTexture;
 	SDL_GPUSampler *gpuSampler;
-	MOJOSHADER_sdlShaderData *blah, *fragShader;
 	MOJOSHADER_samplerType samplerType;
 
-	MOJOSHADER_sdlGetBoundShaderData(renderer->mojoshaderContext, &blah, &fragShader);
-
-	renderer->needFragmentSamplerBind = 1;
-
 	if (texture == NULL || sampler == NULL)
 	{
-		renderer->fragmentTextureSamplerBindings[index].sampler = renderer->dummySampler;
-
-		if (fragShader)
+		samplerType = renderer->shaderReflection.fragSamplerTypes[index];
+		if (samplerType == MOJOSHADER_SAMPLER_2D)
 		{
-			const MOJOSHADER_parseData *pd = MOJOSHADER_sdlGetShaderParseData(fragShader);
-			if (index < pd->sampler_count)
-			{
-				samplerType = pd->samplers[index].type;
-				if (samplerType == MOJOSHADER_SAMPLER_2D)
-				{
-					renderer->fragmentTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
-				}
-				else if (samplerType == MOJOSHADER_SAMPLER_VOLUME)
-				{
-					renderer->fragmentTextureSamplerBindings[index].texture = renderer->dummyTexture3D;
-				}
-				else
-				{
-					renderer->fragmentTextureSamplerBindings[index].texture = renderer->dummyTextureCube;
-				}
-			}
-			else
-			{
-				renderer->fragmentTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
-			}
+			gpuTexture = renderer->dummyTexture2D;
+		}
+		else if (samplerType == MOJOSHADER_SAMPLER_VOLUME)
+		{
+			gpuTexture = renderer->dummyTexture3D;
 		}
 		else
 		{
-			renderer->fragmentTextureSamplerBindings[index].texture = renderer->dummyTexture2D;
+			gpuTexture = renderer->dummyTextureCube;
 		}
 
-		return;
+		renderer->fragmentSamplerTextures[index] = NULL;
+		gpuSampler = renderer->dummySampler;
 	}
-
-	if (textureHandle->texture != renderer->fragmentTextureSamplerBindings[index].texture)
+	else
 	{
-		renderer->fragmentTextureSamplerBindings[index].texture = textureHandle->texture;
-	}
+		/* Nothing to do if this slot hasn't changed since the last call */
+		if (	textureHandle == renderer->fragmentSamplerTextures[index] &&
+			textureHandle->texture == binding->texture &&
+			SDL_memcmp(
+				sampler,
+				&renderer->fragmentSamplerStates[index],
+				sizeof(FNA3D_SamplerState)
+			) == 0	)
+		{
+			return;
+		}
 
-	gpuSampler = SDLGPU_INTERNAL_FetchSamplerState(
-		renderer,
-		sampler
-	);
+		gpuTexture = textureHandle->texture;
+		gpuSampler = SDLGPU_INTERNAL_FetchSamplerState(
+			renderer,
+			sampler
+		);
+
+		renderer->fragmentSamplerTextures[index] = textureHandle;
+		renderer->fragmentSamplerStates[index] = *sampler;
+	}
 
-	if (gpuSampler != renderer->fragmentTextureSamplerBindings[index].sampler)
+	if (gpuTexture != binding->texture || gpuSampler != binding->sampler)
 	{
-		renderer->fragmentTextureSamplerBindings[index].sampler = gpuSampler;
-		renderer->needFragmentSamplerBind = 1;
+		binding->texture = gpuTexture;
+		binding->sampler = gpuSampler;
+		SDLGPU_INTERNAL_MarkSamplerDirty(
+			&renderer->fragmentSamplerDirtyStart,
+			&renderer->fragmentSamplerDirtyEnd,
+			index
+		);
 	}
 }
 
@@ -2030,9 +3493,10 @@ static void SDLGPU_ApplyVertexBufferBindings(
 	int32_t baseVertex
 ) {
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
-	MOJOSHADER_sdlShaderData *vertexShader, *blah;
+	MOJOSHADER_sdlShaderData *vertexShader = renderer->shaderReflection.vertShader;
 	void* bindingsResult;
 	FNA3D_VertexBufferBinding *src, *dst;
+	SDLGPU_BufferHandle *bufferHandle;
 	int32_t i, bindingsIndex;
 	uint32_t hash;
 
@@ -2042,8 +3506,6 @@ static void SDLGPU_ApplyVertexBufferBindings(
 	}
 
 	/* Check VertexBufferBindings */
-	MOJOSHADER_sdlGetBoundShaderData(renderer->mojoshaderContext, &vertexShader, &blah);
-
 	bindingsResult = PackedVertexBufferBindingsArray_Fetch(
 		renderer->vertexBufferBindingsCache,
 		bindings,
@@ -2055,6 +3517,7 @@ static void SDLGPU_ApplyVertexBufferBindings(
 
 	if (bindingsResult == NULL)
 	{
+		renderer->cacheStats[FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT].misses += 1;
 		PackedVertexBufferBindingsArray_Insert(
 			&renderer->vertexBufferBindingsCache,
 			bindings,
@@ -2063,6 +3526,10 @@ static void SDLGPU_ApplyVertexBufferBindings(
 			(void*) 69420
 		);
 	}
+	else
+	{
+		renderer->cacheStats[FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT].hits += 1;
+	}
 
 	if (bindingsUpdated)
 	{
@@ -2087,16 +3554,28 @@ static void SDLGPU_ApplyVertexBufferBindings(
 	if (bindingsIndex != renderer->currentVertexBufferBindingsIndex)
 	{
 		renderer->currentVertexBufferBindingsIndex = bindingsIndex;
-		renderer->nextPipelineHash.vertexBufferBindingsIndex = renderer->currentVertexBufferBindingsIndex;
 		renderer->needNewGraphicsPipeline = 1;
 	}
 
-	/* Don't actually bind buffers yet because pipelines are lazily bound */
+	/* Don't actually bind buffers yet because pipelines are lazily bound.
+	 * Set*BufferData moves buffers in and out of the ring, hence the lock.
+	 */
+	SDL_LockMutex(renderer->commandLock);
 	for (i = 0; i < numBindings; i += 1)
 	{
-		renderer->vertexBufferBindings[i].buffer = ((SDLGPU_BufferHandle*) bindings[i].vertexBuffer)->buffer;
+		bufferHandle = (SDLGPU_BufferHandle*) bindings[i].vertexBuffer;
 		renderer->vertexBufferBindings[i].offset = (bindings[i].vertexOffset + baseVertex) * bindings[i].vertexDeclaration.vertexStride;
+		if (bufferHandle->ringRedirect)
+		{
+			renderer->vertexBufferBindings[i].buffer = renderer->dynamicRing;
+			renderer->vertexBufferBindings[i].offset += bufferHandle->ringOffset;
+		}
+		else
+		{
+			renderer->vertexBufferBindings[i].buffer = bufferHandle->buffer;
+		}
 	}
+	SDL_UnlockMutex(renderer->commandLock);
 
 	renderer->needVertexBufferBind = 1;
 }
@@ -2361,6 +3840,7 @@ static void SDLGPU_INTERNAL_BindDeferredState(
 	SDLGPU_Renderer *renderer,
 	FNA3D_PrimitiveType primitiveType,
 	SDL_GPUBuffer *indexBuffer, /* can be NULL */
+	uint32_t indexOffset,
 	SDL_GPUIndexElementSize indexElementSize
 ) {
 	/* commandLock should be acquired by this point */
@@ -2394,39 +3874,64 @@ static void SDLGPU_INTERNAL_BindDeferredState(
 		renderer->currentStencilReference = renderer->stencilReference;
 	}
 
-	if (renderer->needVertexSamplerBind || renderer->needFragmentSamplerBind)
+	if (	renderer->needVertexSamplerBind ||
+		renderer->needFragmentSamplerBind ||
+		renderer->vertexSamplerDirtyStart < renderer->vertexSamplerDirtyEnd ||
+		renderer->fragmentSamplerDirtyStart < renderer->fragmentSamplerDirtyEnd	)
 	{
-		MOJOSHADER_sdlShaderData *vertShaderData, *fragShaderData;
-		MOJOSHADER_sdlGetBoundShaderData(
-			renderer->mojoshaderContext,
-			&vertShaderData,
-			&fragShaderData
-		);
-		if (renderer->needVertexSamplerBind)
+		uint32_t start, end;
+
+		/* Either rebind everything or just the slots that changed */
+		end = renderer->shaderReflection.vertSamplerSlots;
+		start = 0;
+		if (!renderer->needVertexSamplerBind)
+		{
+			start = renderer->vertexSamplerDirtyStart;
+			end = SDL_min(end, renderer->vertexSamplerDirtyEnd);
+		}
+		if (start < end)
 		{
 			SDL_BindGPUVertexSamplers(
 				renderer->renderPass,
-				0,
-				renderer->vertexTextureSamplerBindings,
-				MOJOSHADER_sdlGetSamplerSlots(vertShaderData)
+				start,
+				&renderer->vertexTextureSamplerBindings[start],
+				end - start
 			);
 		}
-		if (renderer->needFragmentSamplerBind)
+
+		end = renderer->shaderReflection.fragSamplerSlots;
+		start = 0;
+		if (!renderer->needFragmentSamplerBind)
+		{
+			start = renderer->fragmentSamplerDirtyStart;
+			end = SDL_min(end, renderer->fragmentSamplerDirtyEnd);
+		}
+		if (start < end)
 		{
 			SDL_BindGPUFragmentSamplers(
 				renderer->renderPass,
-				0,
-				renderer->fragmentTextureSamplerBindings,
-				MOJOSHADER_sdlGetSamplerSlots(fragShaderData)
+				start,
+				&renderer->fragmentTextureSamplerBindings[start],
+				end - start
 			);
 		}
+
+		renderer->needVertexSamplerBind = 0;
+		renderer->needFragmentSamplerBind = 0;
+		renderer->vertexSamplerDirtyStart = 0;
+		renderer->vertexSamplerDirtyEnd = 0;
+		renderer->fragmentSamplerDirtyStart = 0;
+		renderer->fragmentSamplerDirtyEnd = 0;
 	}
 
 	if (
-		indexBuffer != NULL &&
-		renderer->indexBufferBinding.buffer != indexBuffer
+		indexBuffer != NULL && (
+			renderer->indexBufferBinding.buffer != indexBuffer ||
+			renderer->indexBufferBinding.offset != indexOffset
+		)
 	) {
 		renderer->indexBufferBinding.buffer = indexBuffer;
+		renderer->indexBufferBinding.offset = indexOffset;
 
 		SDL_BindGPUIndexBuffer(
 			renderer->renderPass,
@@ -2459,6 +3964,7 @@ static void SDLGPU_DrawInstancedPrimitives(
 	FNA3D_IndexElementSize indexElementSize
 ) {
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+	SDLGPU_BufferHandle *indexHandle = (SDLGPU_BufferHandle*) indices;
 
 	/* Note that minVertexIndex/numVertices are NOT used! */
 
@@ -2472,7 +3978,12 @@ static void SDLGPU_DrawInstancedPrimitives(
 	SDLGPU_INTERNAL_BindDeferredState(
 		renderer,
 		primitiveType,
-		((SDLGPU_BufferHandle*) indices)->buffer,
+		indexHandle->ringRedirect ?
+			renderer->dynamicRing :
+			indexHandle->buffer,
+		indexHandle->ringRedirect ?
+			indexHandle->ringOffset :
+			0,
 		XNAToSDL_IndexElementSize[indexElementSize]
 	);
 
@@ -2527,6 +4038,7 @@ static void SDLGPU_DrawPrimitives(
 		renderer,
 		primitiveType,
 		NULL,
+		0,
 		SDL_GPU_INDEXELEMENTSIZE_16BIT
 	);
 
@@ -2559,6 +4071,23 @@ static void SDLGPU_INTERNAL_FreeTextureHandle(
 			}
 		}
 	}
+
+	/* The handle's memory may be reused, don't let the sampler memo match it */
+	for (i = 0; i < MAX_VERTEXTEXTURE_SAMPLERS; i += 1)
+	{
+		if (renderer->vertexSamplerTextures[i] == handle)
+		{
+			renderer->vertexSamplerTextures[i] = NULL;
+		}
+	}
+	for (i = 0; i < MAX_TEXTURE_SAMPLERS; i += 1)
+	{
+		if (renderer->fragmentSamplerTextures[i] == handle)
+		{
+			renderer->fragmentSamplerTextures[i] = NULL;
+		}
+	}
+
 	SDL_ReleaseGPUTexture(
 		renderer->device,
 		handle->texture
@@ -3028,60 +4557,39 @@ static void SDLGPU_INTERNAL_SetTextureData(
 	uint32_t dataLength,
 	bool cycleTexture
 ) {
-	SDL_LockMutex(renderer->commandLock);
-
 	SDL_GPUTextureRegion textureRegion;
 	SDL_GPUTextureTransferInfo textureCopyParams;
-	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
-	SDL_GPUTransferBuffer *transferBuffer = renderer->textureUploadBuffer;
+	SDLGPU_StagingBuffer *staging;
 	uint32_t transferOffset;
-	bool cycle = renderer->textureUploadBufferOffset == 0;
-	bool usingTemporaryTransferBuffer = false;
 	uint8_t *dst;
 
-	renderer->textureUploadBufferOffset = SDLGPU_INTERNAL_RoundToAlignment(
-		renderer->textureUploadBufferOffset,
-		SDL_GPUTextureFormatTexelBlockSize(format)
+	SDL_LockMutex(renderer->commandLock);
+	staging = SDLGPU_INTERNAL_ReserveStagingMemory(
+		renderer,
+		dataLength,
+		SDL_GPUTextureFormatTexelBlockSize(format),
+		&transferOffset
 	);
-	transferOffset = renderer->textureUploadBufferOffset;
+	SDL_UnlockMutex(renderer->commandLock);
 
-	if (dataLength >= TRANSFER_BUFFER_SIZE)
+	if (staging == NULL)
 	{
-		/* Upload is too big, create a temporary transfer buffer */
-		transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-		transferBufferCreateInfo.size = dataLength;
-		transferBufferCreateInfo.props = 0;
-		transferBuffer = SDL_CreateGPUTransferBuffer(
-			renderer->device,
-			&transferBufferCreateInfo
-		);
-		usingTemporaryTransferBuffer = true;
-		cycle = false;
-		transferOffset = 0;
-	}
-	else if (
-		renderer->textureUploadBufferOffset + dataLength >= TRANSFER_BUFFER_SIZE
-	) {
-		if (renderer->textureUploadCycleCount < MAX_UPLOAD_CYCLE_COUNT)
-		{
-			/* Cycle transfer buffer if necessary */
-			cycle = true;
-			renderer->textureUploadCycleCount += 1;
-			renderer->textureUploadBufferOffset = 0;
-			transferOffset = 0;
-		}
-		else
-		{
-			/* We cycled transfers a lot, send the upload commands to reduce further transfer memory usage */
-			SDLGPU_INTERNAL_FlushUploadCommands(renderer);
-			cycle = true;
-			transferOffset = 0;
-		}
+		return;
 	}
 
-	dst = (uint8_t*) SDL_MapGPUTransferBuffer(renderer->device, transferBuffer, cycle);
+	/* The range is ours alone, so loader threads can copy into it
+	 * without holding up the render thread. Reserved ranges are never
+	 * reused while in flight, no need to cycle.
+	 */
+	dst = (uint8_t*) SDL_MapGPUTransferBuffer(
+		renderer->device,
+		staging->transferBuffer,
+		false
+	);
 	SDL_memcpy(dst + transferOffset, data, dataLength);
-	SDL_UnmapGPUTransferBuffer(renderer->device, transferBuffer);
+	SDL_UnmapGPUTransferBuffer(renderer->device, staging->transferBuffer);
+
+	SDL_LockMutex(renderer->commandLock);
 
 	textureRegion.texture = texture;
 	textureRegion.layer = layer;
@@ -3093,7 +4601,7 @@ static void SDLGPU_INTERNAL_SetTextureData(
 	textureRegion.h = h;
 	textureRegion.d = d;
 
-	textureCopyParams.transfer_buffer = transferBuffer;
+	textureCopyParams.transfer_buffer = staging->transferBuffer;
 	textureCopyParams.offset = transferOffset;
 	textureCopyParams.pixels_per_row = 0;	/* default, assume tightly packed */
 	textureCopyParams.rows_per_layer = 0;	/* default, assume tightly packed */
@@ -3104,15 +4612,7 @@ static void SDLGPU_INTERNAL_SetTextureData(
 		&textureRegion,
 		cycleTexture
 	);
-
-	if (usingTemporaryTransferBuffer)
-	{
-		SDL_ReleaseGPUTransferBuffer(renderer->device, transferBuffer);
-	}
-	else
-	{
-		renderer->textureUploadBufferOffset += dataLength;
-	}
+	staging->writers -= 1;
 
 	SDL_UnlockMutex(renderer->commandLock);
 }
@@ -3312,6 +4812,10 @@ static FNA3D_Buffer* SDLGPU_GenVertexBuffer(
 		&createInfo
 	);
 	bufferHandle->size = sizeInBytes;
+	bufferHandle->dynamic = dynamic;
+	bufferHandle->ringRedirect = 0;
+	bufferHandle->ringOffset = 0;
+	bufferHandle->ringSize = 0;
 
 	return (FNA3D_Buffer*) bufferHandle;
 }
@@ -3335,6 +4839,10 @@ static FNA3D_Buffer* SDLGPU_GenIndexBuffer(
 		&createInfo
 	);
 	bufferHandle->size = (uint32_t) sizeInBytes;
+	bufferHandle->dynamic = dynamic;
+	bufferHandle->ringRedirect = 0;
+	bufferHandle->ringOffset = 0;
+	bufferHandle->ringSize = 0;
 
 	return (FNA3D_Buffer*) bufferHandle;
 }
@@ -3346,6 +4854,13 @@ static void SDLGPU_AddDisposeVertexBuffer(
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDLGPU_BufferHandle *bufferHandle = (SDLGPU_BufferHandle*) buffer;
 
+	if (bufferHandle->ringRedirect)
+	{
+		SDL_LockMutex(renderer->commandLock);
+		SDLGPU_INTERNAL_UnlinkRingHandle(renderer, bufferHandle);
+		SDL_UnlockMutex(renderer->commandLock);
+	}
+
 	SDL_ReleaseGPUBuffer(
 		renderer->device,
 		bufferHandle->buffer
@@ -3361,6 +4876,13 @@ static void SDLGPU_AddDisposeIndexBuffer(
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDLGPU_BufferHandle *bufferHandle = (SDLGPU_BufferHandle*) buffer;
 
+	if (bufferHandle->ringRedirect)
+	{
+		SDL_LockMutex(renderer->commandLock);
+		SDLGPU_INTERNAL_UnlinkRingHandle(renderer, bufferHandle);
+		SDL_UnlockMutex(renderer->commandLock);
+	}
+
 	SDL_ReleaseGPUBuffer(
 		renderer->device,
 		bufferHandle->buffer
@@ -3377,56 +4899,38 @@ static void SDLGPU_INTERNAL_SetBufferData(
 	uint32_t dataLength,
 	bool cycle
 ) {
-	SDL_LockMutex(renderer->commandLock);
-
-	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
 	SDL_GPUTransferBufferLocation transferLocation;
 	SDL_GPUBufferRegion bufferRegion;
-	SDL_GPUTransferBuffer *transferBuffer = renderer->bufferUploadBuffer;
-	uint32_t transferOffset = renderer->bufferUploadBufferOffset;
-	bool transferCycle = renderer->bufferUploadBufferOffset == 0;
-	bool usingTemporaryTransferBuffer = false;
+	SDLGPU_StagingBuffer *staging;
+	uint32_t transferOffset;
 	uint8_t *dst;
 
-	if (dataLength >= TRANSFER_BUFFER_SIZE)
+	SDL_LockMutex(renderer->commandLock);
+	staging = SDLGPU_INTERNAL_ReserveStagingMemory(
+		renderer,
+		dataLength,
+		1,
+		&transferOffset
+	);
+	SDL_UnlockMutex(renderer->commandLock);
+
+	if (staging == NULL)
 	{
-		/* Upload is too big, create a temporary transfer buffer */
-		transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-		transferBufferCreateInfo.size = dataLength;
-		transferBufferCreateInfo.props = 0;
-		transferBuffer = SDL_CreateGPUTransferBuffer(
-			renderer->device,
-			&transferBufferCreateInfo
-		);
-		usingTemporaryTransferBuffer = true;
-		transferCycle = false;
-		transferOffset = 0;
-	}
-	else if (
-		renderer->bufferUploadBufferOffset + dataLength >= TRANSFER_BUFFER_SIZE
-	) {
-		if (renderer->bufferUploadCycleCount < MAX_UPLOAD_CYCLE_COUNT)
-		{
-			/* Cycle transfer buffer if necessary */
-			transferCycle = true;
-			renderer->bufferUploadCycleCount += 1;
-			renderer->bufferUploadBufferOffset = 0;
-			transferOffset = 0;
-		}
-		else
-		{
-			/* We cycled transfers a lot, send the upload commands to reduce further transfer memory usage */
-			SDLGPU_INTERNAL_FlushUploadCommands(renderer);
-			transferCycle = true;
-			transferOffset = 0;
-		}
+		return;
 	}
 
-	dst = (uint8_t*) SDL_MapGPUTransferBuffer(renderer->device, transferBuffer, transferCycle);
+	/* Copy outside of commandLock, see SDLGPU_INTERNAL_SetTextureData */
+	dst = (uint8_t*) SDL_MapGPUTransferBuffer(
+		renderer->device,
+		staging->transferBuffer,
+		false
+	);
 	SDL_memcpy(dst + transferOffset, data, dataLength);
-	SDL_UnmapGPUTransferBuffer(renderer->device, transferBuffer);
+	SDL_UnmapGPUTransferBuffer(renderer->device, staging->transferBuffer);
+
+	SDL_LockMutex(renderer->commandLock);
 
-	transferLocation.transfer_buffer = transferBuffer;
+	transferLocation.transfer_buffer = staging->transferBuffer;
 	transferLocation.offset = transferOffset;
 
 	bufferRegion.buffer = buffer;
@@ -3439,17 +4943,103 @@ static void SDLGPU_INTERNAL_SetBufferData(
 		&bufferRegion,
 		cycle
 	);
+	staging->writers -= 1;
+
+	SDL_UnlockMutex(renderer->commandLock);
+}
+
+/* Writes into the handle's region of the dynamic ring, returns 0 if the
+ * data should go through SDLGPU_INTERNAL_SetBufferData instead.
+ */
+static uint8_t SDLGPU_INTERNAL_SetRingBufferData(
+	SDLGPU_Renderer *renderer,
+	SDLGPU_BufferHandle *handle,
+	uint32_t dstOffset,
+	void *data,
+	uint32_t dataLength,
+	FNA3D_SetDataOptions options
+) {
+	SDLGPU_StagingBuffer *staging;
+	uint32_t transferOffset, ringOffset;
+	uint8_t *dst;
+	uint8_t allocated;
 
-	if (usingTemporaryTransferBuffer)
+	/* Overwriting all of it can't be told apart from a discard */
+	if (	options == FNA3D_SETDATAOPTIONS_NONE &&
+		dstOffset == 0 &&
+		dataLength == handle->size	)
 	{
-		SDL_ReleaseGPUTransferBuffer(renderer->device, transferBuffer);
+		options = FNA3D_SETDATAOPTIONS_DISCARD;
 	}
-	else
+
+	SDL_LockMutex(renderer->commandLock);
+
+	if (options == FNA3D_SETDATAOPTIONS_DISCARD)
+	{
+		allocated = SDLGPU_INTERNAL_AllocateRingRegion(
+			renderer,
+			handle,
+			dstOffset + dataLength
+		);
+		if (!allocated)
+		{
+			SDL_UnlockMutex(renderer->commandLock);
+			return 0;
+		}
+	}
+	else if (!handle->ringRedirect)
+	{
+		SDL_UnlockMutex(renderer->commandLock);
+		return 0;
+	}
+	else if (	options == FNA3D_SETDATAOPTIONS_NONE ||
+			!SDLGPU_INTERNAL_GrowRingRegion(
+				renderer,
+				handle,
+				dstOffset + dataLength
+			)	)
+	{
+		/* Draws may still read the region, so this can't land in it */
+		SDLGPU_INTERNAL_ReturnRingRegion(renderer, handle);
+		SDL_UnlockMutex(renderer->commandLock);
+		return 0;
+	}
+	ringOffset = handle->ringOffset + dstOffset;
+
+	/* 4-byte alignment keeps back-to-back writes mergeable */
+	staging = SDLGPU_INTERNAL_ReserveStagingMemory(
+		renderer,
+		dataLength,
+		4,
+		&transferOffset
+	);
+	SDL_UnlockMutex(renderer->commandLock);
+
+	if (staging == NULL)
 	{
-		renderer->bufferUploadBufferOffset += dataLength;
+		return 1;
 	}
 
+	dst = (uint8_t*) SDL_MapGPUTransferBuffer(
+		renderer->device,
+		staging->transferBuffer,
+		false
+	);
+	SDL_memcpy(dst + transferOffset, data, dataLength);
+	SDL_UnmapGPUTransferBuffer(renderer->device, staging->transferBuffer);
+
+	SDL_LockMutex(renderer->commandLock);
+	SDLGPU_INTERNAL_RecordRingUpload(
+		renderer,
+		staging,
+		transferOffset,
+		ringOffset,
+		dataLength
+	);
+	staging->writers -= 1;
 	SDL_UnlockMutex(renderer->commandLock);
+
+	return 1;
 }
 
 static void SDLGPU_SetVertexBufferData(
@@ -3467,6 +5057,19 @@ static void SDLGPU_SetVertexBufferData(
 	bool cycle;
 	uint32_t dataLen = (uint32_t) elementCount * (uint32_t) vertexStride;
 
+	if (	bufferHandle->dynamic &&
+		SDLGPU_INTERNAL_SetRingBufferData(
+			(SDLGPU_Renderer*) driverData,
+			bufferHandle,
+			(uint32_t) offsetInBytes,
+			data,
+			dataLen,
+			options
+		)	)
+	{
+		return;
+	}
+
 	if (options == FNA3D_SETDATAOPTIONS_DISCARD)
 	{
 		cycle = true;
@@ -3502,6 +5105,20 @@ static void SDLGPU_SetIndexBufferData(
 	SDLGPU_BufferHandle *bufferHandle = (SDLGPU_BufferHandle*) buffer;
 
 	bool cycle;
+
+	if (	bufferHandle->dynamic &&
+		SDLGPU_INTERNAL_SetRingBufferData(
+			(SDLGPU_Renderer*) driverData,
+			bufferHandle,
+			(uint32_t) offsetInBytes,
+			data,
+			(uint32_t) dataLength,
+			options
+		)	)
+	{
+		return;
+	}
+
 	if (options == FNA3D_SETDATAOPTIONS_DISCARD)
 	{
 		cycle = true;
@@ -3619,7 +5236,7 @@ static void SDLGPU_INTERNAL_GetTextureData(
 
 static void SDLGPU_INTERNAL_GetBufferData(
 	SDLGPU_Renderer *renderer,
-	SDL_GPUBuffer *buffer,
+	SDLGPU_BufferHandle *bufferHandle,
 	uint32_t offset,
 	void *data,
 	uint32_t dataLength
@@ -3631,6 +5248,8 @@ static void SDLGPU_INTERNAL_GetBufferData(
 
 	SDL_LockMutex(renderer->commandLock);
 
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+
 	/* Create transfer buffer if necessary */
 	if (renderer->bufferDownloadBuffer == NULL)
 	{
@@ -3663,8 +5282,16 @@ static void SDLGPU_INTERNAL_GetBufferData(
 	}
 
 	/* Set up buffer download */
-	bufferRegion.buffer = buffer;
-	bufferRegion.offset = offset;
+	if (bufferHandle->ringRedirect)
+	{
+		bufferRegion.buffer = renderer->dynamicRing;
+		bufferRegion.offset = bufferHandle->ringOffset + offset;
+	}
+	else
+	{
+		bufferRegion.buffer = bufferHandle->buffer;
+		bufferRegion.offset = offset;
+	}
 	bufferRegion.size = dataLength;
 	transferLocation.transfer_buffer = renderer->bufferDownloadBuffer;
 	transferLocation.offset = 0;
@@ -3699,7 +5326,7 @@ static void SDLGPU_GetVertexBufferData(
 
 	SDLGPU_INTERNAL_GetBufferData(
 		(SDLGPU_Renderer*) driverData,
-		bufferHandle->buffer,
+		bufferHandle,
 		offsetInBytes,
 		data,
 		elementCount * vertexStride
@@ -3717,7 +5344,7 @@ static void SDLGPU_GetIndexBufferData(
 
 	SDLGPU_INTERNAL_GetBufferData(
 		(SDLGPU_Renderer*) driverData,
-		bufferHandle->buffer,
+		bufferHandle,
 		offsetInBytes,
 		data,
 		dataLength
@@ -3828,8 +5455,88 @@ static void SDLGPU_ReadBackbuffer(
 	);
 }
 
-/* Effects */
-
+/* Effects */
+
+static void SDLGPU_INTERNAL_ReflectSamplers(
+	const MOJOSHADER_parseData *pd,
+	MOJOSHADER_samplerType *types,
+	int32_t maxSamplers
+) {
+	int32_t i;
+
+	for (i = 0; i < maxSamplers; i += 1)
+	{
+		types[i] = MOJOSHADER_SAMPLER_2D;
+	}
+	if (pd == NULL)
+	{
+		return;
+	}
+	for (i = 0; i < SDL_min(pd->sampler_count, maxSamplers); i += 1)
+	{
+		types[i] = pd->samplers[i].type;
+	}
+}
+
+static void SDLGPU_INTERNAL_RefreshShaderReflection(
+	SDLGPU_Renderer *renderer
+) {
+	SDLGPU_ShaderReflection *reflection = &renderer->shaderReflection;
+	MOJOSHADER_sdlShaderData *vertShader, *fragShader;
+
+	MOJOSHADER_sdlGetBoundShaderData(
+		renderer->mojoshaderContext,
+		&vertShader,
+		&fragShader
+	);
+
+	/* Most applies keep the same pair. Freed shaders can have their
+	 * addresses reused, which is why disposing an effect clears valid.
+	 */
+	if (	reflection->valid &&
+		vertShader == reflection->vertShader &&
+		fragShader == reflection->fragShader	)
+	{
+		return;
+	}
+	reflection->vertShader = vertShader;
+	reflection->fragShader = fragShader;
+	reflection->valid = 1;
+
+	if (reflection->vertShader != NULL)
+	{
+		reflection->vertParseData = MOJOSHADER_sdlGetShaderParseData(reflection->vertShader);
+		reflection->vertSamplerSlots = MOJOSHADER_sdlGetSamplerSlots(reflection->vertShader);
+	}
+	else
+	{
+		reflection->vertParseData = NULL;
+		reflection->vertSamplerSlots = 0;
+	}
+
+	if (reflection->fragShader != NULL)
+	{
+		reflection->fragParseData = MOJOSHADER_sdlGetShaderParseData(reflection->fragShader);
+		reflection->fragSamplerSlots = MOJOSHADER_sdlGetSamplerSlots(reflection->fragShader);
+	}
+	else
+	{
+		reflection->fragParseData = NULL;
+		reflection->fragSamplerSlots = 0;
+	}
+
+	SDLGPU_INTERNAL_ReflectSamplers(
+		reflection->vertParseData,
+		reflection->vertSamplerTypes,
+		MAX_VERTEXTEXTURE_SAMPLERS
+	);
+	SDLGPU_INTERNAL_ReflectSamplers(
+		reflection->fragParseData,
+		reflection->fragSamplerTypes,
+		MAX_TEXTURE_SAMPLERS
+	);
+}
+
 static void SDLGPU_CreateEffect(
 	FNA3D_Renderer *driverData,
 	uint8_t *effectCode,
@@ -3908,6 +5615,11 @@ static void SDLGPU_AddDisposeEffect(
 	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	SDLGPU_Effect *gpuEffect = (SDLGPU_Effect*) effect;
 	MOJOSHADER_effect *effectData = gpuEffect->effect;
+	MOJOSHADER_effectObject *object;
+	int32_t i;
+
+	/* Its shaders are about to be freed, see RefreshShaderReflection */
+	renderer->shaderReflection.valid = 0;
 
 	if (effectData == renderer->currentEffect)
 	{
@@ -3916,7 +5628,26 @@ static void SDLGPU_AddDisposeEffect(
 		renderer->currentEffect = NULL;
 		renderer->currentTechnique = NULL;
 		renderer->currentPass = 0;
+		SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
+	}
+
+	/* The effect's shaders (and any programs linked with them) may be
+	 * freed along with the effect, so forget any layouts that used them.
+	 */
+	for (i = 0; i < effectData->object_count; i += 1)
+	{
+		object = &effectData->objects[i];
+		if (	(	object->type == MOJOSHADER_SYMTYPE_VERTEXSHADER ||
+				object->type == MOJOSHADER_SYMTYPE_PIXELSHADER	) &&
+			!object->shader.is_preshader	)
+		{
+			VertexInputHashTable_RemoveShader(
+				&renderer->vertexInputHashTable,
+				(MOJOSHADER_sdlShaderData*) object->shader.shader
+			);
+		}
 	}
+
 	MOJOSHADER_deleteEffect(effectData);
 	SDL_free(gpuEffect);
 }
@@ -3942,9 +5673,7 @@ static void SDLGPU_ApplyEffect(
 	const MOJOSHADER_effectTechnique *technique = gpuEffect->effect->current_technique;
 	uint32_t numPasses;
 
-	renderer->needFragmentSamplerBind = 1;
-	renderer->needVertexSamplerBind = 1;
-	renderer->needNewGraphicsPipeline = 1;
+	renderer->uniformsDirty = 1;
 
 	if (effectData == renderer->currentEffect)
 	{
@@ -3955,6 +5684,7 @@ static void SDLGPU_ApplyEffect(
 			MOJOSHADER_effectCommitChanges(
 				renderer->currentEffect
 			);
+			SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
 
 			return;
 		}
@@ -3963,6 +5693,7 @@ static void SDLGPU_ApplyEffect(
 		MOJOSHADER_effectBeginPass(renderer->currentEffect, pass);
 		renderer->currentTechnique = technique;
 		renderer->currentPass = pass;
+		SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
 
 		return;
 	}
@@ -3983,6 +5714,7 @@ static void SDLGPU_ApplyEffect(
 	renderer->currentEffect = effectData;
 	renderer->currentTechnique = technique;
 	renderer->currentPass = pass;
+	SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
 }
 
 static void SDLGPU_BeginPassRestore(
@@ -3990,9 +5722,12 @@ static void SDLGPU_BeginPassRestore(
 	FNA3D_Effect *effect,
 	MOJOSHADER_effectStateChanges *stateChanges
 ) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	MOJOSHADER_effect *effectData = ((SDLGPU_Effect*) effect)->effect;
 	uint32_t whatever;
 
+	renderer->uniformsDirty = 1;
+
 	MOJOSHADER_effectBegin(
 			effectData,
 			&whatever,
@@ -4000,15 +5735,27 @@ static void SDLGPU_BeginPassRestore(
 			stateChanges
 	);
 	MOJOSHADER_effectBeginPass(effectData, 0);
+	SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
 }
 
 static void SDLGPU_EndPassRestore(
 	FNA3D_Renderer *driverData,
 	FNA3D_Effect *effect
 ) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
 	MOJOSHADER_effect *effectData = ((SDLGPU_Effect*) effect)->effect;
+
 	MOJOSHADER_effectEndPass(effectData);
 	MOJOSHADER_effectEnd(effectData);
+	renderer->uniformsDirty = 1;
+	SDLGPU_INTERNAL_RefreshShaderReflection(renderer);
+}
+
+static MOJOSHADER_effect* SDLGPU_GetEffectData(
+	FNA3D_Renderer *driverData,
+	FNA3D_Effect *effect
+) {
+	return ((SDLGPU_Effect*) effect)->effect;
 }
 
 /* Queries */
@@ -4149,6 +5896,271 @@ static void SDLGPU_SetTextureName(
 	);
 }
 
+/* Pipeline Cache Statistics */
+
+static void SDLGPU_GetPipelineCacheStats(
+	FNA3D_Renderer *driverData,
+	FNA3D_PipelineCacheStatsEXT *stats
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_GRAPHICSPIPELINE_EXT],
+		renderer->graphicsPipelineHashTable.count,
+		NUM_PIPELINE_HASH_BUCKETS
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_SAMPLERSTATE_EXT],
+		renderer->samplerStateArray.count,
+		renderer->samplerStateArray.capacity
+	);
+	PipelineCacheStats_SetOccupancy(
+		&renderer->cacheStats[FNA3D_PIPELINECACHE_VERTEXBUFFERBINDINGS_EXT],
+		renderer->vertexBufferBindingsCache.count,
+		renderer->vertexBufferBindingsCache.capacity
+	);
+
+	/* Blend, depth-stencil and rasterizer states are baked into pipelines */
+	SDL_memcpy(
+		stats->caches,
+		renderer->cacheStats,
+		sizeof(renderer->cacheStats)
+	);
+}
+
+/* Backbuffer Capture */
+
+static void SDLGPU_SetBackbufferCapture(
+	FNA3D_Renderer *driverData,
+	int32_t frameCount,
+	FNA3D_BackbufferCaptureFuncEXT callback,
+	void *userdata
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+
+	SDL_LockMutex(renderer->commandLock);
+
+	/* The ring layout depends on the frame count, so start over */
+	SDLGPU_INTERNAL_FlushCaptureFrames(renderer);
+
+	renderer->captureCallback = callback;
+	renderer->captureUserdata = userdata;
+	renderer->captureFrameCount = frameCount;
+
+	SDL_UnlockMutex(renderer->commandLock);
+}
+
+/* Asynchronous Readback */
+
+static SDLGPU_Readback* SDLGPU_INTERNAL_CreateReadback(
+	SDLGPU_Renderer *renderer,
+	uint32_t size
+) {
+	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
+	SDLGPU_Readback *readback;
+
+	transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+	transferBufferCreateInfo.size = size;
+	transferBufferCreateInfo.props = 0;
+
+	readback = (SDLGPU_Readback*) SDL_malloc(sizeof(SDLGPU_Readback));
+	readback->transferBuffer = SDL_CreateGPUTransferBuffer(
+		renderer->device,
+		&transferBufferCreateInfo
+	);
+	readback->fence = NULL;
+	readback->size = size;
+
+	if (readback->transferBuffer == NULL)
+	{
+		FNA3D_LogError(
+			"Failed to create readback buffer: %s",
+			SDL_GetError()
+		);
+		SDL_free(readback);
+		return NULL;
+	}
+	return readback;
+}
+
+static FNA3D_ReadbackEXT* SDLGPU_GetTextureDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Texture *texture,
+	int32_t x,
+	int32_t y,
+	int32_t w,
+	int32_t h,
+	int32_t level,
+	int32_t dataLength
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+	SDLGPU_TextureHandle *textureHandle = (SDLGPU_TextureHandle*) texture;
+	SDL_GPUTextureRegion region;
+	SDL_GPUTextureTransferInfo textureCopyParams;
+	SDLGPU_Readback *readback;
+
+	readback = SDLGPU_INTERNAL_CreateReadback(
+		renderer,
+		(uint32_t) dataLength
+	);
+	if (readback == NULL)
+	{
+		return NULL;
+	}
+
+	region.texture = textureHandle->texture;
+	region.mip_level = level;
+	region.layer = 0;
+	region.x = x;
+	region.y = y;
+	region.z = 0;
+	region.w = w;
+	region.h = h;
+	region.d = 1;
+
+	/* All zeroes, assume tight packing */
+	textureCopyParams.transfer_buffer = readback->transferBuffer;
+	textureCopyParams.offset = 0;
+	textureCopyParams.pixels_per_row = 0;
+	textureCopyParams.rows_per_layer = 0;
+
+	SDL_LockMutex(renderer->commandLock);
+
+	/* Submit rendering so the download is ordered after it, but don't wait */
+	SDLGPU_INTERNAL_FlushCommands(renderer);
+
+	SDL_DownloadFromGPUTexture(
+		renderer->copyPass,
+		&region,
+		&textureCopyParams
+	);
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
+		renderer,
+		&readback->fence
+	);
+
+	SDL_UnlockMutex(renderer->commandLock);
+
+	return (FNA3D_ReadbackEXT*) readback;
+}
+
+static FNA3D_ReadbackEXT* SDLGPU_GetBufferDataAsync(
+	FNA3D_Renderer *driverData,
+	FNA3D_Buffer *buffer,
+	int32_t offsetInBytes,
+	int32_t dataLength
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+	SDLGPU_BufferHandle *bufferHandle = (SDLGPU_BufferHandle*) buffer;
+	SDL_GPUBufferRegion bufferRegion;
+	SDL_GPUTransferBufferLocation transferLocation;
+	SDLGPU_Readback *readback;
+
+	readback = SDLGPU_INTERNAL_CreateReadback(
+		renderer,
+		(uint32_t) dataLength
+	);
+	if (readback == NULL)
+	{
+		return NULL;
+	}
+
+	SDL_LockMutex(renderer->commandLock);
+
+	SDLGPU_INTERNAL_FlushRingUploads(renderer);
+
+	if (bufferHandle->ringRedirect)
+	{
+		bufferRegion.buffer = renderer->dynamicRing;
+		bufferRegion.offset = bufferHandle->ringOffset + offsetInBytes;
+	}
+	else
+	{
+		bufferRegion.buffer = bufferHandle->buffer;
+		bufferRegion.offset = offsetInBytes;
+	}
+	bufferRegion.size = dataLength;
+	transferLocation.transfer_buffer = readback->transferBuffer;
+	transferLocation.offset = 0;
+
+	SDL_DownloadFromGPUBuffer(
+		renderer->copyPass,
+		&bufferRegion,
+		&transferLocation
+	);
+
+	SDLGPU_INTERNAL_FlushUploadCommandsAndAcquireFence(
+		renderer,
+		&readback->fence
+	);
+
+	SDL_UnlockMutex(renderer->commandLock);
+
+	return (FNA3D_ReadbackEXT*) readback;
+}
+
+static uint8_t SDLGPU_PollReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+	SDLGPU_Readback *sdlReadback = (SDLGPU_Readback*) readback;
+
+	if (sdlReadback->fence == NULL)
+	{
+		/* Submission failed, waiting won't block */
+		return 1;
+	}
+	return SDL_QueryGPUFence(renderer->device, sdlReadback->fence);
+}
+
+static void SDLGPU_WaitReadback(
+	FNA3D_Renderer *driverData,
+	FNA3D_ReadbackEXT *readback,
+	void *data,
+	int32_t dataLength
+) {
+	SDLGPU_Renderer *renderer = (SDLGPU_Renderer*) driverData;
+	SDLGPU_Readback *sdlReadback = (SDLGPU_Readback*) readback;
+	uint8_t *src;
+
+	if (sdlReadback->fence != NULL)
+	{
+		SDL_WaitForGPUFences(
+			renderer->device,
+			1,
+			&sdlReadback->fence,
+			1
+		);
+		SDL_ReleaseGPUFence(renderer->device, sdlReadback->fence);
+
+		if (data != NULL)
+		{
+			src = (uint8_t*) SDL_MapGPUTransferBuffer(
+				renderer->device,
+				sdlReadback->transferBuffer,
+				false
+			);
+			SDL_memcpy(
+				data,
+				src,
+				SDL_min((uint32_t) dataLength, sdlReadback->size)
+			);
+			SDL_UnmapGPUTransferBuffer(
+				renderer->device,
+				sdlReadback->transferBuffer
+			);
+		}
+	}
+
+	SDL_ReleaseGPUTransferBuffer(
+		renderer->device,
+		sdlReadback->transferBuffer
+	);
+	SDL_free(sdlReadback);
+}
+
 /* External Interop */
 
 static void SDLGPU_GetSysRenderer(
@@ -4206,8 +6218,33 @@ static void SDLGPU_DestroyDevice(FNA3D_Device *device)
 		);
 	}
 
-	SDL_ReleaseGPUTransferBuffer(renderer->device, renderer->textureUploadBuffer);
-	SDL_ReleaseGPUTransferBuffer(renderer->device, renderer->bufferUploadBuffer);
+	for (i = 0; i < FNA3D_BACKBUFFERCAPTURE_MAX_FRAMES_EXT; i += 1)
+	{
+		if (renderer->captureFrames[i].fence != NULL)
+		{
+			SDL_ReleaseGPUFence(
+				renderer->device,
+				renderer->captureFrames[i].fence
+			);
+		}
+		if (renderer->captureFrames[i].transferBuffer != NULL)
+		{
+			SDL_ReleaseGPUTransferBuffer(
+				renderer->device,
+				renderer->captureFrames[i].transferBuffer
+			);
+		}
+	}
+
+	SDLGPU_INTERNAL_DestroyStagingBuffers(renderer);
+
+	if (renderer->dynamicRing != NULL)
+	{
+		SDL_ReleaseGPUBuffer(renderer->device, renderer->dynamicRing);
+	}
+	SDL_free(renderer->dynamicRingHandles.elements);
+	SDL_free(renderer->uniformSnapshot);
+	SDL_free(renderer->uniformScratch);
 
 	SDLGPU_INTERNAL_DestroyFauxBackbuffer(renderer);
 
@@ -4222,6 +6259,16 @@ static void SDLGPU_DestroyDevice(FNA3D_Device *device)
 		}
 	}
 
+	for (i = 0; i < NUM_VERTEX_INPUT_HASH_BUCKETS; i += 1)
+	{
+		for (j = 0; j < renderer->vertexInputHashTable.buckets[i].count; j += 1)
+		{
+			SDL_free(renderer->vertexInputHashTable.buckets[i].elements[j].value);
+		}
+		SDL_free(renderer->vertexInputHashTable.buckets[i].elements);
+	}
+	SDL_free(renderer->vertexInputLayouts.elements);
+
 	for (i = 0; i < renderer->samplerStateArray.count; i += 1)
 	{
 		SDL_ReleaseGPUSampler(
@@ -4265,6 +6312,16 @@ static void SDLGPU_DestroyDevice(FNA3D_Device *device)
 
 /* Initialization */
 
+static int32_t SDLGPU_INTERNAL_GetHintInt(const char *name, int32_t defaultValue)
+{
+	const char *hint = SDL_GetHint(name);
+	if (hint == NULL)
+	{
+		return defaultValue;
+	}
+	return SDL_max(0, SDL_atoi(hint));
+}
+
 static SDL_PropertiesID SDLGPU_INTERNAL_FillProperties(bool debugMode)
 {
 	SDL_PropertiesID props = SDL_CreateProperties();
@@ -4324,10 +6381,10 @@ static FNA3D_Device* SDLGPU_CreateDevice(
 	SDL_GPUSwapchainComposition swapchainComposition;
 	SDL_GPUTextureCreateInfo textureCreateInfo;
 	SDL_GPUSamplerCreateInfo samplerCreateInfo;
-	SDL_GPUTransferBufferCreateInfo transferBufferCreateInfo;
 	SDL_GPUPresentMode desiredPresentMode;
 	uint64_t dummyInt = 0;
 	FNA3D_Device *result;
+	int32_t framesInFlight;
 	int32_t i;
 
 	SDL_SetLogPriority(
@@ -4403,6 +6460,28 @@ static FNA3D_Device* SDLGPU_CreateDevice(
 		return NULL;
 	}
 
+	/* Fewer frames in flight trades throughput for input latency.
+	 * SDL_GPU already fences the swapchain acquire in SwapBuffers,
+	 * so all we have to do is tell it how far ahead we may run.
+	 */
+	framesInFlight = SDLGPU_INTERNAL_GetHintInt(
+		"FNA3D_FRAMES_IN_FLIGHT",
+		0
+	);
+	if (framesInFlight > 0)
+	{
+		framesInFlight = SDL_clamp(framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
+		if (!SDL_SetGPUAllowedFramesInFlight(
+			renderer->device,
+			(Uint32) framesInFlight
+		)) {
+			FNA3D_LogWarn(
+				"Failed to set frames in flight: %s",
+				SDL_GetError()
+			);
+		}
+	}
+
 	SDLGPU_INTERNAL_CreateFauxBackbuffer(
 		renderer,
 		presentationParameters
@@ -4416,32 +6495,6 @@ static FNA3D_Device* SDLGPU_CreateDevice(
 		return NULL;
 	}
 
-	transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-	transferBufferCreateInfo.size = TRANSFER_BUFFER_SIZE;
-	transferBufferCreateInfo.props = 0;
-	renderer->textureUploadBufferOffset = 0;
-	renderer->textureUploadBuffer = SDL_CreateGPUTransferBuffer(
-		renderer->device,
-		&transferBufferCreateInfo
-	);
-
-	if (renderer->textureUploadBuffer == NULL)
-	{
-		FNA3D_LogError("Failed to create texture transfer buffer!");
-		SDL_free(renderer);
-		SDL_free(result);
-		return NULL;
-	}
-
-	transferBufferCreateInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-	transferBufferCreateInfo.size = TRANSFER_BUFFER_SIZE;
-	transferBufferCreateInfo.props = 0;
-	renderer->bufferUploadBufferOffset = 0;
-	renderer->bufferUploadBuffer = SDL_CreateGPUTransferBuffer(
-		renderer->device,
-		&transferBufferCreateInfo
-	);
-
 	/*
 	 * Initialize renderer members not covered by SDL_memset('\0')
 	 */
@@ -4449,6 +6502,19 @@ static FNA3D_Device* SDLGPU_CreateDevice(
 	renderer->multisampleMask = 0xFFFFFFFF;
 	renderer->nextPipelineHash.sampleMask = renderer->multisampleMask;
 
+	renderer->dynamicRingSize = DYNAMIC_RING_SIZE;
+	renderer->dynamicRingCycle = 1;
+
+	/* Long sessions with procedural content can grow these without bound */
+	renderer->maxCachedPipelines = SDLGPU_INTERNAL_GetHintInt(
+		"FNA3D_SDL_MAX_CACHED_PIPELINES",
+		0
+	);
+	renderer->maxCachedSamplers = SDLGPU_INTERNAL_GetHintInt(
+		"FNA3D_SDL_MAX_CACHED_SAMPLERS",
+		0
+	);
+
 	for (i = 0; i < MAX_BOUND_VERTEX_BUFFERS; i += 1)
 	{
 		renderer->vertexBindings[i].vertexDeclaration.elements =
@@ -260,4 +260,48 @@ void PackedVertexBufferBindingsArray_Insert(
 	arr->count += 1;
 }
 
+/* Cache Statistics */
+
+static const double histogramBoundsMS[FNA3D_PIPELINECACHE_HISTOGRAM_BUCKETS_EXT - 1] =
+{
+	0.1, 0.5, 1.0, 5.0, 10.0, 50.0, 100.0
+};
+
+uint64_t PipelineCacheStats_BeginCreate(void)
+{
+	return SDL_GetPerformanceCounter();
+}
+
+void PipelineCacheStats_EndCreate(
+	FNA3D_PipelineCacheCountersEXT *counters,
+	uint64_t start
+) {
+	int32_t i;
+	double elapsedMS = (
+		(double) (SDL_GetPerformanceCounter() - start) * 1000.0 /
+		(double) SDL_GetPerformanceFrequency()
+	);
+
+	for (i = 0; i < FNA3D_PIPELINECACHE_HISTOGRAM_BUCKETS_EXT - 1; i += 1)
+	{
+		if (elapsedMS < histogramBoundsMS[i])
+		{
+			break;
+		}
+	}
+	counters->creationTimeHistogram[i] += 1;
+}
+
+void PipelineCacheStats_SetOccupancy(
+	FNA3D_PipelineCacheCountersEXT *counters,
+	int32_t liveObjects,
+	int32_t capacity
+) {
+	counters->liveObjects = (uint32_t) liveObjects;
+	counters->capacity = (uint32_t) capacity;
+	counters->loadFactor = (capacity > 0) ?
+		(float) liveObjects / (float) capacity :
+		0.0f;
+}
+
 /* vim: set noexpandtab shiftwidth=8 tabstop=8: */
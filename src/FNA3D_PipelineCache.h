@@ -95,6 +95,19 @@ FNA3D_SHAREDINTERNAL void PackedVertexBufferBindingsArray_Insert(
 	void* value
 );
 
+/* Cache Statistics */
+
+FNA3D_SHAREDINTERNAL uint64_t PipelineCacheStats_BeginCreate(void);
+FNA3D_SHAREDINTERNAL void PipelineCacheStats_EndCreate(
+	FNA3D_PipelineCacheCountersEXT *counters,
+	uint64_t start
+);
+FNA3D_SHAREDINTERNAL void PipelineCacheStats_SetOccupancy(
+	FNA3D_PipelineCacheCountersEXT *counters,
+	int32_t liveObjects,
+	int32_t capacity
+);
+
 /* Macros */
 
 #define EXPAND_ARRAY_IF_NEEDED(arr, initialValue, type)	\